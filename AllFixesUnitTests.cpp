@@ -0,0 +1,158 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of computeAllFixes.
+//
+// Special Notes  : Every fix must be exactly what the separate methods
+//                  give, whatever the number of threads.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  const int n=40;
+  const double sigma=3*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  double tx=-300;
+  double ty=2500;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,13);
+  spiralReceivers(n,9000,100,-2.0,0.1,rx,ry);
+  for (int i=0; i<n; ++i)
+    sigmas[i]=sigma;
+  noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+
+  // The separate methods
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas);
+  std::vector<double> lsFix,sFix,mlFix;
+  double sAm2,sBm2,sPhi,mlAm2,mlBm2,mlPhi;
+  collection.computeLeastSquaresFix(lsFix);
+  sFix=lsFix;
+  collection.computeStansfieldFix(sFix,sAm2,sBm2,sPhi);
+  mlFix=lsFix;
+  collection.computeMLFix(mlFix);
+  collection.computeCramerRaoBounds(mlFix,mlAm2,mlBm2,mlPhi);
+
+  DFLib::AllFixes all;
+#ifdef _OPENMP
+  int oldThreads=omp_get_max_threads();
+  omp_set_num_threads(3);
+#endif
+  collection.computeAllFixes(all);
+#ifdef _OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+  std::cout << " All fixes: LS " << all.leastSquaresFix[0] << ","
+            << all.leastSquaresFix[1] << " Stansfield "
+            << all.stansfieldFix[0] << "," << all.stansfieldFix[1]
+            << " ML " << all.mlFix[0] << "," << all.mlFix[1];
+  if (all.leastSquaresValid && all.stansfieldValid && all.mlValid
+      && !all.fixCutValid
+      && all.leastSquaresFix==lsFix && all.stansfieldFix==sFix
+      && all.mlFix==mlFix
+      && all.stansfieldAm2==sAm2 && all.stansfieldBm2==sBm2
+      && all.stansfieldPhi==sPhi && all.mlAm2==mlAm2 && all.mlBm2==mlBm2
+      && all.mlPhi==mlPhi)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The report collection adds the fix cut average
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(loc,bearing[i]*180/M_PI,
+                                     sigmas[i]*180/M_PI,"r");
+    rColl.addReport(reports[i]);
+  }
+  DFLib::XY::Point FCA(lsFix);
+  DFLib::XY::Point separateFCA(lsFix);
+  std::vector<double> stddev;
+  bool fcaValid=rColl.computeFixCutAverage(separateFCA,stddev,10.0);
+  rColl.computeAllFixes(FCA,all,10.0);
+  std::cout << " Fix cut average " << all.fixCutAverage[0] << ","
+            << all.fixCutAverage[1] << " +/- " << all.fixCutStdDev[0] << ","
+            << all.fixCutStdDev[1];
+  if (fcaValid && all.fixCutValid
+      && all.fixCutAverage==separateFCA.getUserCoords()
+      && FCA.getXY()==separateFCA.getXY() && all.fixCutStdDev==stddev
+      && fabs(all.mlFix[0]-mlFix[0])<1e-3
+      && fabs(all.stansfieldFix[1]-sFix[1])<1e-3
+      && !rColl.isMaterialized())
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Parallel bearings have no fix at all, and say so
+  double pb[3]={0.5,0.5,0.5};
+  DFLib::ArrayCollection parallel(3,rx,ry,pb,sigmas);
+  parallel.computeAllFixes(all);
+  std::cout << " Parallel bearings";
+  if (!all.leastSquaresValid && !all.stansfieldValid && !all.mlValid)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
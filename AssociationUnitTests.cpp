@@ -0,0 +1,166 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of grouping bearings by transmitter.
+//
+// Special Notes  : Three transmitters share a channel, and every receiver
+//                  hears all three, plus the odd wild bearing.  The groups
+//                  found must each point at one transmitter, and the ML
+//                  fix of each group must land on it.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Bearing_Association.hpp"
+#include "gaussian_random.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  // 40 receivers scattered over about 40 km, three transmitters among
+  // them, 1.5 degree bearing errors.  One bearing in twenty is wild.
+  const int numReceivers=40;
+  const int numTx=3;
+  double txX[numTx]={-8000,6000,2000};
+  double txY[numTx]={5000,3000,-9000};
+  DFLib::Util::gaussian_random_generator scatter(0,10000,20091001,6);
+  DFLib::Util::gaussian_random_generator noise(0,1.5*M_PI/180,20091001,7);
+  DFLib::Util::gaussian_random_generator wild(0,2*M_PI,20091001,8);
+
+  std::vector<DFLib::XY::Report *> reports;
+  std::vector<int> truth;
+  DFLib::ReportCollection collection;
+  std::vector<double> location(2);
+  for (int r=0; r<numReceivers; ++r)
+  {
+    location[0]=scatter.getRandom();
+    location[1]=scatter.getRandom();
+    for (int t=0; t<numTx; ++t)
+    {
+      double b;
+      if (reports.size()%20==19)
+      {
+        b=wild.getRandom();
+        truth.push_back(-1);
+      }
+      else
+      {
+        b=atan2(txX[t]-location[0],txY[t]-location[1])+noise.getRandom();
+        truth.push_back(t);
+      }
+      reports.push_back(new DFLib::XY::Report(location,b*180/M_PI,1.5,
+                                              "rx"));
+      collection.addReport(reports.back());
+    }
+  }
+
+  DFLib::BearingAssociator associator;
+  std::vector<DFLib::ReportCollection *> groups;
+  int numEmitters=associator.associate(collection,groups);
+  std::cout << " Found " << numEmitters << " emitters";
+  if (numEmitters==numTx)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::vector<int> labels;
+  associator.associate(collection,labels);
+  int numTrue=0;
+  int numMixed=0;
+  std::vector<int> groupTx(numEmitters,-1);
+  for (int i=0; i<labels.size(); ++i)
+  {
+    if (labels[i]<0 || truth[i]<0)
+      continue;
+    if (groupTx[labels[i]]<0)
+      groupTx[labels[i]]=truth[i];
+    if (groupTx[labels[i]]==truth[i])
+      ++numTrue;
+    else
+      ++numMixed;
+  }
+  std::cout << " " << numTrue << " bearings grouped with their own"
+            << " transmitter, " << numMixed << " with another";
+  if (numMixed<=2 && numTrue>=0.9*numReceivers*numTx*19/20)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  double worst=0;
+  bool allDifferent=true;
+  for (int e=0; e<numEmitters; ++e)
+  {
+    for (int f=0; f<e; ++f)
+      if (groupTx[f]==groupTx[e])
+        allDifferent=false;
+    const std::vector<double> &start=associator.getEmitterLocations()[e];
+    DFLib::XY::Point fix(start);
+    groups[e]->computeMLFix(fix);
+    std::vector<double> fixXY=fix.getXY();
+    int t=groupTx[e];
+    if (t>=0)
+      worst=std::max(worst,hypot(fixXY[0]-txX[t],fixXY[1]-txY[t]));
+    else
+      allDifferent=false;
+  }
+  std::cout << " Worst ML fix of a group is " << worst
+            << " m from its transmitter";
+  if (allDifferent && worst<500)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int e=0; e<groups.size(); ++e)
+    delete groups[e];
+  for (int i=0; i<reports.size(); ++i)
+    delete reports[i];
+
+  return numFailed;
+}
@@ -0,0 +1,211 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the Cramer-Rao bound map.
+//
+// Special Notes  : The map must agree with computeCramerRaoBounds point
+//                  by point, and a map edited by adding, moving and
+//                  removing receivers must agree with one built from
+//                  the final receivers alone.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_CRB_Map.hpp"
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+
+/// largest difference between two rasters, relative to the larger value
+double maxRelativeDifference(const std::vector<double> &a,
+                             const std::vector<double> &b)
+{
+  double worst=0;
+  for (int p=0; p<int(a.size()); ++p)
+  {
+    double scale=std::max(fabs(a[p]),fabs(b[p]));
+    if (scale>0)
+      worst=std::max(worst,fabs(a[p]-b[p])/scale);
+  }
+  return worst;
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::vector<double> gridX,gridY;
+  for (int i=0; i<81; ++i)
+    gridX.push_back(-40000+1000*i);
+  for (int k=0; k<61; ++k)
+    gridY.push_back(-30000+1000*k);
+  int nx=gridX.size();
+
+  const int n=6;
+  double rx[n]={-12500,3300,17100,-6200,9900,250};
+  double ry[n]={-8100,-14300,2700,11800,15200,-600};
+  double sigmas[n];
+  for (int i=0; i<n; ++i)
+    sigmas[i]=(1+0.5*i)*M_PI/180;
+
+  DFLib::CRBMap map(gridX,gridY);
+  map.addReceivers(n,rx,ry,sigmas);
+  std::vector<double> areas,major,minor;
+  map.computeEllipseAreas(areas);
+  map.computeSemiAxes(major,minor);
+
+  // Point by point against the collection's bounds.  The bearings play
+  // no part in the bounds.
+  double bearings[n]={0,0,0,0,0,0};
+  DFLib::ArrayCollection collection(n,rx,ry,bearings,sigmas);
+  double worst=0;
+  for (int k=0; k<int(gridY.size()); k+=7)
+  {
+    for (int i=0; i<nx; i+=9)
+    {
+      std::vector<double> point(2);
+      point[0]=gridX[i];
+      point[1]=gridY[k];
+      double am2,bm2,phi;
+      collection.computeCramerRaoBounds(point,am2,bm2,phi);
+      double a=1/sqrt(std::min(am2,bm2));
+      double b=1/sqrt(std::max(am2,bm2));
+      double area=M_PI*a*b;
+      int p=k*nx+i;
+      worst=std::max(worst,fabs(areas[p]-area)/area);
+      worst=std::max(worst,fabs(major[p]-a)/a);
+      worst=std::max(worst,fabs(minor[p]-b)/b);
+    }
+  }
+  std::cout << " Largest relative difference from computeCramerRaoBounds "
+            << worst;
+  if (worst < 1e-9)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Edit a map into the same network by a roundabout route
+  DFLib::CRBMap edited(gridX,gridY);
+  int ids[n];
+  for (int i=0; i<n; ++i)
+    ids[i]=edited.addReceiver(rx[i]+5000,ry[i]-3000,sigmas[i]);
+  int extra1=edited.addReceiver(1000,1000,0.1*M_PI/180);
+  int extra2=edited.addReceiver(-20000,0,M_PI/180);
+  for (int i=0; i<n; ++i)
+    edited.moveReceiver(ids[i],rx[i],ry[i]);
+  edited.removeReceiver(extra1);
+  edited.removeReceiver(extra2);
+
+  double worstLambda=maxRelativeDifference(edited.getLambda(),map.getLambda());
+  double worstMu=maxRelativeDifference(edited.getMu(),map.getMu());
+  std::vector<double> editedAreas;
+  edited.computeEllipseAreas(editedAreas);
+  double worstArea=maxRelativeDifference(editedAreas,areas);
+  std::cout << " Edited map differs from rebuilt map by " << worstLambda
+            << ", " << worstMu << ", " << worstArea;
+  if (edited.numReceivers()==n && worstLambda<1e-9 && worstMu<1e-9
+      && worstArea<1e-9)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // A receiver on a grid point contributes nothing there, and nothing
+  // comes out NaN
+  DFLib::CRBMap onGrid(gridX,gridY);
+  onGrid.addReceiver(0,0,M_PI/180);
+  onGrid.addReceiver(10000,0,M_PI/180);
+  onGrid.addReceiver(0,10000,M_PI/180);
+  std::vector<double> onGridAreas;
+  onGrid.computeEllipseAreas(onGridAreas);
+  bool anyNaN=false;
+  for (int p=0; p<int(onGridAreas.size()); ++p)
+    anyNaN = anyNaN || (onGridAreas[p]!=onGridAreas[p]);
+  std::cout << " Receivers on grid points";
+  if (!anyNaN && onGrid.getLambda()[30*nx+40]>0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // One receiver cannot locate anything
+  DFLib::CRBMap single(gridX,gridY);
+  int only=single.addReceiver(0,0,M_PI/180);
+  std::vector<double> singleAreas;
+  single.computeEllipseAreas(singleAreas);
+  bool allInfinite=true;
+  for (int p=0; p<int(singleAreas.size()); ++p)
+    allInfinite = allInfinite && singleAreas[p]>1e300;
+  single.removeReceiver(only);
+  bool empty=true;
+  for (int p=0; p<int(single.getLambda().size()); ++p)
+    empty = empty && single.getLambda()[p]==0;
+  std::cout << " One receiver gives no bounds, none gives empty sums";
+  if (allInfinite && empty && single.numReceivers()==0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  bool threw=false;
+  try
+  {
+    single.removeReceiver(only);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    threw=true;
+  }
+  std::cout << " Removing a receiver twice";
+  if (threw)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
@@ -0,0 +1,201 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the bearing unit vector and inverse variance
+//                  that reports store when their bearing and standard
+//                  deviation are set.
+//
+// Special Notes  : 
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_LatLon_Point.hpp"
+#include "DF_LatLon_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "UnitTestScenes.hpp"
+
+/// \brief a report class that does not store anything, so gets the
+/// Abstract::Report defaults
+class BareReport : public DFLib::Abstract::Report
+{
+private:
+  std::vector<double> location;
+  double bearing,sigma;
+public:
+  BareReport(double x, double y, double b, double s)
+    : DFLib::Abstract::Report("bare",true),
+      location(2),
+      bearing(b),
+      sigma(s)
+  {
+    location[0]=x;
+    location[1]=y;
+  };
+  virtual const std::vector<double> &getReceiverLocation()
+  { return location; };
+  virtual double getReportBearingRadians() const { return bearing; };
+  virtual double getBearingStandardDeviationRadians() const { return sigma; };
+};
+
+/// \brief whether a report's stored values are what they should be
+bool matches(const DFLib::Abstract::Report &r)
+{
+  double sigma=r.getBearingStandardDeviationRadians();
+  return (r.getBearingCosine()==cos(r.getReportBearingRadians())
+          && r.getBearingSine()==sin(r.getReportBearingRadians())
+          && r.getBearingInverseVariance()==1/(sigma*sigma));
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::vector<double> loc(2);
+  loc[0]=1000;
+  loc[1]=-500;
+
+  std::cout << " XY report, constructed and changed";
+  DFLib::XY::Report xyReport(loc,-30,4,"xy");
+  bool ok=matches(xyReport);
+  xyReport.setBearing(400);
+  ok = ok && matches(xyReport);
+  xyReport.setSigma(2.5);
+  ok = ok && matches(xyReport);
+  DFLib::XY::Report xyCopy(xyReport);
+  ok = ok && matches(xyCopy)
+    && xyCopy.getBearingCosine()==xyReport.getBearingCosine();
+  if (ok)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " LatLon report, constructed and changed";
+  std::vector<double> ll(2);
+  ll[0]=-106.5;
+  ll[1]=35.1;
+  DFLib::LatLon::Report llReport(ll,123,3,"ll");
+  ok=matches(llReport);
+  llReport.setBearing(-200);
+  ok = ok && matches(llReport);
+  llReport.setSigma(7);
+  ok = ok && matches(llReport);
+  if (ok)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Defaults for report classes that store nothing";
+  BareReport bare(0,0,2.0,0.05);
+  if (matches(bare))
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Fixes computed from the reports must agree with those from the
+  // same data in arrays, also after bearings change.
+  const int n=8;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  spiralReceivers(n,5000,300,0,0.7,rx,ry);
+  for (int i=0; i<n; ++i)
+  {
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    double b=bearingTo(rx[i],ry[i],200,700)*180/M_PI+((i%3)-1)*1.5;
+    reports[i]=new DFLib::XY::Report(loc,b,2+0.5*i,"r");
+    rColl.addReport(reports[i]);
+  }
+  reports[2]->setBearing(reports[2]->getBearing()+2);
+  reports[5]->setSigma(6);
+  for (int i=0; i<n; ++i)
+  {
+    bearing[i]=reports[i]->getReportBearingRadians();
+    sigmas[i]=reports[i]->getBearingStandardDeviationRadians();
+  }
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas);
+
+  std::cout << " Least squares fix from reports";
+  std::vector<double> lsFix;
+  collection.computeLeastSquaresFix(lsFix);
+  DFLib::XY::Point lsPoint(lsFix);
+  rColl.computeLeastSquaresFix(lsPoint);
+  if (fabs(lsPoint.getXY()[0]-lsFix[0])<1e-8
+      && fabs(lsPoint.getXY()[1]-lsFix[1])<1e-8)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Stansfield fix and cost function from reports";
+  std::vector<double> sFix=lsFix;
+  double am2,bm2,phi,am2r,bm2r,phir;
+  collection.computeStansfieldFix(sFix,am2,bm2,phi);
+  DFLib::XY::Point sPoint(lsFix);
+  rColl.computeStansfieldFix(sPoint,am2r,bm2r,phir);
+  double f=collection.computeCostFunction(sFix);
+  double fr=rColl.computeCostFunction(sFix);
+  if (fabs(sPoint.getXY()[0]-sFix[0])<1e-6
+      && fabs(sPoint.getXY()[1]-sFix[1])<1e-6
+      && fabs(am2r-am2)<1e-9*fabs(am2) && fabs(bm2r-bm2)<1e-9*fabs(bm2)
+      && fabs(fr-f)<1e-9*fabs(f))
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
@@ -44,6 +44,7 @@
 #include <iostream>
 #include "DF_Abstract_Report.hpp"
 #include "DF_Abstract_Point.hpp"
+#include "Util_Fast_Math.hpp"
 #include <cmath>
 
 
@@ -51,12 +52,14 @@ namespace DFLib
 {
   DFLib::Abstract::Report::Report(std::string n, bool v)
     : ReportName_(n),
-      validReport_(v)
+      validReport_(v),
+      reportTime_(0.0)
   { }
 
   DFLib::Abstract::Report::Report(const DFLib::Abstract::Report & right)
     : ReportName_(right.ReportName_),
-      validReport_(right.validReport_)
+      validReport_(right.validReport_),
+      reportTime_(right.reportTime_)
   { }
 
   void DFLib::Abstract::Report::computeFixCut(DFLib::Abstract::Report *Report2, 
@@ -81,18 +84,20 @@ namespace DFLib
     // Thetas are always in 0<theta<2PI for the arithmetic to work:
     thetaprime  = getReportBearingRadians();
     theta2  = Report2->getReportBearingRadians();
+    double cosPrime=getBearingCosine();
+    double sinPrime=getBearingSine();
+    double cos2=Report2->getBearingCosine();
+    double sin2=Report2->getBearingSine();
 
     // Now rotate counter clockwise about the origin by thetaprime
     p2.resize(2);
-    p2[0] = p2p[0]*cos(thetaprime)-p2p[1]*sin(thetaprime);
-    p2[1] = p2p[1]*cos(thetaprime)+p2p[0]*sin(thetaprime);
-    theta2 -= thetaprime;
-    // convert theta2 to -PI<theta2<PI so our tests below work
-    while (theta2 > M_PI)
-      theta2 -= 2*M_PI;
-
-    while (theta2 < -M_PI)
-      theta2 += 2*M_PI;
+    p2[0] = p2p[0]*cosPrime-p2p[1]*sinPrime;
+    p2[1] = p2p[1]*cosPrime+p2p[0]*sinPrime;
+    // convert theta2 to -PI<theta2<=PI so our tests below work
+    theta2 = Util::wrapAngle(theta2-thetaprime);
+    // and its sine and cosine, straight from the bearing unit vectors
+    double sinTheta2 = sin2*cosPrime-cos2*sinPrime;
+    double cosTheta2 = cos2*cosPrime+sin2*sinPrime;
 
     cutAngle = fabs(theta2);
 
@@ -101,6 +106,7 @@ namespace DFLib
     {
       p2[0] *= -1;
       theta2 *= -1;
+      sinTheta2 *= -1;
     }
 
     rp.resize(2);
@@ -118,7 +124,7 @@ namespace DFLib
     else
     {
       // Compute angle that line from me to him makes with X axis:
-      phi = atan2(p2[1],p2[0]);
+      phi = Util::angleAtan2(p2[1],p2[0]);
             
       // now we have my bearing as y axis, me at origin, 
       // his bearing and his position in appropriate half-plane.
@@ -135,12 +141,12 @@ namespace DFLib
       {
         double xfp,yfp;
         // theta2 is negative, M_PI/2+theta2 is positive angle between 
-        // horizontal and beam
-        rp[1]=p2[1]+p2[0]*tan(M_PI/2+theta2);
+        // horizontal and beam, and tan(M_PI/2+theta2)=-cot(theta2)
+        rp[1]=p2[1]-p2[0]*cosTheta2/sinTheta2;
         fs=DFLib::GOOD_FIX;
         // now rotate clockwise by my theta:
-        xfp = rp[0]*cos(thetaprime)+rp[1]*sin(thetaprime);
-        yfp = rp[1]*cos(thetaprime)-rp[0]*sin(thetaprime);
+        xfp = rp[0]*cosPrime+rp[1]*sinPrime;
+        yfp = rp[1]*cosPrime-rp[0]*sinPrime;
 
 
         rp[0]=xfp+getReceiverLocation()[0]; // translate back.
@@ -154,12 +160,7 @@ namespace DFLib
   {
     double dx=aPoint[0]-getReceiverLocation()[0];
     double dy=aPoint[1]-getReceiverLocation()[1];
-    double bearingToPoint=atan2(dx , dy);
-    while (bearingToPoint < 0)
-      bearingToPoint += 2*M_PI;
-    while (bearingToPoint > 2*M_PI)
-      bearingToPoint -= 2*M_PI;
-    return (bearingToPoint);
+    return (Util::wrapBearing(Util::angleAtan2(dx , dy)));
   }
 
   double DFLib::Abstract::Report::computeDistanceToPoint(std::vector<double> &aPoint)
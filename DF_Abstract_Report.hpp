@@ -11,6 +11,15 @@ namespace DFLib
 {
   enum FixStatus {NO_DATA,GOOD_FIX,NO_FIX};
 
+  /// \brief Fix methods that computeBootstrap and computeJackknife can
+  /// rerun, in ReportCollection and ArrayCollection alike
+  enum FixMethod
+  {
+    LEAST_SQUARES_FIX,
+    STANSFIELD_FIX,
+    PSEUDO_LINEAR_FIX,
+    ML_FIX
+  };
 
   namespace Abstract
   {
@@ -22,6 +31,7 @@ namespace DFLib
     private:
       std::string ReportName_;
       bool validReport_;
+      double reportTime_;
     public:
       // pure virtual functions:
 
@@ -50,12 +60,45 @@ namespace DFLib
       virtual  double getReportBearingRadians() const = 0;
       virtual  double getBearingStandardDeviationRadians() const = 0;
 
+      /// \brief cosine of the reported bearing
+      ///
+      /// The fix computations want the bearing as a unit vector
+      /// \f$(\sin\theta,\cos\theta)\f$ far more often than as an angle.
+      /// The report classes in DFLib compute it once, when the bearing
+      /// is set, and return the stored value.  This default computes it
+      /// on every call, for report classes that do not.
+      virtual  double getBearingCosine() const
+      { return cos(getReportBearingRadians()); };
+      /// \brief sine of the reported bearing.  See getBearingCosine.
+      virtual  double getBearingSine() const
+      { return sin(getReportBearingRadians()); };
+      /// \brief \f$1/\sigma^2\f$, the weight of this report in the ML
+      /// cost function, with \f$\sigma\f$ in radians.
+      ///
+      /// Stored when the standard deviation is set, as getBearingCosine is.
+      virtual  double getBearingInverseVariance() const
+      {
+        double sigma=getBearingStandardDeviationRadians();
+        return 1/(sigma*sigma);
+      };
+
       ///\brief Return the name of this report
       virtual const std::string &getReportName() const { return ReportName_;};
 
       ///\brief set the name of this report
       virtual void setReportName(const std::string &theName) { ReportName_=theName;};
 
+      ///\brief Return the time at which this report was taken
+      ///
+      /// Times are in seconds, from whatever epoch the caller likes.
+      /// Reports that are never given a time are all at time 0, which is
+      /// right for a stationary transmitter.  Only trackers of moving
+      /// transmitters (such as DFLib::EKFTracker) look at the time.
+      virtual double getReportTime() const { return reportTime_;};
+
+      ///\brief Set the time at which this report was taken
+      virtual void setReportTime(double t) { reportTime_=t;};
+
       ///\brief Set this report as valid
       virtual void setValid() { validReport_=true;};
       ///\brief Set this report as invalid
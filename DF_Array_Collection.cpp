@@ -0,0 +1,1715 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Provide the DF fix methods of ReportCollection over
+//                  plain arrays of report data.
+//
+// Special Notes  : The algorithms here are the same as in
+//                  DF_Report_Collection.cpp, line for line, with report
+//                  accessor calls replaced by array lookups.  Keep the two
+//                  in step.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <iostream>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "DF_Array_Collection.hpp"
+#include "Util_Minimization_Methods.hpp"
+#include "Util_Misc.hpp"
+#include "Util_Contour.hpp"
+#include "Util_Fast_Math.hpp"
+#include "Util_Reduction.hpp"
+#include "gaussian_random.hpp"
+
+namespace DFLib
+{
+  // Terms of the collection-wide sums, one report at a time, for
+  // Util::deterministicSum.  The first four are ReportCollection's terms
+  // read from the arrays.  Together with the same summation order, that
+  // makes a materialized ReportCollection agree with its reports to the
+  // last bit.
+
+  /// \brief ML cost function terms at a point.  See
+  /// ReportCollection's CostFunctionTerms.
+  class ArrayCollection::CostFunctionTerms
+  {
+  private:
+    const ArrayCollection &collection;
+    double px,py;
+    int order;
+  public:
+    CostFunctionTerms(const ArrayCollection &theCollection,
+                      const std::vector<double> &point, int theOrder)
+      : collection(theCollection), px(point[0]), py(point[1]),
+        order(theOrder)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      if (!collection.isValid(i))
+        return false;
+      double dx=px-collection.xs[i];
+      double dy=py-collection.ys[i];
+      double sm=collection.sines[i];
+      double cm=collection.cosines[i];
+      double w=collection.inverseVariances[i];
+      if (order==0)
+      {
+        // bearing to point minus measured bearing, as the angle between
+        // their unit vectors, so already in range -pi<deltatheta<=pi
+        double deltatheta=Util::angleAtan2(dx*cm-dy*sm,dy*cm+dx*sm);
+        t[0]=0.5*w*(deltatheta)*(deltatheta);
+        return true;
+      }
+
+      double d=sqrt(dx*dx+dy*dy);
+      // sine and cosine of the bearing to the point
+      double c=dy/d;
+      double s=dx/d;
+      // measured bearing minus bearing to point, in -pi<deltatheta<=pi
+      double deltatheta=Util::angleAtan2(sm*c-cm*s,cm*c+sm*s);
+      t[0]=0.5*w*(deltatheta*deltatheta);
+      t[1]=(deltatheta)*w/d*(-c);
+      t[2]=(deltatheta)*w/d*( s);
+      if (order>1)
+      {
+        double coef = w/(d*d);
+        t[3]=coef*(c*c-s*c*deltatheta);
+        t[4]=coef*(-s*c-s*s*deltatheta);
+        t[5]=coef*(-s*c+c*c*deltatheta);
+        t[6]=coef*(s*s-c*s*deltatheta);
+      }
+      return true;
+    }
+  };
+
+  /// \brief least squares normal equation terms: atb1, atb2, a11, a12, a22
+  class ArrayCollection::LeastSquaresTerms
+  {
+  private:
+    const ArrayCollection &collection;
+  public:
+    LeastSquaresTerms(const ArrayCollection &theCollection)
+      : collection(theCollection)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      if (!collection.isValid(i))
+        return false;
+      double c=collection.cosines[i];
+      double s=collection.sines[i];
+      double b=collection.xs[i]*c-collection.ys[i]*s;
+      t[0]=c*b;
+      t[1]=-s*b;
+      t[2]=s*s;
+      t[3]=s*c;
+      t[4]=c*c;
+      return true;
+    }
+  };
+
+  /// \brief Fisher information terms at a point: lambda, nu, mu
+  class ArrayCollection::CramerRaoTerms
+  {
+  private:
+    const ArrayCollection &collection;
+    double px,py;
+  public:
+    CramerRaoTerms(const ArrayCollection &theCollection,
+                   const std::vector<double> &point)
+      : collection(theCollection), px(point[0]), py(point[1])
+    {};
+    bool operator()(int i, double *t) const
+    {
+      if (!collection.isValid(i))
+        return false;
+      double dx=px-collection.xs[i];
+      double dy=py-collection.ys[i];
+      double ds2=dx*dx+dy*dy;
+      double w=collection.inverseVariances[i]/(ds2*ds2);
+      t[0]=dy*dy*w;
+      t[1]=dx*dy*w;
+      t[2]=dx*dx*w;
+      return true;
+    }
+  };
+
+  /// \brief one Stansfield iteration's terms, over the reports in
+  /// iterateStansfield's index
+  ///
+  /// With step false, mu, nu and lambda.  With step true, the two
+  /// components of the step before division by the determinant, for the
+  /// given mu, nu and lambda.
+  class ArrayCollection::StansfieldTerms
+  {
+  private:
+    const std::vector<double> &distances;
+    const std::vector<double> &sines;
+    const std::vector<double> &cosines;
+    const std::vector<double> &inverseVariances;
+    const std::vector<double> &p;
+    bool step;
+    double mu,nu,lambda;
+  public:
+    StansfieldTerms(const std::vector<double> &theDistances,
+                    const std::vector<double> &theSines,
+                    const std::vector<double> &theCosines,
+                    const std::vector<double> &theInverseVariances,
+                    const std::vector<double> &theP)
+      : distances(theDistances), sines(theSines), cosines(theCosines),
+        inverseVariances(theInverseVariances), p(theP),
+        step(false), mu(0), nu(0), lambda(0)
+    {};
+    void setStep(double theMu, double theNu, double theLambda)
+    {
+      step=true;
+      mu=theMu;
+      nu=theNu;
+      lambda=theLambda;
+    };
+    bool operator()(int k, double *t) const
+    {
+      double w=inverseVariances[k]/(distances[k]*distances[k]);
+      if (!step)
+      {
+        t[0]=(sines[k]*sines[k])*w;
+        t[1]=(cosines[k]*sines[k])*w;
+        t[2]=(cosines[k]*cosines[k])*w;
+      }
+      else
+      {
+        t[0]=p[k]*(nu*sines[k]-mu*cosines[k])*w;
+        t[1]=p[k]*(lambda*sines[k]-nu*cosines[k])*w;
+      }
+      return true;
+    }
+  };
+
+  ArrayCollection::ArrayCollection(int n, const double *x, const double *y,
+                                   const double *bearing,
+                                   const double *sigma,
+                                   const unsigned char *valid)
+    :f_is_valid(false),
+     g_is_valid(false),
+     h_is_valid(false)
+  {
+    setArrays(n,x,y,bearing,sigma,valid);
+  }
+
+  ArrayCollection::~ArrayCollection()
+  {
+  }
+
+  void ArrayCollection::setArrays(int n, const double *x, const double *y,
+                                  const double *bearing, const double *sigma,
+                                  const unsigned char *valid)
+  {
+    ownCosines.resize(n);
+    ownSines.resize(n);
+    ownInverseVariances.resize(n);
+    for (int i=0; i<n; ++i)
+    {
+      ownCosines[i]=cos(bearing[i]);
+      ownSines[i]=sin(bearing[i]);
+      ownInverseVariances[i]=1/(sigma[i]*sigma[i]);
+    }
+    // &v[0] is not allowed on an empty vector
+    if (n>0)
+      setArrays(n,x,y,bearing,sigma,&ownCosines[0],&ownSines[0],
+                &ownInverseVariances[0],valid);
+    else
+      setArrays(0,x,y,bearing,sigma,0,0,0,valid);
+  }
+
+  void ArrayCollection::setArrays(int n, const double *x, const double *y,
+                                  const double *bearing, const double *sigma,
+                                  const double *cosine, const double *sine,
+                                  const double *inverseVariance,
+                                  const unsigned char *valid)
+  {
+    numReports=n;
+    xs=x;
+    ys=y;
+    bearings=bearing;
+    sigmas=sigma;
+    cosines=cosine;
+    sines=sine;
+    inverseVariances=inverseVariance;
+    valids=valid;
+    f_is_valid=false;
+    g_is_valid=false;
+    h_is_valid=false;
+  }
+
+  int ArrayCollection::numValidReports() const
+  {
+    int numVal=0;
+    for (int i=0; i < numReports; i++)
+    {
+      if (isValid(i))
+        numVal++;
+    }
+    return (numVal);
+  }
+
+  /// \brief compute least squares solution from all df reports.
+  void ArrayCollection::computeLeastSquaresFix(std::vector<double> &LS_Fix)
+  {
+    double det;
+    double sums[5];
+    Util::deterministicSum<5>(numReports,LeastSquaresTerms(*this),sums);
+    double atb1=sums[0];
+    double atb2=sums[1];
+    double a11=sums[2];
+    double a12=sums[3];
+    double a22=sums[4];
+
+    det = a11*a22-a12*a12;
+    LS_Fix.resize(2);
+    LS_Fix[0]=(a11*atb1+a12*atb2)/det;
+    LS_Fix[1]=(a12*atb1+a22*atb2)/det;
+  }
+
+  /// \brief compute ML fix
+  void ArrayCollection::computeMLFix(std::vector<double> &MLFix)
+  {
+    DFLib::Util::Minimizer bogus(this);
+    int j;
+
+    bogus.conjugateGradientMinimize(MLFix,1e-5,j);
+  }
+
+  /// \brief compute ML fix, trying harder
+  void ArrayCollection::aggressiveComputeMLFix(std::vector<double> &MLFix)
+  {
+    DFLib::Util::Minimizer bogus(this);
+    int j;
+
+    // First do a quickie Nelder-Mead simplex minimize
+    std::vector<std::vector<double> > Simplex(3);
+    Simplex[0]=MLFix;
+    Simplex[1]=MLFix;
+    Simplex[2]=MLFix;
+
+    // get gradient of cost function at base point.
+    std::vector<double> gradient;
+    double f;
+    computeCostFunctionAndGradient(Simplex[0],f,gradient);
+    // normalize:
+    f=sqrt(gradient[0]*gradient[0]+gradient[1]*gradient[1]);
+    gradient[0]/=f;
+    gradient[1]/=f;
+    // perturb along the downhill direction
+    Simplex[1][0] += -10*gradient[0];
+    Simplex[1][1] += -10*gradient[1];
+
+    // perturb along the direction orthogonal to gradient here
+    Simplex[2][0] += -10*gradient[1];
+    Simplex[2][1] +=  10*gradient[0];
+
+    try
+    {
+      int simpIndex=bogus.nelderMeadMinimize(Simplex);
+      MLFix=Simplex[simpIndex];
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      std::cerr << " Caught exception in nelderMeadMinimize:" << std::endl
+           << x.getEmsg() << std::endl;
+    }
+
+    bogus.conjugateGradientMinimize(MLFix,1e-5,j);
+  }
+
+  /// \brief Compute Stansfield fix
+  void ArrayCollection::computeStansfieldFix(std::vector<double> &SFix,
+                                             double &am2, double &bm2,
+                                             double &phi)
+  {
+    std::vector<int> index;
+
+    index.reserve(numReports);
+    for (int i=0; i<numReports; ++i)
+    {
+      if (isValid(i))
+        index.push_back(i);
+    }
+    iterateStansfield(index,SFix,am2,bm2,phi);
+  }
+
+  /// \brief Stansfield's iteration from the fix in SFix, over the reports
+  /// in index
+  ///
+  /// The reports' sines, cosines and inverse variances are gathered
+  /// into contiguous vectors first, as ReportCollection does.
+  void ArrayCollection::iterateStansfield(const std::vector<int> &index,
+                                          std::vector<double> &SFix,
+                                          double &am2, double &bm2,
+                                          double &phi) const
+  {
+    std::vector<double> initialFix = SFix;
+    std::vector<double> distances;
+    std::vector<double> indexSines;
+    std::vector<double> indexCosines;
+    std::vector<double> indexInverseVariances;
+    std::vector<double> p;   // Stansfield's "p_i"
+    std::vector<double> temp(2);
+    std::vector<double> deltas(2);
+
+    double mu, nu, lambda;
+    double lastNorm=1e100;
+    double currentNorm=1e100; // a ridiculous value to start with
+    int numIters=0;
+    double tol=sqrt(std::numeric_limits<double>::epsilon());
+
+    distances.reserve(index.size());
+    indexSines.reserve(index.size());
+    indexCosines.reserve(index.size());
+    indexInverseVariances.reserve(index.size());
+    p.reserve(index.size());
+
+    // initialize
+    for (int k=0; k<index.size(); ++k)
+    {
+      int i=index[k];
+      double dx=initialFix[0]-xs[i];
+      double dy=initialFix[1]-ys[i];
+      distances.push_back(sqrt(dx*dx+dy*dy));
+      indexSines.push_back(sines[i]);
+      indexCosines.push_back(cosines[i]);
+      indexInverseVariances.push_back(inverseVariances[i]);
+      // Cosine and sine interchanged from Stansfield because our
+      // bearing is clockwise from north, not counterclockwise from east.
+      p.push_back(cosines[i]*dx-sines[i]*dy);
+    }
+
+    // we only set these nonzero if we converge.
+    am2=bm2=0;
+
+    // we are now ready to iterate.
+    do
+    {
+      lastNorm=currentNorm;
+      // compute mu, nu, lambda
+      StansfieldTerms terms(distances,indexSines,indexCosines,
+                            indexInverseVariances,p);
+      double sums[3];
+      Util::deterministicSum<3>(p.size(),terms,sums);
+      mu=sums[0];
+      nu=sums[1];
+      lambda=sums[2];
+      double denom=lambda*mu-nu*nu;
+      terms.setStep(mu,nu,lambda);
+      Util::deterministicSum<2>(p.size(),terms,sums);
+      deltas[0]=sums[0]/denom;
+      deltas[1]=sums[1]/denom;
+      currentNorm=sqrt(deltas[0]*deltas[0]+deltas[1]*deltas[1]);
+
+      temp[0]=initialFix[0]+deltas[0];
+      temp[1]=initialFix[1]+deltas[1];
+      // now we have to generate new estimates of distance
+      for (int k=0; k< p.size(); ++k)
+      {
+        double dx=temp[0]-xs[index[k]];
+        double dy=temp[1]-ys[index[k]];
+        distances[k]=sqrt(dx*dx+dy*dy);
+      }
+
+      ++numIters;
+    } while (fabs(currentNorm-lastNorm)>tol && numIters<=100);
+
+    if (numIters > 100)
+      throw(Util::Exception("Too many iterations in computeStansfieldFix"));
+    else
+    {
+      initialFix[0] += deltas[0];
+      initialFix[1] += deltas[1];
+      SFix=initialFix;
+
+      // tan(2*phi)= -2*nu/(lambda-mu)
+      phi=.5*atan2(-2*nu,lambda-mu);
+      am2=(lambda-nu*tan(phi));
+      bm2=(mu+nu*tan(phi));
+    }
+  }
+
+  /// \brief Add the row [a1 a2 | b] to the 2x2 triangular factor R and
+  ///        right hand side z of a least squares problem, by two Givens
+  ///        rotations
+  static inline void givensAddRow(double R[3], double z[2],
+                                  double a1, double a2, double b)
+  {
+    // R[0] R[1]
+    //  0   R[2]
+    double rho=sqrt(R[0]*R[0]+a1*a1);
+    if (rho>0)
+    {
+      double c=R[0]/rho;
+      double s=a1/rho;
+      double t=R[1];
+      R[0]=rho;
+      R[1]=c*t+s*a2;
+      a2=c*a2-s*t;
+      t=z[0];
+      z[0]=c*t+s*b;
+      b=c*b-s*t;
+    }
+    rho=sqrt(R[2]*R[2]+a2*a2);
+    if (rho>0)
+    {
+      double c=R[2]/rho;
+      double s=a2/rho;
+      R[2]=rho;
+      z[1]=c*z[1]+s*b;
+    }
+  }
+
+  /// \brief Pseudo-linear fix
+  ///
+  /// Each bearing says its receiver and the transmitter p lie on one
+  /// line, a_i.p=a_i.r_i with a_i=(cos,-sin) of the bearing.  With a
+  /// bearing error e_i the line misses p by d_i sin(e_i), and since a_i
+  /// turns with e_i too, the weighted least squares solution of the
+  /// lines is biased.  Expanding to second order in the errors, with
+  /// \f$M=A^TWA\f$, weights \f$w_i=1/(d_i\sigma_i)^2\f$ and u_i the unit
+  /// vector from receiver i toward p, the bias is \f$-M^{-1}\gamma\f$,
+  /// \f[
+  ///   \gamma=\sum_i \frac{1}{d_i}\left[(1-h_i)u_i-g_i a_i\right],
+  ///   \quad h_i=w_i a_i^TM^{-1}a_i, \quad g_i=w_i u_i^TM^{-1}a_i.
+  /// \f]
+  /// The u_i term comes from the errors in the lines' offsets, and the
+  /// leverage terms h_i and g_i from the errors in M, which are
+  /// correlated with them.  Both matter; leaving out the second
+  /// overcorrects about as much as doing nothing undercorrects.
+  /// h_i and g_i are quadratic in a_i, so the sums that make up gamma
+  /// are collected in the same pass as M, and contracted with
+  /// \f$M^{-1}\f$ afterwards.
+  ///
+  /// The weighted rows are folded into a 2x2 triangular factor by Givens
+  /// rotations as they are read, so the normal equations are never
+  /// formed.  Receiver coordinates are taken relative to the first valid
+  /// receiver, so that Mercator coordinates in the millions do not cost
+  /// digits either.
+  void ArrayCollection::computePseudoLinearFix(std::vector<double> &PLFix,
+                          std::vector<std::vector<double> > &covariance,
+                          int numReweightings)
+  {
+    if (numValidReports()<2)
+      throw(Util::Exception("Need at least two valid reports in computePseudoLinearFix"));
+
+    int first=0;
+    while (!isValid(first))
+      ++first;
+    double x0=xs[first];
+    double y0=ys[first];
+
+    double fix[2]={0,0};
+    double R[3];
+    double S[3];
+    for (int pass=0; pass<=numReweightings; ++pass)
+    {
+      double z[2]={0,0};
+      // Bias sums; see the comments before this function
+      double beta[2]={0,0};
+      double T1[2][3]={{0,0,0},{0,0,0}};
+      double T2[2][3]={{0,0,0},{0,0,0}};
+      R[0]=R[1]=R[2]=0;
+      for (int i=0; i<numReports; ++i)
+      {
+        if (!isValid(i))
+          continue;
+        double rx=xs[i]-x0;
+        double ry=ys[i]-y0;
+        double a0=cosines[i];
+        double a1=-sines[i];
+        // The first pass has no distances yet, so weighs by sigma alone
+        double weight=1/sigmas[i];
+        if (pass>0)
+        {
+          double dx=fix[0]-rx;
+          double dy=fix[1]-ry;
+          double d2=dx*dx+dy*dy;
+          if (d2==0)
+            continue;
+          double d=sqrt(d2);
+          weight /= d;
+          double u[2]={dx/d,dy/d};
+          double cw=weight*weight/d;
+          for (int k=0; k<2; ++k)
+          {
+            beta[k] += u[k]/d;
+            T1[k][0] += cw*u[k]*a0*a0;
+            T1[k][1] += cw*u[k]*a0*a1;
+            T1[k][2] += cw*u[k]*a1*a1;
+            double ak=(k==0)?a0:a1;
+            T2[k][0] += cw*ak*u[0]*a0;
+            T2[k][1] += cw*ak*(u[0]*a1+u[1]*a0);
+            T2[k][2] += cw*ak*u[1]*a1;
+          }
+        }
+        givensAddRow(R,z,weight*a0,weight*a1,weight*(a0*rx+a1*ry));
+      }
+      if (R[0]==0 || fabs(R[2]) <= 1e-10*fabs(R[0]))
+        throw(Util::Exception("Bearings are all parallel in computePseudoLinearFix"));
+
+      // Back substitution R fix = z
+      fix[1]=z[1]/R[2];
+      fix[0]=(z[0]-R[1]*fix[1])/R[0];
+
+      // S = (R^T R)^{-1} = R^{-1} R^{-T}, stored as S00, S01, S11
+      double i00=1/R[0];
+      double i01=-R[1]/(R[0]*R[2]);
+      double i11=1/R[2];
+      S[0]=i00*i00+i01*i01;
+      S[1]=i01*i11;
+      S[2]=i11*i11;
+
+      if (pass>0)
+      {
+        double gamma[2];
+        for (int k=0; k<2; ++k)
+          gamma[k]=beta[k]
+            -(S[0]*T1[k][0]+2*S[1]*T1[k][1]+S[2]*T1[k][2])
+            -(S[0]*T2[k][0]+S[1]*T2[k][1]+S[2]*T2[k][2]);
+        fix[0] += S[0]*gamma[0]+S[1]*gamma[1];
+        fix[1] += S[1]*gamma[0]+S[2]*gamma[1];
+      }
+    }
+
+    PLFix.resize(2);
+    PLFix[0]=fix[0]+x0;
+    PLFix[1]=fix[1]+y0;
+
+    covariance.resize(2);
+    covariance[0].resize(2);
+    covariance[1].resize(2);
+    covariance[0][0]=S[0];
+    covariance[0][1]=covariance[1][0]=S[1];
+    covariance[1][1]=S[2];
+  }
+
+  void ArrayCollection::computePseudoLinearFix(std::vector<double> &PLFix,
+                                               double &am2, double &bm2,
+                                               double &phi,
+                                               int numReweightings)
+  {
+    std::vector<std::vector<double> > covariance;
+    computePseudoLinearFix(PLFix,covariance,numReweightings);
+
+    // Invert the covariance to get the information matrix, then proceed
+    // as computeCramerRaoBounds does.
+    double det=covariance[0][0]*covariance[1][1]
+      -covariance[0][1]*covariance[1][0];
+    double lambda=covariance[1][1]/det;
+    double mu=covariance[0][0]/det;
+    double nu=covariance[0][1]/det;
+
+    phi=.5*atan2(-2*nu,lambda-mu);
+    am2=(lambda-nu*tan(phi));
+    bm2=(mu+nu*tan(phi));
+  }
+
+  /// \brief Compute Cramer-Rao bounds
+  void ArrayCollection::computeCramerRaoBounds(const std::vector<double> &MLFix,
+                                               double &am2, double &bm2,
+                                               double &phi)
+  {
+    double sums[3];
+    Util::deterministicSum<3>(numReports,CramerRaoTerms(*this,MLFix),sums);
+    double lambda=sums[0];
+    double nu=sums[1];
+    double mu=sums[2];
+
+    phi=.5*atan2(-2*nu,lambda-mu);
+    am2=(lambda-nu*tan(phi));
+    bm2=(mu+nu*tan(phi));
+  }
+
+  /// \brief Compute Cost Function
+  double ArrayCollection::computeCostFunction(std::vector<double> &evaluationPoint)
+  {
+    // Sum over all reports
+    //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
+    double f;
+    Util::deterministicSum<1>(numReports,
+                              CostFunctionTerms(*this,evaluationPoint,0),&f);
+    return (f);
+  }
+
+  /// \brief compute cost function for point x,y and its gradient
+  void ArrayCollection::computeCostFunctionAndGradient
+  (
+   std::vector<double> &evaluationPoint,
+   double &f,
+   std::vector<double> &gradient
+   )
+  {
+    double sums[3];
+    Util::deterministicSum<3>(numReports,
+                              CostFunctionTerms(*this,evaluationPoint,1),sums);
+    f=sums[0];
+    gradient.resize(2);
+    gradient[0]=sums[1];
+    gradient[1]=sums[2];
+  }
+
+  /// \brief compute cost function for point x,y its gradient, and its hessian.
+  void ArrayCollection::computeCostFunctionAndHessian
+  (
+   std::vector<double> &evaluationPoint,
+   double &f, std::vector<double> &gradient,
+   std::vector<std::vector<double> > &hessian
+   )
+  {
+    double sums[7];
+    Util::deterministicSum<7>(numReports,
+                              CostFunctionTerms(*this,evaluationPoint,2),sums);
+    f=sums[0];
+    gradient.resize(2);
+    gradient[0]=sums[1];
+    gradient[1]=sums[2];
+    hessian.resize(2);
+    hessian[0].resize(2);
+    hessian[1].resize(2);
+    hessian[0][0]=sums[3];
+    hessian[0][1]=sums[4];
+    hessian[1][0]=sums[5];
+    hessian[1][1]=sums[6];
+  }
+
+  /// \brief Evaluate cost function on a grid
+  ///
+  /// This adds up the same terms as computeCostFunction at each grid
+  /// point, but loops over reports outside and grid points inside, so
+  /// the inner loop is a branch-free pass over contiguous memory that
+  /// the compiler can vectorize.  The terms are added plainly, in report
+  /// order, so values can differ from computeCostFunction's in the last
+  /// bits.  Grid rows are spread over threads when built with OpenMP.
+  void ArrayCollection::computeCostSurface(int nx, const double *gridX,
+                                           int ny, const double *gridY,
+                                           double *surface)
+  {
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int j=0; j<ny; ++j)
+    {
+      double *row=surface+j*nx;
+      for (int i=0; i<nx; ++i)
+        row[i]=0;
+
+      for (int k=0; k<numReports; ++k)
+      {
+        if (!isValid(k))
+          continue;
+        double rx=xs[k];
+        double dy=gridY[j]-ys[k];
+        double sm=sines[k];
+        double cm=cosines[k];
+        double w=inverseVariances[k];
+        for (int i=0; i<nx; ++i)
+        {
+          // Same angle as computeCostFunction
+          double dx=gridX[i]-rx;
+          double deltatheta=Util::angleAtan2(dx*cm-dy*sm,dy*cm+dx*sm);
+          row[i] += 0.5*w*(deltatheta)*(deltatheta);
+        }
+      }
+    }
+  }
+
+  /// \brief a grid point kept by the global search, and its cost
+  struct SearchCandidate
+  {
+    double cost;
+    double x;
+    double y;
+    bool operator<(const SearchCandidate &right) const
+    { return (cost<right.cost); };
+  };
+
+  /// \brief fill grid with n points spaced h apart, centered on c
+  static void fillGridAxis(std::vector<double> &grid, int n, double c,
+                           double h)
+  {
+    grid.resize(n);
+    for (int i=0; i<n; ++i)
+      grid[i]=c+(i-0.5*(n-1))*h;
+  }
+
+  /// \brief compute ML fix by coarse-to-fine grid search
+  int ArrayCollection::globalComputeMLFix(std::vector<double> &MLFix,
+                                          int coarseSize, int fineSize,
+                                          int numLevels, int numKeep,
+                                          double margin)
+  {
+    if (coarseSize<3 || fineSize<3 || numLevels<1 || numKeep<1)
+      throw(Util::Exception("Bad grid parameters in globalComputeMLFix"));
+    if (numValidReports()<2)
+      throw(Util::Exception("Need at least two valid reports in globalComputeMLFix"));
+
+    // Square around the valid receivers
+    double xmin=std::numeric_limits<double>::max();
+    double ymin=xmin;
+    double xmax=-xmin;
+    double ymax=-xmin;
+    for (int i=0; i<numReports; ++i)
+    {
+      if (isValid(i))
+      {
+        xmin=std::min(xmin,xs[i]);
+        xmax=std::max(xmax,xs[i]);
+        ymin=std::min(ymin,ys[i]);
+        ymax=std::max(ymax,ys[i]);
+      }
+    }
+    double extent=std::max(xmax-xmin,ymax-ymin);
+    if (extent<=0)
+      extent=1;
+    double centerX=0.5*(xmin+xmax);
+    double centerY=0.5*(ymin+ymax);
+    double halfWidth=(0.5+margin)*extent;
+
+    double h=2*halfWidth/(coarseSize-1);
+
+    // Coarse level.
+    std::vector<double> gridX,gridY,surface(coarseSize*coarseSize);
+    fillGridAxis(gridX,coarseSize,centerX,h);
+    fillGridAxis(gridY,coarseSize,centerY,h);
+    computeCostSurface(coarseSize,&gridX[0],coarseSize,&gridY[0],&surface[0]);
+    int numEvals=coarseSize*coarseSize;
+
+    // Keep grid local minima first, so that separate basins each get a
+    // candidate, then the lowest of the remaining points.
+    std::vector<SearchCandidate> minima,others;
+    for (int j=0; j<coarseSize; ++j)
+    {
+      for (int i=0; i<coarseSize; ++i)
+      {
+        SearchCandidate c;
+        c.cost=surface[j*coarseSize+i];
+        c.x=gridX[i];
+        c.y=gridY[j];
+        bool isMinimum=true;
+        for (int jj=std::max(j-1,0); jj<=std::min(j+1,coarseSize-1); ++jj)
+          for (int ii=std::max(i-1,0); ii<=std::min(i+1,coarseSize-1); ++ii)
+            if (surface[jj*coarseSize+ii] < c.cost)
+              isMinimum=false;
+        if (isMinimum)
+          minima.push_back(c);
+        else
+          others.push_back(c);
+      }
+    }
+    std::sort(minima.begin(),minima.end());
+    std::sort(others.begin(),others.end());
+    std::vector<SearchCandidate> candidates(minima);
+    candidates.insert(candidates.end(),others.begin(),others.end());
+    candidates.resize(std::min(numKeep,static_cast<int>(candidates.size())));
+
+    // Refine each candidate independently over the cells around it.
+    surface.resize(fineSize*fineSize);
+    for (int level=1; level<numLevels; ++level)
+    {
+      double hFine=2*h/(fineSize-1);
+      for (int c=0; c<candidates.size(); ++c)
+      {
+        fillGridAxis(gridX,fineSize,candidates[c].x,hFine);
+        fillGridAxis(gridY,fineSize,candidates[c].y,hFine);
+        computeCostSurface(fineSize,&gridX[0],fineSize,&gridY[0],
+                           &surface[0]);
+        numEvals += fineSize*fineSize;
+        for (int j=0; j<fineSize; ++j)
+        {
+          for (int i=0; i<fineSize; ++i)
+          {
+            if (surface[j*fineSize+i] < candidates[c].cost)
+            {
+              candidates[c].cost=surface[j*fineSize+i];
+              candidates[c].x=gridX[i];
+              candidates[c].y=gridY[j];
+            }
+          }
+        }
+      }
+      h=hFine;
+    }
+
+    // Polish.  Never accept a worse point than the grid gave us, nor one
+    // outside the search square: where the cost surface is flat,
+    // conjugate gradients can still run off toward infinity, where the
+    // cost may be lower than at any real minimum.
+    SearchCandidate best;
+    best.cost=std::numeric_limits<double>::max();
+    for (int c=0; c<candidates.size(); ++c)
+    {
+      std::vector<double> p(2);
+      p[0]=candidates[c].x;
+      p[1]=candidates[c].y;
+      SearchCandidate polished=candidates[c];
+      try
+      {
+        computeMLFix(p);
+        double f=computeCostFunction(p);
+        if (f<=candidates[c].cost
+            && fabs(p[0]-centerX)<=halfWidth && fabs(p[1]-centerY)<=halfWidth)
+        {
+          polished.cost=f;
+          polished.x=p[0];
+          polished.y=p[1];
+        }
+      }
+      catch (DFLib::Util::Exception x)
+      {
+        // keep the grid point
+      }
+      if (polished.cost<best.cost)
+        best=polished;
+    }
+
+    MLFix.resize(2);
+    MLFix[0]=best.x;
+    MLFix[1]=best.y;
+    return numEvals;
+  }
+
+  /// \brief Cost levels enclosing given fractions of posterior mass
+  ///
+  /// Rather than sorting the grid, the mass exp(-(cost-minCost)) of
+  /// every grid point is binned by cost into a fine histogram.  Walking
+  /// the histogram up from the lowest cost accumulates mass in the same
+  /// order a sort would, and the level for each probability is
+  /// interpolated within the bin where it is crossed.  Costs more than
+  /// 50 above the minimum carry no mass worth counting.
+  ///
+  /// \return total mass of the grid
+  static double posteriorLevels(const std::vector<double> &surface,
+                                double minCost,
+                                const std::vector<double> &probabilities,
+                                std::vector<double> &levels)
+  {
+    const int numBins=4096;
+    const double maxDelta=50;
+    double binWidth=maxDelta/numBins;
+    int n=surface.size();
+
+    // Bin a fixed number of contiguous slices of the grid separately
+    // and add their histograms in slice order, so the levels do not
+    // depend on the number of threads.
+    const int numSlices=std::min(64,n);
+    std::vector<double> sliceHistograms(numSlices*numBins,0.0);
+    std::vector<double> sliceTotals(numSlices,0.0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(numSlices>1)
+#endif
+    for (int slice=0; slice<numSlices; ++slice)
+    {
+      double *localHistogram=&sliceHistograms[slice*numBins];
+      int end=(static_cast<long>(slice+1)*n)/numSlices;
+      for (int k=(static_cast<long>(slice)*n)/numSlices; k<end; ++k)
+      {
+        double delta=surface[k]-minCost;
+        if (delta<maxDelta)
+        {
+          double mass=exp(-delta);
+          localHistogram[static_cast<int>(delta/binWidth)] += mass;
+          sliceTotals[slice] += mass;
+        }
+      }
+    }
+
+    std::vector<double> histogram(numBins,0.0);
+    for (int b=0; b<numBins; ++b)
+      histogram[b]=Util::pairwiseSum(&sliceHistograms[b],numSlices,numBins);
+    double total=Util::pairwiseSum(&sliceTotals[0],numSlices,1);
+
+    levels.resize(probabilities.size());
+    for (int p=0; p<probabilities.size(); ++p)
+    {
+      double target=probabilities[p]*total;
+      double accumulated=0;
+      int b=0;
+      while (b<numBins-1 && accumulated+histogram[b]<target)
+        accumulated += histogram[b++];
+      double fraction=(histogram[b]>0)?(target-accumulated)/histogram[b]:1;
+      fraction=std::min(std::max(fraction,0.0),1.0);
+      levels[p]=minCost+(b+fraction)*binWidth;
+    }
+    return total;
+  }
+
+  /// \brief compute HPD confidence regions around a fix
+  void ArrayCollection::computeConfidenceRegions
+  (const std::vector<double> &fix,
+   const std::vector<double> &probabilities,
+   std::vector<ConfidenceRegion> &regions,
+   int gridSize)
+  {
+    if (gridSize<3)
+      throw(Util::Exception("Bad grid size in computeConfidenceRegions"));
+    for (int p=0; p<probabilities.size(); ++p)
+      if (!(probabilities[p]>0 && probabilities[p]<1))
+        throw(Util::Exception("Probabilities must be between 0 and 1 in computeConfidenceRegions"));
+    if (numValidReports()<2)
+      throw(Util::Exception("Need at least two valid reports in computeConfidenceRegions"));
+
+    // Start from the Cramer-Rao ellipse.  If it is degenerate, use the
+    // distance to the farthest receiver instead.
+    double am2,bm2,phi;
+    computeCramerRaoBounds(fix,am2,bm2,phi);
+    double halfWidth;
+    if (am2>0 && bm2>0 && std::min(am2,bm2)<std::numeric_limits<double>::max())
+    {
+      halfWidth=4/sqrt(std::min(am2,bm2));
+    }
+    else
+    {
+      halfWidth=0;
+      for (int i=0; i<numReports; ++i)
+        if (isValid(i))
+          halfWidth=std::max(halfWidth,
+                             sqrt((fix[0]-xs[i])*(fix[0]-xs[i])
+                                  +(fix[1]-ys[i])*(fix[1]-ys[i])));
+    }
+    if (!(halfWidth>0))
+      halfWidth=1;
+
+    // The last level is the "support" of the posterior, used only to
+    // fit the grid to it.
+    const double borderTolerance=1e-4;
+    std::vector<double> allProbabilities(probabilities);
+    allProbabilities.push_back(1-borderTolerance);
+
+    double centerX=fix[0];
+    double centerY=fix[1];
+    bool shrunk=false;
+    std::vector<double> gridX,gridY;
+    std::vector<double> surface(gridSize*gridSize);
+    std::vector<double> levels;
+    double h;
+    for (int iter=0; ; ++iter)
+    {
+      h=2*halfWidth/(gridSize-1);
+      fillGridAxis(gridX,gridSize,centerX,h);
+      fillGridAxis(gridY,gridSize,centerY,h);
+      computeCostSurface(gridSize,&gridX[0],gridSize,&gridY[0],&surface[0]);
+      double minCost=*std::min_element(surface.begin(),surface.end());
+      double total=posteriorLevels(surface,minCost,allProbabilities,levels);
+
+      if (iter>=10)
+        break;
+
+      double border=0;
+      for (int k=0; k<gridSize; ++k)
+      {
+        border += exp(-(surface[k]-minCost));
+        border += exp(-(surface[(gridSize-1)*gridSize+k]-minCost));
+        border += exp(-(surface[k*gridSize]-minCost));
+        border += exp(-(surface[k*gridSize+gridSize-1]-minCost));
+      }
+      if (border>borderTolerance*total)
+      {
+        halfWidth *= 2;
+        continue;
+      }
+
+      if (shrunk)
+        break;
+      double xmin=std::numeric_limits<double>::max();
+      double ymin=xmin;
+      double xmax=-xmin;
+      double ymax=-xmin;
+      for (int j=0; j<gridSize; ++j)
+      {
+        for (int i=0; i<gridSize; ++i)
+        {
+          if (surface[j*gridSize+i]<=levels.back())
+          {
+            xmin=std::min(xmin,gridX[i]);
+            xmax=std::max(xmax,gridX[i]);
+            ymin=std::min(ymin,gridY[j]);
+            ymax=std::max(ymax,gridY[j]);
+          }
+        }
+      }
+      double halfBox=0.5*std::max(xmax-xmin,ymax-ymin)+h;
+      if (halfBox>=0.25*halfWidth)
+        break;
+      centerX=0.5*(xmin+xmax);
+      centerY=0.5*(ymin+ymax);
+      halfWidth=2*halfBox;
+      shrunk=true;
+    }
+
+    regions.resize(probabilities.size());
+    for (int p=0; p<probabilities.size(); ++p)
+    {
+      ConfidenceRegion &region=regions[p];
+      region.probability=probabilities[p];
+      region.threshold=levels[p];
+      int numInside=0;
+      for (int k=0; k<surface.size(); ++k)
+        if (surface[k]<=levels[p])
+          ++numInside;
+      region.area=numInside*h*h;
+      Util::contourPolygons(gridSize,&gridX[0],gridSize,&gridY[0],
+                            &surface[0],levels[p],region.polygons);
+    }
+  }
+
+  /// \brief fix of one resampled replicate by the given method
+  /// \return false if the fix failed
+  static bool replicateFix(ArrayCollection &replicate, FixMethod method,
+                           const std::vector<double> &start,
+                           double &fixX, double &fixY)
+  {
+    std::vector<double> fix=start;
+    double am2,bm2,phi;
+    try
+    {
+      switch (method)
+      {
+      case LEAST_SQUARES_FIX:
+        replicate.computeLeastSquaresFix(fix);
+        break;
+      case STANSFIELD_FIX:
+        replicate.computeStansfieldFix(fix,am2,bm2,phi);
+        break;
+      case PSEUDO_LINEAR_FIX:
+        replicate.computePseudoLinearFix(fix,am2,bm2,phi);
+        break;
+      case ML_FIX:
+        replicate.computeMLFix(fix);
+        break;
+      }
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      return false;
+    }
+    double big=std::numeric_limits<double>::max();
+    if (!(fabs(fix[0])<=big && fabs(fix[1])<=big))
+      return false;
+    fixX=fix[0];
+    fixY=fix[1];
+    return true;
+  }
+
+  /// \brief mean, bias, covariance and ellipse of the replicates
+  ///
+  /// With n successful replicates, the sum of outer products about their
+  /// mean is scaled by 1/(n-1) for the bootstrap and by (n-1)/n for the
+  /// jackknife, and the mean less fix by 1 and by n-1 respectively.
+  static void summarizeReplicates(const std::vector<double> &fix,
+                                  ResamplingEstimate &estimate,
+                                  bool jackknife)
+  {
+    int numReplicates=estimate.replicateX.size();
+    int n=0;
+    Util::NeumaierSum sumX,sumY;
+    for (int b=0; b<numReplicates; ++b)
+    {
+      if (estimate.replicateX[b]==estimate.replicateX[b])
+      {
+        ++n;
+        sumX.add(estimate.replicateX[b]);
+        sumY.add(estimate.replicateY[b]);
+      }
+    }
+    estimate.numFailed=numReplicates-n;
+    if (n<2)
+      throw(Util::Exception("Fewer than two resampled fixes succeeded"));
+    double meanX=sumX.value()/n;
+    double meanY=sumY.value()/n;
+
+    Util::NeumaierSum sumXX,sumXY,sumYY;
+    for (int b=0; b<numReplicates; ++b)
+    {
+      if (estimate.replicateX[b]==estimate.replicateX[b])
+      {
+        double dx=estimate.replicateX[b]-meanX;
+        double dy=estimate.replicateY[b]-meanY;
+        sumXX.add(dx*dx);
+        sumXY.add(dx*dy);
+        sumYY.add(dy*dy);
+      }
+    }
+    double sxx=sumXX.value();
+    double sxy=sumXY.value();
+    double syy=sumYY.value();
+    double covScale=(jackknife)?double(n-1)/n:1.0/(n-1);
+    double biasScale=(jackknife)?n-1:1;
+
+    estimate.mean.resize(2);
+    estimate.mean[0]=meanX;
+    estimate.mean[1]=meanY;
+    estimate.bias.resize(2);
+    estimate.bias[0]=biasScale*(meanX-fix[0]);
+    estimate.bias[1]=biasScale*(meanY-fix[1]);
+    estimate.covariance.assign(2,std::vector<double>(2));
+    estimate.covariance[0][0]=covScale*sxx;
+    estimate.covariance[0][1]=estimate.covariance[1][0]=covScale*sxy;
+    estimate.covariance[1][1]=covScale*syy;
+
+    // Invert the covariance to get the information matrix, then proceed
+    // as computeCramerRaoBounds does
+    double det=covScale*covScale*(sxx*syy-sxy*sxy);
+    double lambda=covScale*syy/det;
+    double mu=covScale*sxx/det;
+    double nu=covScale*sxy/det;
+    estimate.phi=.5*atan2(-2*nu,lambda-mu);
+    estimate.am2=(lambda-nu*tan(estimate.phi));
+    estimate.bm2=(mu+nu*tan(estimate.phi));
+  }
+
+  void ArrayCollection::computeBootstrap(FixMethod method,
+                                         const std::vector<double> &fix,
+                                         int numReplicates,
+                                         ResamplingEstimate &estimate,
+                                         uint64_t seed)
+  {
+    std::vector<int> validIndices;
+    for (int i=0; i<numReports; ++i)
+      if (isValid(i))
+        validIndices.push_back(i);
+    int m=validIndices.size();
+    if (m<2)
+      throw(Util::Exception("Bootstrap needs at least two valid reports"));
+
+    double nan=std::numeric_limits<double>::quiet_NaN();
+    estimate.replicateX.assign(numReplicates,nan);
+    estimate.replicateY.assign(numReplicates,nan);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // Each thread gathers its replicates' reports into its own arrays
+      std::vector<double> rx(m),ry(m),rb(m),rs(m),rc(m),rsn(m),riv(m);
+      std::vector<double> u(m);
+      ArrayCollection replicate(0,0,0,0,0);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int b=0; b<numReplicates; ++b)
+      {
+        DFLib::Util::gaussian_random_generator gen(0,1,seed,b);
+        gen.fillUniform(&u[0],m);
+        int first=-1;
+        bool distinct=false;
+        for (int k=0; k<m; ++k)
+        {
+          // u is inside (0,1), but u*m can still round up to m
+          int j=std::min(int(u[k]*m),m-1);
+          int i=validIndices[j];
+          rx[k]=xs[i];
+          ry[k]=ys[i];
+          rb[k]=bearings[i];
+          rs[k]=sigmas[i];
+          rc[k]=cosines[i];
+          rsn[k]=sines[i];
+          riv[k]=inverseVariances[i];
+          if (k==0)
+            first=j;
+          else if (j!=first)
+            distinct=true;
+        }
+        if (distinct)
+        {
+          replicate.setArrays(m,&rx[0],&ry[0],&rb[0],&rs[0],&rc[0],&rsn[0],
+                              &riv[0]);
+          replicateFix(replicate,method,fix,estimate.replicateX[b],
+                       estimate.replicateY[b]);
+        }
+      }
+    }
+
+    summarizeReplicates(fix,estimate,false);
+  }
+
+  void ArrayCollection::computeJackknife(FixMethod method,
+                                         const std::vector<double> &fix,
+                                         ResamplingEstimate &estimate)
+  {
+    std::vector<int> validIndices;
+    std::vector<unsigned char> mask(numReports);
+    for (int i=0; i<numReports; ++i)
+    {
+      mask[i]=isValid(i)?1:0;
+      if (mask[i])
+        validIndices.push_back(i);
+    }
+    int m=validIndices.size();
+    if (m<3)
+      throw(Util::Exception("Jackknife needs at least three valid reports"));
+
+    double nan=std::numeric_limits<double>::quiet_NaN();
+    estimate.replicateX.assign(m,nan);
+    estimate.replicateY.assign(m,nan);
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      // Each thread leaves reports out by clearing them in its own copy
+      // of the validity mask; the report data are shared
+      std::vector<unsigned char> replicateMask(mask);
+      ArrayCollection replicate(0,0,0,0,0);
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int k=0; k<m; ++k)
+      {
+        replicateMask[validIndices[k]]=0;
+        replicate.setArrays(numReports,xs,ys,bearings,sigmas,cosines,sines,
+                            inverseVariances,&replicateMask[0]);
+        replicateFix(replicate,method,fix,estimate.replicateX[k],
+                     estimate.replicateY[k]);
+        replicateMask[validIndices[k]]=1;
+      }
+    }
+
+    summarizeReplicates(fix,estimate,true);
+  }
+
+  /// \brief eigenvalues of the symmetric 2x2 matrix [a b; b c], smaller
+  /// first
+  static void symmetricEigenvalues(double a, double b, double c,
+                                   double &small, double &big)
+  {
+    double half=.5*(a+c);
+    double root=sqrt(.25*(a-c)*(a-c)+b*b);
+    small=half-root;
+    big=half+root;
+  }
+
+  /// \brief residual of one bearing at a point, and derivatives of the
+  /// computed bearing there
+  ///
+  /// The sine and cosine of the bearing from the receiver to the point
+  /// are just the offset (dx,dy) over the distance, and the residual is
+  /// the angle between the two bearings, from one arctangent that needs
+  /// no wrapping.  On return (gx,gy) is d(bearing)/d(x,y), which is
+  /// (c,-s)/d, and (hxx,hxy,hyy) are its second derivatives,
+  /// (-2sc, s^2-c^2, 2sc)/d^2.
+  ///
+  /// \param sm sine of the measured bearing
+  /// \param cm cosine of the measured bearing
+  /// \return measured less computed bearing, in (-pi,pi]
+  static inline double bearingResidual(double dx, double dy,
+                                       double sm, double cm,
+                                       double &gx, double &gy,
+                                       double &hxx, double &hxy, double &hyy)
+  {
+    double d2=dx*dx+dy*dy;
+    double d=sqrt(d2);
+    double s=dx/d;
+    double c=dy/d;
+    gx=c/d;
+    gy=-s/d;
+    hxx=-2*s*c/d2;
+    hxy=(s*s-c*c)/d2;
+    hyy=-hxx;
+    return Util::angleAtan2(sm*c-cm*s,cm*c+sm*s);
+  }
+
+  /// \brief solve the symmetric 2x2 system [a b; b c] x = r
+  ///
+  /// \return false, leaving x alone, unless the matrix is positive
+  /// definite and not too close to singular
+  static inline bool solvePositiveDefinite(double a, double b, double c,
+                                           const double r[2], double x[2])
+  {
+    double det=a*c-b*b;
+    if (!(a>0 && det>1e-12*a*c))
+      return false;
+    x[0]=(c*r[0]-b*r[1])/det;
+    x[1]=(a*r[1]-b*r[0])/det;
+    return true;
+  }
+
+  /// \brief order report indices by decreasing shift
+  class LargerShift
+  {
+  private:
+    const std::vector<double> &shifts;
+  public:
+    LargerShift(const std::vector<double> &theShifts) : shifts(theShifts) {};
+    bool operator()(int i, int j) const { return shifts[i]>shifts[j]; };
+  };
+
+  /// \brief fill in shifts and ranking from the leave-one-out fixes
+  static void rankLeaveOneOut(const std::vector<double> &fix,
+                              LeaveOneOutFixes &fixes)
+  {
+    int n=fixes.x.size();
+    fixes.shifts.resize(n);
+    fixes.ranking.resize(n);
+    for (int i=0; i<n; ++i)
+    {
+      if (fixes.x[i]==fixes.x[i])
+        fixes.shifts[i]=sqrt((fixes.x[i]-fix[0])*(fixes.x[i]-fix[0])
+                             +(fixes.y[i]-fix[1])*(fixes.y[i]-fix[1]));
+      else
+        fixes.shifts[i]=std::numeric_limits<double>::infinity();
+      fixes.ranking[i]=i;
+    }
+    std::stable_sort(fixes.ranking.begin(),fixes.ranking.end(),
+                     LargerShift(fixes.shifts));
+  }
+
+  /// \brief computeFixDiagnostics' sums: the chi-square, the gradient,
+  /// the Fisher information, the Hessian and the least squares
+  /// \f$A^TA\f$, the last three as 00, 01 and 11 entries
+  ///
+  /// Each valid report's residuals and the gradient of its computed
+  /// bearing are stored as they are found.
+  class ArrayCollection::DiagnosticTerms
+  {
+  private:
+    const ArrayCollection &collection;
+    double px,py;
+    std::vector<double> &residuals;
+    std::vector<double> &normalizedResiduals;
+    std::vector<double> &gx;
+    std::vector<double> &gy;
+  public:
+    DiagnosticTerms(const ArrayCollection &theCollection,
+                    const std::vector<double> &fix,
+                    std::vector<double> &theResiduals,
+                    std::vector<double> &theNormalizedResiduals,
+                    std::vector<double> &theGx, std::vector<double> &theGy)
+      : collection(theCollection), px(fix[0]), py(fix[1]),
+        residuals(theResiduals), normalizedResiduals(theNormalizedResiduals),
+        gx(theGx), gy(theGy)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      if (!collection.isValid(i))
+        return false;
+      double sm=collection.sines[i];
+      double cm=collection.cosines[i];
+      double hxx,hxy,hyy;
+      double deltatheta=bearingResidual(px-collection.xs[i],
+                                        py-collection.ys[i],sm,cm,
+                                        gx[i],gy[i],hxx,hxy,hyy);
+      double w=collection.inverseVariances[i];
+
+      residuals[i]=deltatheta;
+      normalizedResiduals[i]=deltatheta/collection.sigmas[i];
+      t[0]=deltatheta*deltatheta*w;
+      t[1]=-w*deltatheta*gx[i];
+      t[2]=-w*deltatheta*gy[i];
+      t[3]=w*gx[i]*gx[i];
+      t[4]=w*gx[i]*gy[i];
+      t[5]=w*gy[i]*gy[i];
+      t[6]=w*(gx[i]*gx[i]-deltatheta*hxx);
+      t[7]=w*(gx[i]*gy[i]-deltatheta*hxy);
+      t[8]=w*(gy[i]*gy[i]-deltatheta*hyy);
+      t[9]=cm*cm;
+      t[10]=-sm*cm;
+      t[11]=sm*sm;
+      return true;
+    }
+  };
+
+  /// \brief computeLeaveOneOutML's terms: the gradient, the Hessian and
+  /// the Fisher information, the last two as 00, 01 and 11 entries
+  ///
+  /// Report i's eight terms are also stored at 8*i in perReport, to be
+  /// taken back out of the sums one report at a time.
+  class ArrayCollection::LeaveOneOutMLTerms
+  {
+  private:
+    const ArrayCollection &collection;
+    double px,py;
+    std::vector<double> &perReport;
+  public:
+    LeaveOneOutMLTerms(const ArrayCollection &theCollection,
+                       const std::vector<double> &MLFix,
+                       std::vector<double> &thePerReport)
+      : collection(theCollection), px(MLFix[0]), py(MLFix[1]),
+        perReport(thePerReport)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      if (!collection.isValid(i))
+        return false;
+      double gx,gy,hxx,hxy,hyy;
+      double deltatheta=bearingResidual(px-collection.xs[i],
+                                        py-collection.ys[i],
+                                        collection.sines[i],
+                                        collection.cosines[i],
+                                        gx,gy,hxx,hxy,hyy);
+      double w=collection.inverseVariances[i];
+      t[0]=-w*deltatheta*gx;
+      t[1]=-w*deltatheta*gy;
+      t[5]=w*gx*gx;
+      t[6]=w*gx*gy;
+      t[7]=w*gy*gy;
+      t[2]=t[5]-w*deltatheta*hxx;
+      t[3]=t[6]-w*deltatheta*hxy;
+      t[4]=t[7]-w*deltatheta*hyy;
+      for (int k=0; k<8; ++k)
+        perReport[8*i+k]=t[k];
+      return true;
+    }
+  };
+
+  void ArrayCollection::computeFixDiagnostics(const std::vector<double> &fix,
+                                              FixDiagnostics &diagnostics)
+  {
+    diagnostics.residuals.assign(numReports,0.0);
+    diagnostics.normalizedResiduals.assign(numReports,0.0);
+    diagnostics.leverages.assign(numReports,0.0);
+    diagnostics.cooksDistances.assign(numReports,0.0);
+
+    // Gradient of each report's computed bearing, kept for the leverages
+    std::vector<double> gx(numReports,0.0),gy(numReports,0.0);
+
+    double sums[12];
+    Util::deterministicSum<12>(numReports,
+                               DiagnosticTerms(*this,fix,diagnostics.residuals,
+                                               diagnostics.normalizedResiduals,
+                                               gx,gy),
+                               sums);
+    double F00=sums[3],F01=sums[4],F11=sums[5];   // Fisher information
+    double H00=sums[6],H01=sums[7],H11=sums[8];   // Hessian of the cost
+    double A00=sums[9],A01=sums[10],A11=sums[11]; // least squares A^T A
+
+    diagnostics.chiSquare=sums[0];
+    diagnostics.degreesOfFreedom=numValidReports()-2;
+    diagnostics.gradient.resize(2);
+    diagnostics.gradient[0]=sums[1];
+    diagnostics.gradient[1]=sums[2];
+    diagnostics.hessian.assign(2,std::vector<double>(2));
+    diagnostics.hessian[0][0]=H00;
+    diagnostics.hessian[0][1]=diagnostics.hessian[1][0]=H01;
+    diagnostics.hessian[1][1]=H11;
+    diagnostics.hessianEigenvalues.resize(2);
+    symmetricEigenvalues(H00,H01,H11,diagnostics.hessianEigenvalues[0],
+                         diagnostics.hessianEigenvalues[1]);
+
+    double smallA,bigA;
+    symmetricEigenvalues(A00,A01,A11,smallA,bigA);
+    diagnostics.leastSquaresConditionNumber=
+      (smallA>1e-15*bigA)?bigA/smallA:std::numeric_limits<double>::infinity();
+
+    // Leverages and Cook's distances, if the information matrix can be
+    // inverted at all
+    double det=F00*F11-F01*F01;
+    if (det>1e-12*F00*F11)
+    {
+      double I00=F11/det;
+      double I01=-F01/det;
+      double I11=F00/det;
+      for (int i=0; i<numReports; ++i)
+      {
+        if (!isValid(i))
+          continue;
+        double h=(gx[i]*(I00*gx[i]+I01*gy[i])
+                  +gy[i]*(I01*gx[i]+I11*gy[i]))*inverseVariances[i];
+        diagnostics.leverages[i]=h;
+        double r=diagnostics.normalizedResiduals[i];
+        diagnostics.cooksDistances[i]=
+          (h<1)?r*r*h/(2*(1-h)*(1-h)):std::numeric_limits<double>::infinity();
+      }
+    }
+  }
+
+  void ArrayCollection::computeLeaveOneOutLeastSquares(LeaveOneOutFixes &fixes)
+  {
+    // Normal equations of all the reports, as in computeLeastSquaresFix,
+    // keeping each report's row of A
+    double sums[5];
+    Util::deterministicSum<5>(numReports,LeastSquaresTerms(*this),sums);
+    double atb1=sums[0];
+    double atb2=sums[1];
+    double a11=sums[2];
+    double a12=sums[3];
+    double a22=sums[4];
+    double det = a11*a22-a12*a12;
+    std::vector<double> fix(2);
+    fix[0]=(a11*atb1+a12*atb2)/det;
+    fix[1]=(a12*atb1+a22*atb2)/det;
+
+    // The inverse of the normal matrix M is [a11 a12; a12 a22]/det.
+    // For a report's row a=(c,-s) of A, Sherman-Morrison gives the fix
+    // without it as fix + u e/(1-h), for u=M^{-1}a, leverage h=a.u and
+    // residual e=a.fix-b, the report's miss distance.
+    double nan=std::numeric_limits<double>::quiet_NaN();
+    fixes.x.assign(numReports,fix[0]);
+    fixes.y.assign(numReports,fix[1]);
+    for (int i=0; i<numReports; ++i)
+    {
+      if (!isValid(i))
+        continue;
+      double c=cosines[i];
+      double s=sines[i];
+      double u0=(a11*c-a12*s)/det;
+      double u1=(a12*c-a22*s)/det;
+      double h=c*u0-s*u1;
+      double e=c*(fix[0]-xs[i])-s*(fix[1]-ys[i]);
+      if (1-h > 1e-10)
+      {
+        fixes.x[i] += u0*e/(1-h);
+        fixes.y[i] += u1*e/(1-h);
+      }
+      else
+      {
+        fixes.x[i]=fixes.y[i]=nan;
+      }
+    }
+    rankLeaveOneOut(fix,fixes);
+  }
+
+  void ArrayCollection::computeLeaveOneOutML(const std::vector<double> &MLFix,
+                                             LeaveOneOutFixes &fixes)
+  {
+    // Each valid report's terms of the gradient, Hessian and Fisher
+    // information, and their sums
+    std::vector<double> t(8*numReports);
+    double sums[8];
+    Util::deterministicSum<8>(numReports,LeaveOneOutMLTerms(*this,MLFix,t),
+                              sums);
+
+    double nan=std::numeric_limits<double>::quiet_NaN();
+    fixes.x.assign(numReports,MLFix[0]);
+    fixes.y.assign(numReports,MLFix[1]);
+    for (int i=0; i<numReports; ++i)
+    {
+      if (!isValid(i))
+        continue;
+      const double *ti=&t[8*i];
+      double r[2]={-(sums[0]-ti[0]),-(sums[1]-ti[1])};
+      double step[2];
+      if (solvePositiveDefinite(sums[2]-ti[2],sums[3]-ti[3],
+                                sums[4]-ti[4],r,step)
+          || solvePositiveDefinite(sums[5]-ti[5],sums[6]-ti[6],
+                                   sums[7]-ti[7],r,step))
+      {
+        fixes.x[i] += step[0];
+        fixes.y[i] += step[1];
+      }
+      else
+      {
+        fixes.x[i]=fixes.y[i]=nan;
+      }
+    }
+    rankLeaveOneOut(MLFix,fixes);
+  }
+
+  void ArrayCollection::computeAllFixes(AllFixes &fixes)
+  {
+    fixes.fixCutValid=false;
+    fixes.fixCutAverage.clear();
+    fixes.fixCutStdDev.clear();
+    fixes.stansfieldValid=false;
+    fixes.mlValid=false;
+    fixes.stansfieldAm2=fixes.stansfieldBm2=fixes.stansfieldPhi=0;
+    fixes.mlAm2=fixes.mlBm2=fixes.mlPhi=0;
+
+    // The least squares sums, exactly as in computeLeastSquaresFix
+    double sums[5];
+    Util::deterministicSum<5>(numReports,LeastSquaresTerms(*this),sums);
+    double atb1=sums[0];
+    double atb2=sums[1];
+    double a11=sums[2];
+    double a12=sums[3];
+    double a22=sums[4];
+    std::vector<int> index;
+    index.reserve(numReports);
+    for (int i=0; i<numReports; ++i)
+    {
+      if (isValid(i))
+        index.push_back(i);
+    }
+    double det = a11*a22-a12*a12;
+    fixes.leastSquaresFix.resize(2);
+    fixes.leastSquaresFix[0]=(a11*atb1+a12*atb2)/det;
+    fixes.leastSquaresFix[1]=(a12*atb1+a22*atb2)/det;
+    fixes.leastSquaresValid=(det>1e-12*a11*a22
+                             && fixes.leastSquaresFix[0]==fixes.leastSquaresFix[0]
+                             && fixes.leastSquaresFix[1]==fixes.leastSquaresFix[1]);
+    fixes.stansfieldFix=fixes.leastSquaresFix;
+    fixes.mlFix=fixes.leastSquaresFix;
+    if (!fixes.leastSquaresValid)
+      return;
+
+    // Nothing may be thrown out of a section, so failures are caught
+    // inside each one.  Only computeMLFix uses the cached cost function
+    // values, so the two can share this object.
+#ifdef _OPENMP
+#pragma omp parallel sections
+#endif
+    {
+#ifdef _OPENMP
+#pragma omp section
+#endif
+      {
+        try
+        {
+          iterateStansfield(index,fixes.stansfieldFix,
+                            fixes.stansfieldAm2,fixes.stansfieldBm2,
+                            fixes.stansfieldPhi);
+          fixes.stansfieldValid=true;
+        }
+        catch (Util::Exception x)
+        {
+          fixes.stansfieldValid=false;
+        }
+      }
+#ifdef _OPENMP
+#pragma omp section
+#endif
+      {
+        try
+        {
+          computeMLFix(fixes.mlFix);
+          fixes.mlValid=(fixes.mlFix[0]==fixes.mlFix[0]
+                         && fixes.mlFix[1]==fixes.mlFix[1]);
+          if (fixes.mlValid)
+            computeCramerRaoBounds(fixes.mlFix,fixes.mlAm2,fixes.mlBm2,
+                                   fixes.mlPhi);
+        }
+        catch (Util::Exception x)
+        {
+          fixes.mlValid=false;
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,534 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Provide the DF fix methods of ReportCollection over
+//                  plain arrays of receiver coordinates, bearings and
+//                  standard deviations instead of over report objects.
+//
+// Special Notes  : The collection does not copy or own the arrays it is
+//                  given.  They must stay alive and unchanged while the
+//                  collection is in use.  This is what lets the Python
+//                  bindings run fixes directly on NumPy arrays.
+//
+//                  All coordinates are XY (e.g. mercator meters), and
+//                  bearings are radians clockwise from north, as returned
+//                  by Abstract::Report::getReportBearingRadians.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_ARRAY_COLLECTION_HPP
+#define DF_ARRAY_COLLECTION_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include <stdint.h>
+#include "Util_Abstract_Group.hpp"
+#include "DF_Abstract_Report.hpp"
+
+namespace DFLib
+{
+  /// \brief A region of given posterior probability around a fix
+  ///
+  /// The region is the highest posterior density (HPD) region: the
+  /// smallest region holding the given probability of the normalized
+  /// posterior exp(-cost).  It is everything where the ML cost function
+  /// is at or below threshold.
+  struct ConfidenceRegion
+  {
+    double probability;
+    double threshold;
+    double area;
+    /// Boundary polygons, each a flat list x0,y0,x1,y1,... of XY
+    /// vertices.  A region with holes or several lobes has several.
+    std::vector<std::vector<double> > polygons;
+  };
+
+  /// \brief Spread of a fix over resampled sets of reports
+  ///
+  /// Everything is in XY coordinates.  A replicate whose fix fails
+  /// (throws, or comes out infinite or NaN) is left out of the
+  /// statistics, and its entries of replicateX and replicateY are NaN.
+  struct ResamplingEstimate
+  {
+    /// mean of the replicate fixes
+    std::vector<double> mean;
+    /// estimated bias of the fix, to be subtracted from it
+    std::vector<double> bias;
+    /// 2x2 covariance of the fix
+    std::vector<std::vector<double> > covariance;
+    /// error ellipse of the covariance, given as for
+    /// ArrayCollection::computeStansfieldFix
+    double am2;
+    double bm2;
+    double phi;
+    /// replicate fixes
+    std::vector<double> replicateX;
+    std::vector<double> replicateY;
+    int numFailed;
+  };
+
+  /// \brief How well a fix fits the reports
+  ///
+  /// Per-report vectors have one entry per report, in order, with zeros
+  /// for invalid reports.
+  struct FixDiagnostics
+  {
+    /// measured less computed bearing at the fix, in radians in
+    /// \f$(-\pi,\pi]\f$
+    std::vector<double> residuals;
+    /// residuals divided by the bearing standard deviations
+    std::vector<double> normalizedResiduals;
+    /// leverage of each report, \f$g_i^T F^{-1} g_i/\sigma_i^2\f$,
+    /// where \f$g_i\f$ is the gradient of its computed bearing and F
+    /// the Fisher information at the fix.  The leverages of all valid
+    /// reports add up to 2; a report near 1 alone fixes one direction.
+    std::vector<double> leverages;
+    /// Cook's distance of each report, how far leaving it out would
+    /// move the fix relative to the fix's uncertainty
+    std::vector<double> cooksDistances;
+    /// sum of squared normalized residuals, twice the ML cost function
+    double chiSquare;
+    /// number of valid reports less 2
+    int degreesOfFreedom;
+    /// gradient of the ML cost function at the fix
+    std::vector<double> gradient;
+    /// exact 2x2 Hessian of the ML cost function at the fix
+    std::vector<std::vector<double> > hessian;
+    /// eigenvalues of the Hessian, smaller first.  Both positive at a
+    /// true minimum.
+    std::vector<double> hessianEigenvalues;
+    /// ratio of the larger to the smaller eigenvalue of \f$A^TA\f$ of
+    /// computeLeastSquaresFix, infinite if the bearings are all
+    /// parallel
+    double leastSquaresConditionNumber;
+  };
+
+  /// \brief Fixes with each report left out in turn
+  ///
+  /// One entry per report, in order.  An invalid report's entries are
+  /// the fix of all the reports and a shift of zero.  A report the
+  /// others cannot make a fix without gets NaN coordinates and an
+  /// infinite shift.
+  struct LeaveOneOutFixes
+  {
+    std::vector<double> x;
+    std::vector<double> y;
+    /// distance from the fix of all the reports
+    std::vector<double> shifts;
+    /// report indices, largest shift first
+    std::vector<int> ranking;
+  };
+
+  /// \brief Every fix of a set of reports at once
+  ///
+  /// Filled in by computeAllFixes.  Fixes are XY, except for the fix cut
+  /// average, which is in the user coordinates of the point given to
+  /// ReportCollection::computeAllFixes, as for computeFixCutAverage.  A
+  /// fix whose valid flag is false could not be computed, and its other
+  /// fields are not to be used.
+  struct AllFixes
+  {
+    bool leastSquaresValid;
+    std::vector<double> leastSquaresFix;
+
+    /// Always false from ArrayCollection::computeAllFixes, which has no
+    /// fix cut table
+    bool fixCutValid;
+    std::vector<double> fixCutAverage;
+    std::vector<double> fixCutStdDev;
+
+    bool stansfieldValid;
+    std::vector<double> stansfieldFix;
+    /// Stansfield error ellipse
+    double stansfieldAm2;
+    double stansfieldBm2;
+    double stansfieldPhi;
+
+    bool mlValid;
+    std::vector<double> mlFix;
+    /// Cramer-Rao bounds at mlFix
+    double mlAm2;
+    double mlBm2;
+    double mlPhi;
+  };
+
+  /// \brief DF fixes computed from arrays of report data
+  ///
+  /// Report i is the receiver at (x[i],y[i]) with bearing bearing[i] and
+  /// bearing standard deviation sigma[i], both in radians.  It is used
+  /// only if valid is null or valid[i] is nonzero.
+  ///
+  /// The fixes use the cosine and sine of each bearing and the inverse
+  /// variance \f$1/\sigma_i^2\f$ rather than the bearing and sigma
+  /// themselves.  Like the reports' cached values, these are computed
+  /// once when the arrays are set, unless the caller supplies them.
+  ///
+  /// The methods are the same as those of ReportCollection and give the
+  /// same answers for the same data, but fixes are plain XY vectors
+  /// rather than Abstract::Point objects.
+  class CPL_DLL ArrayCollection : public DFLib::Abstract::Group
+  {
+  private:
+    int numReports;
+    const double *xs;
+    const double *ys;
+    const double *bearings;
+    const double *sigmas;
+    const double *cosines;
+    const double *sines;
+    const double *inverseVariances;
+    const unsigned char *valids;
+    // cosines, sines and inverse variances when the caller gave none
+    std::vector<double> ownCosines;
+    std::vector<double> ownSines;
+    std::vector<double> ownInverseVariances;
+
+    std::vector<double> evaluationPoint;
+    bool f_is_valid;
+    bool g_is_valid;
+    bool h_is_valid;
+    double function_value;
+    std::vector<double> gradient;
+    std::vector<std::vector<double> > hessian;
+
+    // Terms of the sums over reports, for Util::deterministicSum
+    class CostFunctionTerms;
+    class LeastSquaresTerms;
+    class CramerRaoTerms;
+    class StansfieldTerms;
+    class DiagnosticTerms;
+    class LeaveOneOutMLTerms;
+
+    void iterateStansfield(const std::vector<int> &index,
+                           std::vector<double> &SFix,
+                           double &am2, double &bm2, double &phi) const;
+
+    // Like ReportCollection, never copied
+    ArrayCollection(ArrayCollection &right);
+    ArrayCollection &operator=(ArrayCollection &right);
+
+  public:
+    /// \brief Make a collection that uses the given arrays in place
+    ///
+    /// \param n number of reports
+    /// \param x receiver x coordinates
+    /// \param y receiver y coordinates
+    /// \param bearing bearings in radians clockwise from north
+    /// \param sigma bearing standard deviations in radians
+    /// \param valid validity flags, or null if all reports are valid
+    ArrayCollection(int n, const double *x, const double *y,
+                    const double *bearing, const double *sigma,
+                    const unsigned char *valid=0);
+
+    virtual ~ArrayCollection();
+
+    /// \brief Point the collection at a new set of arrays
+    ///
+    /// Also required if the contents of the current arrays change, so
+    /// that no cached cost function value is reused.  The cosines and
+    /// sines of the bearings and the inverse variances are computed
+    /// here, which takes time proportional to n.
+    void setArrays(int n, const double *x, const double *y,
+                   const double *bearing, const double *sigma,
+                   const unsigned char *valid=0);
+
+    /// \brief Point the collection at a new set of arrays, with the
+    /// cosines and sines of the bearings and the inverse variances
+    /// already computed
+    ///
+    /// Nothing is computed, so this takes constant time.  For callers
+    /// that keep these up to date themselves as reports come and go.
+    /// All the arrays must describe the same reports.
+    ///
+    /// \param cosine cosines of the bearings
+    /// \param sine sines of the bearings
+    /// \param inverseVariance \f$1/\sigma^2\f$ of each report
+    void setArrays(int n, const double *x, const double *y,
+                   const double *bearing, const double *sigma,
+                   const double *cosine, const double *sine,
+                   const double *inverseVariance,
+                   const unsigned char *valid=0);
+
+    inline int size() const {return numReports;};
+
+    inline bool isValid(int i) const
+    {
+      if (i<numReports && i>=0)
+        return (valids==0 || valids[i]!=0);
+      return (false);
+    };
+
+    int numValidReports() const;
+
+    /// \brief Least squares fix.  See ReportCollection::computeLeastSquaresFix
+    void computeLeastSquaresFix(std::vector<double> &LS_Fix);
+
+    /// \brief Least squares, Stansfield and ML fixes, and the Cramer-Rao
+    /// bounds of the ML fix, in one call
+    ///
+    /// Both the Stansfield and ML fixes start from the least squares
+    /// fix and are independent of each other, so they run at the same
+    /// time when DFLib is built with OpenMP.  The answers are the same
+    /// as those of the separate methods.
+    void computeAllFixes(AllFixes &fixes);
+
+    /// \brief ML fix by conjugate gradients, starting from the given fix.
+    ///
+    /// See ReportCollection::computeMLFix
+    void computeMLFix(std::vector<double> &MLFix);
+
+    /// \brief ML fix by Nelder-Mead followed by conjugate gradients.
+    ///
+    /// See ReportCollection::aggressiveComputeMLFix
+    void aggressiveComputeMLFix(std::vector<double> &MLFix);
+
+    /// \brief ML fix by coarse-to-fine grid search, polished by
+    /// conjugate gradients.
+    ///
+    /// Unlike computeMLFix, this needs no starting guess and cannot be
+    /// led astray by the flat parts of the cost surface.  The cost
+    /// function is evaluated on a coarseSize by coarseSize grid over a
+    /// square covering the valid receivers, widened on each side by
+    /// margin times the receivers' extent.  The numKeep best cells (grid
+    /// local minima first) are each refined through numLevels-1 finer
+    /// grids of fineSize by fineSize points spanning the neighbouring
+    /// cells of the previous level.  Each survivor is then polished with
+    /// computeMLFix, and the lowest cost result is returned.
+    ///
+    /// A transmitter outside the search square will not be found; the
+    /// best point on the edge of the square is polished instead.
+    ///
+    /// \param MLFix returned fix
+    /// \return number of grid cost evaluations, which is always
+    ///   coarseSize^2 + (numLevels-1)*numKeep*fineSize^2.
+    int globalComputeMLFix(std::vector<double> &MLFix,
+                           int coarseSize=64, int fineSize=16,
+                           int numLevels=4, int numKeep=4,
+                           double margin=5.0);
+
+    /// \brief Stansfield fix, starting from the given fix.
+    ///
+    /// See ReportCollection::computeStansfieldFix.  Throws
+    /// Util::Exception if the iteration does not converge.
+    void computeStansfieldFix(std::vector<double> &SFix,double &am2,
+                              double &bm2, double &phi);
+
+    /// \brief Weighted, bias-compensated pseudo-linear fix
+    ///
+    /// See ReportCollection::computePseudoLinearFix.  Needs no starting
+    /// guess.  Throws Util::Exception with fewer than two valid reports,
+    /// or if all their bearings are parallel.
+    ///
+    /// \param PLFix returned fix
+    /// \param covariance returned 2x2 covariance of the fix
+    /// \param numReweightings number of passes after the first
+    void computePseudoLinearFix(std::vector<double> &PLFix,
+                                std::vector<std::vector<double> > &covariance,
+                                int numReweightings=3);
+
+    /// \brief Pseudo-linear fix with its error ellipse, given as for
+    /// computeStansfieldFix
+    void computePseudoLinearFix(std::vector<double> &PLFix, double &am2,
+                                double &bm2, double &phi,
+                                int numReweightings=3);
+
+    /// \brief Cramer-Rao bounds at the given fix.
+    ///
+    /// See ReportCollection::computeCramerRaoBounds
+    void computeCramerRaoBounds(const std::vector<double> &MLFix,
+                                double &am2, double &bm2, double &phi);
+
+    /// \brief Probability-mass confidence regions around a fix
+    ///
+    /// The posterior exp(-cost) is evaluated on a gridSize by gridSize
+    /// grid, normalized, and the highest posterior density region for
+    /// each requested probability is found.  Unlike the Cramer-Rao or
+    /// Stansfield ellipses, these follow the real, usually banana-shaped,
+    /// posterior and are honest when the fix is poorly conditioned.
+    ///
+    /// The grid starts out centered on fix, four Cramer-Rao standard
+    /// deviations wide in each direction.  It is doubled in size while
+    /// more than 1e-4 of the mass lies on its border, and shrunk once
+    /// to fit if the posterior turns out to fill only a small part of it.
+    /// Doubling stops after ten tries; a posterior with tails reaching to
+    /// infinity (as with two receivers and a distant transmitter) then
+    /// gets regions describing only the mass on the grid.
+    ///
+    /// \param fix the fix, normally the ML fix
+    /// \param probabilities requested probabilities, each in (0,1)
+    /// \param regions returned regions, one per probability, in order
+    /// \param gridSize number of grid points on a side
+    void computeConfidenceRegions(const std::vector<double> &fix,
+                                  const std::vector<double> &probabilities,
+                                  std::vector<ConfidenceRegion> &regions,
+                                  int gridSize=201);
+
+    /// \brief Bootstrap estimate of the spread of a fix
+    ///
+    /// Each replicate draws as many reports as there are valid ones,
+    /// with replacement, and computes the fix from them with the given
+    /// method.  Stansfield and ML replicates start from fix, which
+    /// should be the fix of all the reports by the same method.
+    /// Replicates run in parallel when DFLib is built with OpenMP, and
+    /// the reports each one draws depend only on seed and its number,
+    /// not on the number of threads.
+    ///
+    /// The covariance is the sample covariance of the replicate fixes,
+    /// and the bias is their mean less fix.  A replicate that draws one
+    /// report over and over counts as failed.
+    ///
+    /// Throws Util::Exception with fewer than two valid reports or
+    /// fewer than two successful replicates.
+    void computeBootstrap(FixMethod method, const std::vector<double> &fix,
+                          int numReplicates, ResamplingEstimate &estimate,
+                          uint64_t seed=1);
+
+    /// \brief Jackknife estimate of the spread of a fix
+    ///
+    /// There is one replicate per valid report, leaving that report
+    /// out.  With n successful replicates, the covariance is (n-1)/n
+    /// times the sum of their outer products about their mean, and the
+    /// bias is (n-1) times their mean less fix.  Replicates start and
+    /// run as in computeBootstrap.
+    ///
+    /// Throws Util::Exception with fewer than three valid reports or
+    /// fewer than two successful replicates.
+    void computeJackknife(FixMethod method, const std::vector<double> &fix,
+                          ResamplingEstimate &estimate);
+
+    /// \brief Residuals, chi-square, conditioning and influence at a fix
+    ///
+    /// Everything is computed in a single pass over the reports, with
+    /// one sine and cosine of the measured bearing, one arctangent and
+    /// one square root per report, plus a pass over the stored
+    /// per-report gradients for the leverages.
+    void computeFixDiagnostics(const std::vector<double> &fix,
+                               FixDiagnostics &diagnostics);
+
+    /// \brief Least squares fix with each report left out, in O(N)
+    ///
+    /// Leaving out one report is a rank-one downdate of the 2x2 normal
+    /// equations, so each fix follows from the fix of all the reports
+    /// and that report's own residual and leverage, without refitting.
+    /// The fixes are exact, up to rounding.
+    void computeLeaveOneOutLeastSquares(LeaveOneOutFixes &fixes);
+
+    /// \brief Approximate ML fix with each report left out, in O(N)
+    ///
+    /// Each fix is one Newton step from MLFix on the cost function
+    /// without that report, whose gradient and Hessian are those of all
+    /// the reports less the report's own terms.  That is accurate when
+    /// leaving the report out moves the fix little, and ranks reports
+    /// reliably, but can be well off for a report that alone drags the
+    /// fix far away.
+    /// Where leaving a report out leaves the Hessian indefinite, the
+    /// Fisher information stands in for it.
+    void computeLeaveOneOutML(const std::vector<double> &MLFix,
+                              LeaveOneOutFixes &fixes);
+
+    double computeCostFunction(std::vector<double> &evaluationPoint);
+    void computeCostFunctionAndGradient(std::vector<double> &evaluationPoint,
+                                        double &f,
+                                        std::vector<double> &gradf);
+    void computeCostFunctionAndHessian(std::vector<double> &evaluationPoint,
+                                       double &f,
+                                       std::vector<double> &gradf,
+                                       std::vector<std::vector<double> > &h);
+
+    /// \brief Evaluate the ML cost function on a rectangular grid
+    ///
+    /// \param nx number of grid x coordinates
+    /// \param gridX grid x coordinates
+    /// \param ny number of grid y coordinates
+    /// \param gridY grid y coordinates
+    /// \param surface returned cost, row-major with ny rows of nx values,
+    ///        so that surface[j*nx+i] is the cost at (gridX[i],gridY[j]).
+    void computeCostSurface(int nx, const double *gridX,
+                            int ny, const double *gridY,
+                            double *surface);
+
+    inline virtual void setEvaluationPoint(std::vector<double> &ep)
+    {
+      evaluationPoint = ep;
+      f_is_valid=false;
+      g_is_valid=false;
+      h_is_valid=false;
+    };
+
+    /// \return function value
+    inline virtual double getFunctionValue()
+    {
+      if (!f_is_valid)
+      {
+        function_value=computeCostFunction(evaluationPoint);
+        f_is_valid=true;
+      }
+      return function_value;
+    };
+
+    /// \param g gradient returned
+    /// \return function value
+    inline virtual double getFunctionValueAndGradient(std::vector<double> &g)
+    {
+      if (!g_is_valid)
+      {
+        computeCostFunctionAndGradient(evaluationPoint,
+                                       function_value,gradient);
+        f_is_valid=true;
+        g_is_valid=true;
+      }
+      g=gradient;
+      return function_value;
+    };
+
+    /// \param g gradient returned
+    /// \param h hessian returned
+    /// \return function value
+    inline virtual double
+    getFunctionValueAndHessian(std::vector<double> &g,
+                               std::vector<std::vector<double> > &h)
+    {
+      if (!h_is_valid)
+      {
+        computeCostFunctionAndHessian(evaluationPoint,
+                                      function_value,gradient,
+                                      hessian);
+        f_is_valid=true;
+        g_is_valid=true;
+        h_is_valid=true;
+      }
+      g=gradient;
+      h=hessian;
+      return function_value;
+    };
+  };
+}
+#endif // DF_ARRAY_COLLECTION_HPP
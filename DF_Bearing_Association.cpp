@@ -0,0 +1,396 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Hough-style grouping of bearings by transmitter
+//
+// Special Notes  : A bearing only votes in the cells near its line.  For
+//                  each grid row, the cells it reaches are found by
+//                  solving two linear inequalities for the column, so
+//                  the cost is the number of cells actually voted in
+//                  plus a constant per row and bearing.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "DF_Bearing_Association.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+#include "Util_Fast_Math.hpp"
+
+namespace DFLib
+{
+  /// \brief A local maximum of the votes
+  struct VotePeak
+  {
+    double votes;
+    double x;
+    double y;
+    // strongest first
+    bool operator<(const VotePeak &right) const
+    { return votes > right.votes; };
+  };
+
+  /// \brief Narrow the interval lo<=X<=hi by B*X<=C
+  static void clipInterval(double B, double C, double &lo, double &hi)
+  {
+    if (B>0)
+      hi=std::min(hi,C/B);
+    else if (B<0)
+      lo=std::max(lo,C/B);
+    else if (C<0)
+      hi=lo-1;
+  }
+
+  /// \brief bearing from (rx,ry) to (x,y) minus the given bearing,
+  ///        in (-pi,pi]
+  static double bearingMiss(double rx, double ry, double bearing,
+                            double x, double y)
+  {
+    double dx=x-rx;
+    double dy=y-ry;
+    double s=sin(bearing);
+    double c=cos(bearing);
+    // Rotate the bearing to north, then measure the remaining angle
+    return Util::angleAtan2(dx*c-dy*s,dy*c+dx*s);
+  }
+
+  BearingAssociator::BearingAssociator(int theGridSize, int theMinReports,
+                                       double theGate)
+    : gridSize(theGridSize),
+      minReports(theMinReports),
+      gate(theGate),
+      haveRegion(false),
+      regionX0(0),regionY0(0),regionWidth(0),
+      gridX0(0),gridY0(0),cellSize(0)
+  {
+    if (gridSize<3 || minReports<2 || !(gate>0))
+      throw(Util::Exception("Bad parameters for BearingAssociator"));
+  }
+
+  void BearingAssociator::setRegion(double x0, double y0, double width)
+  {
+    if (!(width>0))
+      throw(Util::Exception("BearingAssociator region must have positive width"));
+    regionX0=x0;
+    regionY0=y0;
+    regionWidth=width;
+    haveRegion=true;
+  }
+
+  int BearingAssociator::associate(int n, const double *x, const double *y,
+                                   const double *bearing,
+                                   const double *sigma,
+                                   const unsigned char *valid,
+                                   std::vector<int> &labels)
+  {
+    labels.assign(n,-1);
+    emitters.clear();
+
+    std::vector<int> used;
+    for (int i=0; i<n; ++i)
+      if (!valid || valid[i])
+        used.push_back(i);
+    int numUsed=used.size();
+    if (numUsed<minReports)
+    {
+      votes.assign(gridSize*gridSize,0.0);
+      return 0;
+    }
+
+    if (haveRegion)
+    {
+      gridX0=regionX0;
+      gridY0=regionY0;
+      cellSize=regionWidth/gridSize;
+    }
+    else
+    {
+      double xmin=std::numeric_limits<double>::max();
+      double ymin=xmin;
+      double xmax=-xmin;
+      double ymax=-xmin;
+      for (int k=0; k<numUsed; ++k)
+      {
+        xmin=std::min(xmin,x[used[k]]);
+        xmax=std::max(xmax,x[used[k]]);
+        ymin=std::min(ymin,y[used[k]]);
+        ymax=std::max(ymax,y[used[k]]);
+      }
+      double extent=std::max(xmax-xmin,ymax-ymin);
+      if (extent<=0)
+        extent=1;
+      gridX0=0.5*(xmin+xmax)-1.5*extent;
+      gridY0=0.5*(ymin+ymax)-1.5*extent;
+      cellSize=3*extent/gridSize;
+    }
+    double h=cellSize;
+
+    // Per-line constants, copied once so the vote loop is a straight
+    // pass over arrays
+    std::vector<double> rx(numUsed),ry(numUsed),sines(numUsed),
+      cosines(numUsed),sigma2(numUsed),spread(numUsed);
+    for (int k=0; k<numUsed; ++k)
+    {
+      int i=used[k];
+      rx[k]=x[i];
+      ry[k]=y[i];
+      sines[k]=sin(bearing[i]);
+      cosines[k]=cos(bearing[i]);
+      sigma2[k]=sigma[i]*sigma[i];
+      spread[k]=gate*sigma[i];
+    }
+    // Near the receiver the line is widened to half a cell diagonal
+    double margin=gate*h/sqrt(2.0);
+    double gate2=gate*gate;
+    double halfH2=0.5*h*h;
+
+    votes.assign(gridSize*gridSize,0.0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic,4)
+#endif
+    for (int j=0; j<gridSize; ++j)
+    {
+      double *row=&votes[j*gridSize];
+      double yc=gridY0+(j+0.5)*h;
+      for (int k=0; k<numUsed; ++k)
+      {
+        double s=sines[k];
+        double c=cosines[k];
+        double t=spread[k];
+        double dy=yc-ry[k];
+
+        // Cells within the cone |cross| <= t*along+margin, where cross
+        // and along are the cell center's offsets across and along the
+        // line.  No cell outside it can pass the test below.  Both sides
+        // of the cone are linear in X=x-rx.
+        double lo=-std::numeric_limits<double>::max();
+        double hi=std::numeric_limits<double>::max();
+        clipInterval(c-t*s,s*dy+t*c*dy+margin,lo,hi);
+        clipInterval(-c-t*s,-s*dy+t*c*dy+margin,lo,hi);
+        if (lo>hi)
+          continue;
+
+        double first=ceil((rx[k]+lo-gridX0)/h-0.5);
+        double last=floor((rx[k]+hi-gridX0)/h-0.5);
+        int iFirst=(first>0)?static_cast<int>(std::min(first,double(gridSize))):0;
+        int iLast=(last<gridSize-1)?static_cast<int>(std::max(last,-1.0)):gridSize-1;
+        // No branches, so that this loop vectorizes
+        double sig2=sigma2[k];
+        double dx0=gridX0+0.5*h-rx[k];
+        for (int i=iFirst; i<=iLast; ++i)
+        {
+          double dx=dx0+i*h;
+          double along=dx*s+dy*c;
+          double cross=dx*c-dy*s;
+          double vote=1-cross*cross/(gate2*(sig2*along*along+halfH2));
+          row[i] += (vote>0 && along>0)?vote:0.0;
+        }
+      }
+    }
+
+    // Local maxima strong enough that minReports lines might cross there
+    std::vector<VotePeak> peaks;
+    double minVotes=0.5*minReports;
+    for (int j=0; j<gridSize; ++j)
+    {
+      for (int i=0; i<gridSize; ++i)
+      {
+        double v=votes[j*gridSize+i];
+        if (v<minVotes)
+          continue;
+        bool isMaximum=true;
+        for (int jj=std::max(j-1,0); jj<=std::min(j+1,gridSize-1); ++jj)
+          for (int ii=std::max(i-1,0); ii<=std::min(i+1,gridSize-1); ++ii)
+            if (votes[jj*gridSize+ii] > v)
+              isMaximum=false;
+        if (isMaximum)
+        {
+          VotePeak p;
+          p.votes=v;
+          p.x=gridX0+(i+0.5)*h;
+          p.y=gridY0+(j+0.5)*h;
+          peaks.push_back(p);
+        }
+      }
+    }
+    std::sort(peaks.begin(),peaks.end());
+
+    // Strongest first, each peak claims the unclaimed lines through it
+    int numUnclaimed=numUsed;
+    std::vector<int> claimed;
+    for (int p=0; p<peaks.size() && numUnclaimed>=minReports; ++p)
+    {
+      claimed.clear();
+      for (int k=0; k<numUsed; ++k)
+      {
+        int i=used[k];
+        if (labels[i]>=0)
+          continue;
+        double dx=peaks[p].x-rx[k];
+        double dy=peaks[p].y-ry[k];
+        double d2=dx*dx+dy*dy;
+        if (d2==0)
+          continue;
+        double dtheta=bearingMiss(rx[k],ry[k],bearing[i],
+                                  peaks[p].x,peaks[p].y);
+        if (dtheta*dtheta <= gate2*(sigma2[k]+halfH2/d2))
+          claimed.push_back(i);
+      }
+      if (claimed.size()>=minReports)
+      {
+        int label=emitters.size();
+        for (int k=0; k<claimed.size(); ++k)
+          labels[claimed[k]]=label;
+        numUnclaimed -= claimed.size();
+        std::vector<double> location(2);
+        location[0]=peaks[p].x;
+        location[1]=peaks[p].y;
+        emitters.push_back(location);
+      }
+    }
+
+    // A peak is only good to a cell or so, and the strongest peaks claim
+    // first, so lines passing near two emitters may have gone to the
+    // wrong one.  Move each emitter to the ML fix of its group, then give
+    // every line to the emitter it misses by the fewest standard
+    // deviations, and do it all once more.
+    // The trig is done once here, not every time the groups change
+    std::vector<double> usedBearing(numUsed),usedSigma(numUsed);
+    std::vector<double> usedCosine(numUsed),usedSine(numUsed);
+    std::vector<double> usedInverseVariance(numUsed);
+    for (int k=0; k<numUsed; ++k)
+    {
+      usedBearing[k]=bearing[used[k]];
+      usedSigma[k]=sigma[used[k]];
+      usedCosine[k]=cos(usedBearing[k]);
+      usedSine[k]=sin(usedBearing[k]);
+      usedInverseVariance[k]=1/(usedSigma[k]*usedSigma[k]);
+    }
+    std::vector<unsigned char> inGroup(numUsed);
+    DFLib::ArrayCollection group(0,0,0,0,0);
+    for (int pass=0; pass<2 && !emitters.empty(); ++pass)
+    {
+      for (int e=0; e<emitters.size(); ++e)
+      {
+        for (int k=0; k<numUsed; ++k)
+          inGroup[k]=(labels[used[k]]==e)?1:0;
+        // new contents, so no cached cost may be reused
+        group.setArrays(numUsed,&rx[0],&ry[0],&usedBearing[0],
+                        &usedSigma[0],&usedCosine[0],&usedSine[0],
+                        &usedInverseVariance[0],&inGroup[0]);
+        group.computeMLFix(emitters[e]);
+      }
+
+      std::vector<int> groupSize(emitters.size(),0);
+      for (int k=0; k<numUsed; ++k)
+      {
+        int best=-1;
+        double bestMiss2=gate2;
+        for (int e=0; e<emitters.size(); ++e)
+        {
+          double dtheta=bearingMiss(rx[k],ry[k],usedBearing[k],
+                                    emitters[e][0],emitters[e][1]);
+          double miss2=dtheta*dtheta/sigma2[k];
+          if (miss2<=bestMiss2)
+          {
+            best=e;
+            bestMiss2=miss2;
+          }
+        }
+        labels[used[k]]=best;
+        if (best>=0)
+          ++groupSize[best];
+      }
+
+      // Drop emitters left with too few lines, and renumber the rest
+      std::vector<int> newLabel(emitters.size(),-1);
+      std::vector<std::vector<double> > kept;
+      for (int e=0; e<emitters.size(); ++e)
+      {
+        if (groupSize[e]>=minReports)
+        {
+          newLabel[e]=kept.size();
+          kept.push_back(emitters[e]);
+        }
+      }
+      emitters.swap(kept);
+      for (int k=0; k<numUsed; ++k)
+        if (labels[used[k]]>=0)
+          labels[used[k]]=newLabel[labels[used[k]]];
+    }
+    return emitters.size();
+  }
+
+  int BearingAssociator::associate(DFLib::ReportCollection &collection,
+                                   std::vector<int> &labels)
+  {
+    int n=collection.size();
+    std::vector<double> x(n),y(n),bearing(n),sigma(n);
+    std::vector<unsigned char> valid(n);
+    for (int i=0; i<n; ++i)
+    {
+      const std::vector<double> &loc=collection.getReceiverLocationXY(i);
+      const DFLib::Abstract::Report *report=collection.getReport(i);
+      x[i]=loc[0];
+      y[i]=loc[1];
+      bearing[i]=report->getReportBearingRadians();
+      sigma[i]=report->getBearingStandardDeviationRadians();
+      valid[i]=report->isValid()?1:0;
+    }
+    // &v[0] is not allowed on an empty vector
+    if (n>0)
+      return associate(n,&x[0],&y[0],&bearing[0],&sigma[0],&valid[0],
+                       labels);
+    return associate(0,0,0,0,0,0,labels);
+  }
+
+  int BearingAssociator::associate(DFLib::ReportCollection &collection,
+                     std::vector<DFLib::ReportCollection *> &emitterReports)
+  {
+    std::vector<int> labels;
+    int numEmitters=associate(collection,labels);
+    std::vector<std::vector<int> > members(numEmitters);
+    for (int i=0; i<labels.size(); ++i)
+      if (labels[i]>=0)
+        members[labels[i]].push_back(i);
+    emitterReports.resize(numEmitters);
+    for (int e=0; e<numEmitters; ++e)
+      emitterReports[e]=collection.makeSubset(members[e]);
+    return numEmitters;
+  }
+}
@@ -0,0 +1,162 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Split bearings from several transmitters on the same
+//                  frequency into one group per transmitter.
+//
+// Special Notes  : Every bearing line votes into a grid covering the
+//                  search area, as in a Hough transform.  Places where
+//                  many lines cross collect many votes, and the reports
+//                  whose lines pass through the strongest places are
+//                  grouped together.
+//
+//                  Each row of the grid is filled by one thread from
+//                  every bearing, so no two threads ever write the same
+//                  cell and the votes do not depend on the number of
+//                  threads.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_BEARING_ASSOCIATION_HPP
+#define DF_BEARING_ASSOCIATION_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+
+namespace DFLib
+{
+  class ReportCollection;
+
+  /// \brief Group bearings by the transmitter they point at
+  ///
+  /// A bearing line adds a vote of \f$1-e^2/g^2w^2\f$ to every grid cell
+  /// ahead of its receiver that it misses by less than g line widths,
+  /// where e is the distance from the cell's center to the line and g
+  /// is the gate.  The line's width, \f$w^2=\sigma^2a^2+h^2/2\f$ for a
+  /// cell of width h at distance a along the line, is the bearing's own
+  /// uncertainty widened just enough that a line is never lost between
+  /// cell centers.  (For small misses \f$e/a\f$ is the bearing error,
+  /// so this needs no arctangent per cell.)  The sum of votes in a cell
+  /// is then roughly the number of lines that pass through it.
+  ///
+  /// Local maxima of the votes are taken strongest first.  Each claims
+  /// every not yet claimed report whose bearing passes within gate
+  /// standard deviations of it, and becomes an emitter if it claims at
+  /// least minReports of them.  Claiming reports one peak at a time
+  /// keeps a strong transmitter from also showing up as the weaker
+  /// maxima around it.
+  ///
+  /// Finally each emitter is moved to the ML fix of its group and every
+  /// report is given to the emitter its bearing misses by the fewest
+  /// standard deviations, twice over.  That undoes most of the mistakes
+  /// that the coarse grid and the strongest-first claiming make with
+  /// lines that pass near more than one emitter.
+  class CPL_DLL BearingAssociator
+  {
+  private:
+    int gridSize;
+    int minReports;
+    double gate;
+    bool haveRegion;
+    double regionX0,regionY0,regionWidth;
+    std::vector<double> votes;
+    double gridX0,gridY0,cellSize;
+    std::vector<std::vector<double> > emitters;
+
+  public:
+    /// \brief Make an associator
+    ///
+    /// \param theGridSize the vote grid is theGridSize by theGridSize
+    ///        cells
+    /// \param theMinReports fewest reports that make an emitter
+    /// \param theGate how far, in standard deviations, a bearing may
+    ///        miss an emitter and still be assigned to it
+    BearingAssociator(int theGridSize=256, int theMinReports=3,
+                      double theGate=3.0);
+
+    /// \brief Search only the square with lower left corner (x0,y0)
+    ///        and the given width
+    ///
+    /// By default the square covers the valid receivers, widened on each
+    /// side by their extent.
+    void setRegion(double x0, double y0, double width);
+    /// \brief Go back to the default region
+    inline void clearRegion() { haveRegion=false; };
+
+    /// \brief Group bearings given as arrays, as for ArrayCollection
+    ///
+    /// \param n number of bearings
+    /// \param x receiver x coordinates
+    /// \param y receiver y coordinates
+    /// \param bearing bearings in radians clockwise from north
+    /// \param sigma bearing standard deviations in radians
+    /// \param valid 0 for bearings to leave out; may be null
+    /// \param labels set to the emitter number of each bearing, or -1
+    ///        for bearings not assigned to any emitter
+    /// \return number of emitters found
+    int associate(int n, const double *x, const double *y,
+                  const double *bearing, const double *sigma,
+                  const unsigned char *valid, std::vector<int> &labels);
+
+    /// \brief Group the valid reports of a collection
+    ///
+    /// \param labels set to the emitter number of each report, or -1
+    /// \return number of emitters found
+    int associate(DFLib::ReportCollection &collection,
+                  std::vector<int> &labels);
+
+    /// \brief Split a collection into one new collection per emitter
+    ///
+    /// The new collections hold the same report objects as the original
+    /// and, like it, do not own them.  The caller must delete the new
+    /// collections.
+    ///
+    /// \return number of emitters found
+    int associate(DFLib::ReportCollection &collection,
+                  std::vector<DFLib::ReportCollection *> &emitterReports);
+
+    /// \brief Position of each emitter of the last association,
+    ///        strongest first
+    inline const std::vector<std::vector<double> > &getEmitterLocations()
+      const
+    { return emitters; };
+
+    /// \brief Votes of the last association, row by row from the bottom
+    ///
+    /// Cell (i,j) is centered at x0+(i+.5)*h, y0+(j+.5)*h.
+    inline const std::vector<double> &getVotes() const { return votes; };
+    inline int getGridSize() const { return gridSize; };
+    /// \brief lower left corner and cell width of the last vote grid
+    inline void getGrid(double &x0, double &y0, double &h) const
+    { x0=gridX0; y0=gridY0; h=cellSize; };
+  };
+}
+#endif // DF_BEARING_ASSOCIATION_HPP
@@ -0,0 +1,271 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Cramer-Rao bound maps of receiver networks
+//
+// Special Notes  : Rows of the grid are shared out among threads when
+//                  DFLib is built with OpenMP.  Within a row, each
+//                  receiver's terms are added by a loop over the
+//                  columns with no branches and no function calls, which
+//                  the compiler vectorizes.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "DF_CRB_Map.hpp"
+#include "Util_Misc.hpp"
+
+namespace DFLib
+{
+  /// \brief add n receivers' terms, times weights w, to one row
+  ///
+  /// w is 1/sigma^2, negated to take receivers out.
+  static void addRowTerms(int nx, const double *gx, double py,
+                          int n, const double *rx, const double *ry,
+                          const double *w,
+                          double *lambda, double *mu, double *nu)
+  {
+    for (int k=0; k<n; ++k)
+    {
+      double x0=rx[k];
+      double dy=py-ry[k];
+      double dy2=dy*dy;
+      double wk=w[k];
+      if (dy2>0)
+      {
+        // Every point of the row is off the receiver, so no guard is
+        // needed, and the loop vectorizes.
+        for (int i=0; i<nx; ++i)
+        {
+          double dx=gx[i]-x0;
+          double d2=dx*dx+dy2;
+          double f=wk/(d2*d2);
+          lambda[i] += f*dy2;
+          mu[i] += f*dx*dx;
+          nu[i] += f*dx*dy;
+        }
+      }
+      else
+      {
+        // The row through the receiver: nothing from it at a point
+        // right on it
+        for (int i=0; i<nx; ++i)
+        {
+          double dx=gx[i]-x0;
+          if (dx!=0)
+            mu[i] += wk/(dx*dx);
+        }
+      }
+    }
+  }
+
+  CRBMap::CRBMap(const std::vector<double> &theGridX,
+                 const std::vector<double> &theGridY)
+    : gridX(theGridX),
+      gridY(theGridY),
+      lambda(theGridX.size()*theGridY.size(),0.0),
+      mu(theGridX.size()*theGridY.size(),0.0),
+      nu(theGridX.size()*theGridY.size(),0.0),
+      numActive(0),
+      changesSinceRefresh(0)
+  {
+    if (gridX.empty() || gridY.empty())
+      throw(Util::Exception("CRBMap needs at least one grid point"));
+  }
+
+  void CRBMap::addTerms(const Receiver &r, double sign)
+  {
+    double w=sign/(r.sigma*r.sigma);
+    int nx=gridX.size();
+    int ny=gridY.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int k=0; k<ny; ++k)
+      addRowTerms(nx,&gridX[0],gridY[k],1,&r.x,&r.y,&w,
+                  &lambda[k*nx],&mu[k*nx],&nu[k*nx]);
+  }
+
+  /// \brief count a removal or move, and refresh once there are enough
+  void CRBMap::noteChange()
+  {
+    if (++changesSinceRefresh >= numActive)
+      refresh();
+  }
+
+  int CRBMap::addReceiver(double x, double y, double sigma)
+  {
+    return addReceivers(1,&x,&y,&sigma);
+  }
+
+  int CRBMap::addReceivers(int n, const double *x, const double *y,
+                           const double *sigma)
+  {
+    int firstId=receivers.size();
+    if (n<=0)
+      return firstId;
+
+    std::vector<double> w(n);
+    for (int j=0; j<n; ++j)
+    {
+      if (!(sigma[j]>0))
+        throw(Util::Exception("CRBMap receivers need positive standard deviations"));
+      Receiver r;
+      r.x=x[j];
+      r.y=y[j];
+      r.sigma=sigma[j];
+      r.active=true;
+      receivers.push_back(r);
+      w[j]=1/(sigma[j]*sigma[j]);
+    }
+    numActive += n;
+
+    int nx=gridX.size();
+    int ny=gridY.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int k=0; k<ny; ++k)
+      addRowTerms(nx,&gridX[0],gridY[k],n,x,y,&w[0],
+                  &lambda[k*nx],&mu[k*nx],&nu[k*nx]);
+    return firstId;
+  }
+
+  void CRBMap::removeReceiver(int id)
+  {
+    if (id<0 || id>=int(receivers.size()) || !receivers[id].active)
+      throw(Util::Exception("CRBMap::removeReceiver given a bad receiver id"));
+    addTerms(receivers[id],-1.0);
+    receivers[id].active=false;
+    --numActive;
+    noteChange();
+  }
+
+  void CRBMap::moveReceiver(int id, double x, double y)
+  {
+    if (id<0 || id>=int(receivers.size()) || !receivers[id].active)
+      throw(Util::Exception("CRBMap::moveReceiver given a bad receiver id"));
+
+    // Old position out and new position in, in the same pass
+    Receiver &r=receivers[id];
+    double rx[2]={r.x,x};
+    double ry[2]={r.y,y};
+    double w[2]={-1/(r.sigma*r.sigma),1/(r.sigma*r.sigma)};
+    r.x=x;
+    r.y=y;
+    int nx=gridX.size();
+    int ny=gridY.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int k=0; k<ny; ++k)
+      addRowTerms(nx,&gridX[0],gridY[k],2,rx,ry,w,
+                  &lambda[k*nx],&mu[k*nx],&nu[k*nx]);
+    noteChange();
+  }
+
+  void CRBMap::refresh()
+  {
+    std::vector<double> rx,ry,w;
+    for (int j=0; j<int(receivers.size()); ++j)
+    {
+      if (receivers[j].active)
+      {
+        rx.push_back(receivers[j].x);
+        ry.push_back(receivers[j].y);
+        w.push_back(1/(receivers[j].sigma*receivers[j].sigma));
+      }
+    }
+    std::fill(lambda.begin(),lambda.end(),0.0);
+    std::fill(mu.begin(),mu.end(),0.0);
+    std::fill(nu.begin(),nu.end(),0.0);
+    changesSinceRefresh=0;
+    if (rx.empty())
+      return;
+
+    int n=rx.size();
+    int nx=gridX.size();
+    int ny=gridY.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int k=0; k<ny; ++k)
+      addRowTerms(nx,&gridX[0],gridY[k],n,&rx[0],&ry[0],&w[0],
+                  &lambda[k*nx],&mu[k*nx],&nu[k*nx]);
+  }
+
+  void CRBMap::computeEllipseAreas(std::vector<double> &areas) const
+  {
+    int np=lambda.size();
+    double inf=std::numeric_limits<double>::infinity();
+    areas.resize(np);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int p=0; p<np; ++p)
+    {
+      double det=lambda[p]*mu[p]-nu[p]*nu[p];
+      // Relative threshold, so collinear points come out infinite
+      // rather than as huge numbers made of rounding error
+      areas[p]=(det>1e-12*(lambda[p]*mu[p]))?M_PI/sqrt(det):inf;
+    }
+  }
+
+  void CRBMap::computeSemiAxes(std::vector<double> &major,
+                               std::vector<double> &minor) const
+  {
+    int np=lambda.size();
+    double inf=std::numeric_limits<double>::infinity();
+    major.resize(np);
+    minor.resize(np);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int p=0; p<np; ++p)
+    {
+      // Eigenvalues of the information matrix
+      // [lambda -nu; -nu mu]; the small one belongs to the major axis.
+      double half=.5*(lambda[p]+mu[p]);
+      double diff=.5*(lambda[p]-mu[p]);
+      double root=sqrt(diff*diff+nu[p]*nu[p]);
+      double big=half+root;
+      double small=half-root;
+      major[p]=(small>1e-12*big)?1/sqrt(small):inf;
+      minor[p]=(big>0)?1/sqrt(big):inf;
+    }
+  }
+}
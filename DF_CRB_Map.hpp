@@ -0,0 +1,155 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Cramer-Rao bound of a receiver network over a whole
+//                  grid of possible transmitter positions, for siting
+//                  receivers.
+//
+// Special Notes  : The bound at a point depends only on the Fisher
+//                  information sums lambda, mu and nu of
+//                  ReportCollection::computeCramerRaoBounds, and every
+//                  receiver adds its own terms to them.  The map keeps
+//                  the three sums for every grid point, so adding,
+//                  removing or moving one receiver costs one pass over
+//                  the grid no matter how many receivers there are.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_CRB_MAP_HPP
+#define DF_CRB_MAP_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+
+namespace DFLib
+{
+  /// \brief Fisher information and Cramer-Rao bounds over a grid
+  ///
+  /// Rasters are row-major with gridY.size() rows of gridX.size()
+  /// values, as in ArrayCollection::computeCostSurface, so value k*nx+i
+  /// belongs to the point (gridX[i],gridY[k]).
+  ///
+  /// Each receiver is given by its position and the standard deviation
+  /// of its bearings, and adds
+  /// \f$(dy^2, dx^2, dx\,dy)/(\sigma^2 d^4)\f$ to (lambda, mu, nu) at
+  /// each grid point, where (dx,dy) is the offset from the receiver to
+  /// the point.  A grid point exactly on a receiver gets nothing from it.
+  ///
+  /// Removing a receiver subtracts its terms again, which near the
+  /// receiver means subtracting large numbers.  To keep the rounding
+  /// error that leaves behind from building up, the sums are recomputed
+  /// from scratch once there have been as many removals and moves as
+  /// there are receivers.
+  class CPL_DLL CRBMap
+  {
+  private:
+    struct Receiver
+    {
+      double x;
+      double y;
+      double sigma;
+      bool active;
+    };
+
+    std::vector<double> gridX;
+    std::vector<double> gridY;
+    std::vector<double> lambda;
+    std::vector<double> mu;
+    std::vector<double> nu;
+    std::vector<Receiver> receivers;
+    int numActive;
+    int changesSinceRefresh;
+
+    void addTerms(const Receiver &r, double sign);
+    void noteChange();
+
+  public:
+    /// \brief Make a map with no receivers
+    ///
+    /// \param theGridX x coordinates of the grid columns
+    /// \param theGridY y coordinates of the grid rows
+    CRBMap(const std::vector<double> &theGridX,
+           const std::vector<double> &theGridY);
+
+    /// \brief Add a receiver
+    /// \return the receiver's id, for moveReceiver and removeReceiver
+    int addReceiver(double x, double y, double sigma);
+
+    /// \brief Add several receivers in one pass over the grid
+    ///
+    /// Ids are assigned in order, as if each had been added with
+    /// addReceiver.
+    ///
+    /// \return id of the first one
+    int addReceivers(int n, const double *x, const double *y,
+                     const double *sigma);
+
+    /// \brief Take a receiver out of the map
+    void removeReceiver(int id);
+
+    /// \brief Move a receiver, keeping its id and standard deviation
+    void moveReceiver(int id, double x, double y);
+
+    /// \brief Recompute the sums from the current receivers
+    void refresh();
+
+    /// \return number of receivers in the map
+    inline int numReceivers() const { return numActive; };
+
+    inline int getNX() const { return gridX.size(); };
+    inline int getNY() const { return gridY.size(); };
+    inline const std::vector<double> &getGridX() const { return gridX; };
+    inline const std::vector<double> &getGridY() const { return gridY; };
+
+    /// \brief Fisher information sums, one raster each
+    inline const std::vector<double> &getLambda() const { return lambda; };
+    inline const std::vector<double> &getMu() const { return mu; };
+    inline const std::vector<double> &getNu() const { return nu; };
+
+    /// \brief Area of the one standard deviation error ellipse,
+    /// \f$\pi/\sqrt{\lambda\mu-\nu^2}\f$, at each grid point
+    ///
+    /// Points the network cannot locate at all (fewer than two
+    /// receivers, or on the line through the only two) get infinity.
+    void computeEllipseAreas(std::vector<double> &areas) const;
+
+    /// \brief Semi-major and semi-minor axes of the one standard
+    /// deviation error ellipse at each grid point
+    ///
+    /// These are the inverse square roots of the eigenvalues of the
+    /// information matrix, so sqrt(1/am2) and sqrt(1/bm2) of
+    /// computeCramerRaoBounds in some order.  Infinite where the
+    /// network cannot locate the point.
+    void computeSemiAxes(std::vector<double> &major,
+                         std::vector<double> &minor) const;
+  };
+}
+#endif // DF_CRB_MAP_HPP
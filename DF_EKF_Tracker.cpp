@@ -0,0 +1,250 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Extended Kalman filter tracker for moving transmitters
+//
+// Special Notes  : Everything here is fixed-size 4x4 arithmetic, so an
+//                  update costs the same no matter how long the track.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include "DF_EKF_Tracker.hpp"
+#include "Util_Misc.hpp"
+#include "Util_Fast_Math.hpp"
+
+namespace DFLib
+{
+  EKFTracker::EKFTracker(double accelerationNoise)
+    : processNoise(accelerationNoise),
+      gate(0),
+      initialized(false),
+      stateTime(0)
+  {
+    for (int i=0; i<4; ++i)
+    {
+      state[i]=0;
+      for (int j=0; j<4; ++j)
+        covariance[i][j]=0;
+    }
+  }
+
+  void EKFTracker::initialize(const std::vector<double> &position,
+                              double positionSigma, double velocitySigma,
+                              double t)
+  {
+    double am2=1/(positionSigma*positionSigma);
+    initialize(position,am2,am2,0.0,velocitySigma,t);
+  }
+
+  void EKFTracker::initialize(const std::vector<double> &position,
+                              double am2, double bm2, double phi,
+                              double velocitySigma, double t)
+  {
+    if (!(am2>0 && bm2>0 && velocitySigma>0))
+      throw(Util::Exception("Bad initial uncertainty in EKFTracker::initialize"));
+
+    state[0]=position[0];
+    state[1]=position[1];
+    state[2]=0;
+    state[3]=0;
+    for (int i=0; i<4; ++i)
+      for (int j=0; j<4; ++j)
+        covariance[i][j]=0;
+
+    // Rotate the ellipse's axes back into XY
+    double c=cos(phi);
+    double s=sin(phi);
+    double a2=1/am2;
+    double b2=1/bm2;
+    covariance[0][0]=a2*c*c+b2*s*s;
+    covariance[1][1]=a2*s*s+b2*c*c;
+    covariance[0][1]=covariance[1][0]=(a2-b2)*c*s;
+    covariance[2][2]=covariance[3][3]=velocitySigma*velocitySigma;
+
+    stateTime=t;
+    initialized=true;
+  }
+
+  /// \brief constant velocity prediction of state and covariance to time t
+  ///
+  /// For white noise acceleration of spectral density q, each axis
+  /// picks up process noise q*[dt^3/3 dt^2/2; dt^2/2 dt] over dt.
+  void EKFTracker::predictTo(double t, double predictedState[4],
+                             double predictedCovariance[4][4]) const
+  {
+    double dt=t-stateTime;
+    double adt=fabs(dt);
+
+    predictedState[0]=state[0]+dt*state[2];
+    predictedState[1]=state[1]+dt*state[3];
+    predictedState[2]=state[2];
+    predictedState[3]=state[3];
+
+    // F P F^T, where F is the identity plus dt in the position/velocity
+    // blocks.
+    double FP[4][4];
+    for (int j=0; j<4; ++j)
+    {
+      FP[0][j]=covariance[0][j]+dt*covariance[2][j];
+      FP[1][j]=covariance[1][j]+dt*covariance[3][j];
+      FP[2][j]=covariance[2][j];
+      FP[3][j]=covariance[3][j];
+    }
+    for (int i=0; i<4; ++i)
+    {
+      predictedCovariance[i][0]=FP[i][0]+dt*FP[i][2];
+      predictedCovariance[i][1]=FP[i][1]+dt*FP[i][3];
+      predictedCovariance[i][2]=FP[i][2];
+      predictedCovariance[i][3]=FP[i][3];
+    }
+
+    double q=processNoise;
+    predictedCovariance[0][0] += q*adt*adt*adt/3;
+    predictedCovariance[1][1] += q*adt*adt*adt/3;
+    predictedCovariance[0][2] += q*adt*adt/2;
+    predictedCovariance[2][0] += q*adt*adt/2;
+    predictedCovariance[1][3] += q*adt*adt/2;
+    predictedCovariance[3][1] += q*adt*adt/2;
+    predictedCovariance[2][2] += q*adt;
+    predictedCovariance[3][3] += q*adt;
+  }
+
+  bool EKFTracker::update(DFLib::Abstract::Report *report)
+  {
+    if (!report->isValid())
+      return false;
+    const std::vector<double> &receiver=report->getReceiverLocation();
+    return update(report->getReportTime(),receiver[0],receiver[1],
+                  report->getReportBearingRadians(),
+                  report->getBearingStandardDeviationRadians());
+  }
+
+  bool EKFTracker::update(double t, double rx, double ry, double bearing,
+                          double sigma)
+  {
+    if (!initialized)
+      throw(Util::Exception("EKFTracker::update called before initialize"));
+    if (t<stateTime)
+      return false;
+
+    double x[4];
+    double P[4][4];
+    predictTo(t,x,P);
+
+    // Predicted bearing and its gradient with respect to the transmitter
+    // position, exactly as in the ML cost function and its gradient.
+    double dx=x[0]-rx;
+    double dy=x[1]-ry;
+    double d2=dx*dx+dy*dy;
+    if (d2==0)
+      return false;
+    double H0=dy/d2;     // d(bearing)/dx = cos(bearing)/d
+    double H1=-dx/d2;    // d(bearing)/dy = -sin(bearing)/d
+
+    // Innovation, measured bearing minus bearing to the predicted
+    // position, as the angle between their unit vectors, so already in
+    // -pi<deltatheta<=pi
+    double d=sqrt(d2);
+    double c=dy/d;
+    double s=dx/d;
+    double sm=sin(bearing);
+    double cm=cos(bearing);
+    double deltatheta=Util::angleAtan2(sm*c-cm*s,cm*c+sm*s);
+
+    double PHt[4];
+    for (int i=0; i<4; ++i)
+      PHt[i]=P[i][0]*H0+P[i][1]*H1;
+    double S=H0*PHt[0]+H1*PHt[1]+sigma*sigma;
+
+    if (gate>0 && deltatheta*deltatheta > gate*gate*S)
+      return false;
+
+    for (int i=0; i<4; ++i)
+    {
+      state[i]=x[i]+PHt[i]/S*deltatheta;
+      for (int j=0; j<4; ++j)
+        covariance[i][j]=P[i][j]-PHt[i]*PHt[j]/S;
+    }
+    stateTime=t;
+    return true;
+  }
+
+  void EKFTracker::getState(double t, std::vector<double> &position,
+                            std::vector<double> &velocity) const
+  {
+    double x[4];
+    double P[4][4];
+    predictTo(t,x,P);
+    position.resize(2);
+    velocity.resize(2);
+    position[0]=x[0];
+    position[1]=x[1];
+    velocity[0]=x[2];
+    velocity[1]=x[3];
+  }
+
+  void EKFTracker::getState(double t, std::vector<double> &theState,
+                            std::vector<std::vector<double> > &theCovariance)
+    const
+  {
+    double x[4];
+    double P[4][4];
+    predictTo(t,x,P);
+    theState.assign(x,x+4);
+    theCovariance.resize(4);
+    for (int i=0; i<4; ++i)
+      theCovariance[i].assign(P[i],P[i]+4);
+  }
+
+  void EKFTracker::getPositionEllipse(double t, double &am2, double &bm2,
+                                      double &phi) const
+  {
+    double x[4];
+    double P[4][4];
+    predictTo(t,x,P);
+
+    // Invert the position covariance to get the information matrix,
+    // then proceed as ReportCollection::computeCramerRaoBounds does.
+    double det=P[0][0]*P[1][1]-P[0][1]*P[1][0];
+    double lambda=P[1][1]/det;
+    double mu=P[0][0]/det;
+    double nu=P[0][1]/det;
+
+    phi=.5*atan2(-2*nu,lambda-mu);
+    am2=(lambda-nu*tan(phi));
+    bm2=(mu+nu*tan(phi));
+  }
+}
@@ -0,0 +1,178 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Track a moving transmitter from time-stamped bearing
+//                  reports with an extended Kalman filter.
+//
+// Special Notes  : The state is position and velocity in XY coordinates
+//                  (x, y, vx, vy), with a constant velocity motion model
+//                  driven by white noise acceleration.  Each report is
+//                  folded in as it arrives, at a fixed cost that does not
+//                  depend on how many reports came before.
+//
+//                  The measurement model is the same one the ML cost
+//                  function uses: the report's bearing is the bearing
+//                  from the receiver to the transmitter plus Gaussian
+//                  noise with the report's standard deviation.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_EKF_TRACKER_HPP
+#define DF_EKF_TRACKER_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include "DF_Abstract_Report.hpp"
+
+namespace DFLib
+{
+  /// \brief Extended Kalman filter tracker for a moving transmitter
+  ///
+  /// Where ReportCollection assumes the transmitter is stationary and
+  /// must be re-solved from scratch as reports come and go, the tracker
+  /// carries an estimate of position and velocity forward in time and
+  /// corrects it with each report in turn.  Reports must be time-stamped
+  /// (see Abstract::Report::setReportTime) and presented in time order.
+  ///
+  /// A bearing cannot tell range, so the tracker must be started from a
+  /// position estimate, typically an ML fix of the first few reports and
+  /// its Cramer-Rao ellipse.
+  class CPL_DLL EKFTracker
+  {
+  private:
+    double processNoise;
+    double gate;
+    bool initialized;
+    double stateTime;
+    double state[4];
+    double covariance[4][4];
+
+    void predictTo(double t, double predictedState[4],
+                   double predictedCovariance[4][4]) const;
+
+  public:
+    /// \brief Make a tracker
+    ///
+    /// \param accelerationNoise spectral density of the white noise
+    ///        acceleration that drives the motion model, in XY units
+    ///        squared per second cubed.  Roughly, the square of the
+    ///        speed change expected over one second, per second.
+    EKFTracker(double accelerationNoise);
+
+    /// \brief Start tracking from a position estimate
+    ///
+    /// \param position starting XY position
+    /// \param positionSigma standard deviation of the position, in XY
+    ///        units, in each coordinate
+    /// \param velocitySigma standard deviation of each velocity
+    ///        component, in XY units per second.  The velocity itself
+    ///        starts at zero.
+    /// \param t time of the estimate
+    void initialize(const std::vector<double> &position,
+                    double positionSigma, double velocitySigma, double t);
+
+    /// \brief Start tracking from a fix and its error ellipse
+    ///
+    /// \param position starting XY position, e.g. an ML fix
+    /// \param am2 inverse square of the ellipse's a semi-axis
+    /// \param bm2 inverse square of the ellipse's b semi-axis
+    /// \param phi rotation of the a axis, counterclockwise from the x axis
+    /// \param velocitySigma standard deviation of each velocity component
+    /// \param t time of the estimate
+    ///
+    /// The ellipse parameters are exactly those returned by
+    /// ReportCollection::computeCramerRaoBounds.
+    void initialize(const std::vector<double> &position,
+                    double am2, double bm2, double phi,
+                    double velocitySigma, double t);
+
+    inline bool isInitialized() const { return initialized; };
+
+    /// \brief Reject reports whose bearings are too far off
+    ///
+    /// A report is rejected if its bearing differs from the predicted
+    /// bearing by more than nSigma standard deviations of the predicted
+    /// bearing error (which includes the report's own standard
+    /// deviation).  Zero, the default, accepts everything.
+    inline void setGate(double nSigma) { gate=nSigma; };
+
+    /// \brief Correct the track with one report
+    ///
+    /// \return true if the report was used.  Invalid reports, reports
+    /// older than the latest one used, reports from a receiver at the
+    /// predicted transmitter position, and gated reports are ignored.
+    bool update(DFLib::Abstract::Report *report);
+
+    /// \brief Correct the track with one bearing
+    ///
+    /// Same as update(Report *), for callers that have no report
+    /// objects.
+    ///
+    /// \param t time of the bearing
+    /// \param rx receiver x coordinate
+    /// \param ry receiver y coordinate
+    /// \param bearing bearing in radians clockwise from north
+    /// \param sigma bearing standard deviation in radians
+    bool update(double t, double rx, double ry, double bearing,
+                double sigma);
+
+    /// \return time of the latest report used
+    inline double getStateTime() const { return stateTime; };
+
+    /// \brief State predicted to any time
+    ///
+    /// This does not change the tracker.  Asking for a time before the
+    /// latest report extrapolates backward along the current velocity.
+    ///
+    /// \param t time wanted
+    /// \param position returned XY position
+    /// \param velocity returned XY velocity
+    void getState(double t, std::vector<double> &position,
+                  std::vector<double> &velocity) const;
+
+    /// \brief Full state and covariance predicted to any time
+    ///
+    /// \param t time wanted
+    /// \param theState returned x, y, vx, vy
+    /// \param theCovariance returned 4x4 covariance of theState
+    void getState(double t, std::vector<double> &theState,
+                  std::vector<std::vector<double> > &theCovariance) const;
+
+    /// \brief 1-sigma position error ellipse predicted to any time
+    ///
+    /// Returned in the same form as
+    /// ReportCollection::computeCramerRaoBounds, so it can be drawn the
+    /// same way.
+    void getPositionEllipse(double t, double &am2, double &bm2,
+                            double &phi) const;
+  };
+}
+#endif // DF_EKF_TRACKER_HPP
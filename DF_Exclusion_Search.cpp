@@ -0,0 +1,466 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Search for reports to exclude from a fix
+//
+// Special Notes  : The frozen-weight chi-square of a subset is the
+//                  weighted sum of squares less q.x at the solution of
+//                  M x = q.  The normal equations are taken relative to
+//                  the reference point, so that the two are of the size
+//                  of the chi-square itself and nothing much cancels.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "DF_Exclusion_Search.hpp"
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+
+namespace DFLib
+{
+  /// \brief log of Gamma(dof/2), from Gamma(1/2)=sqrt(pi), Gamma(1)=1
+  /// and Gamma(a+1)=a Gamma(a)
+  static double logGammaHalf(int dof)
+  {
+    double a=(dof%2)?0.5:1.0;
+    double result=(dof%2)?0.5*log(M_PI):0.0;
+    for (; a<0.5*dof; a+=1)
+      result += log(a);
+    return result;
+  }
+
+  /// The regularized upper incomplete gamma function Q(dof/2,chi2/2), by
+  /// its series below the peak of the integrand and its continued
+  /// fraction above.
+  double chiSquareUpperTail(double chi2, int dof)
+  {
+    if (!(chi2>0))
+      return 1;
+    if (dof<=0 || chi2==std::numeric_limits<double>::infinity())
+      return 0;
+    double a=0.5*dof;
+    double x=0.5*chi2;
+    double prefix=exp(a*log(x)-x-logGammaHalf(dof));
+
+    if (x<a+1)
+    {
+      double term=1/a;
+      double sum=term;
+      for (int n=1; n<1000; ++n)
+      {
+        term *= x/(a+n);
+        sum += term;
+        if (term<sum*1e-15)
+          break;
+      }
+      return std::max(0.0,1-sum*prefix);
+    }
+
+    // modified Lentz's method
+    double tiny=1e-300;
+    double b=x+1-a;
+    double c=1/tiny;
+    double d=1/b;
+    double h=d;
+    for (int n=1; n<1000; ++n)
+    {
+      double an=-n*(n-a);
+      b += 2;
+      d=an*d+b;
+      if (fabs(d)<tiny)
+        d=tiny;
+      c=b+an/c;
+      if (fabs(c)<tiny)
+        c=tiny;
+      d=1/d;
+      double delta=d*c;
+      h *= delta;
+      if (fabs(delta-1)<1e-15)
+        break;
+    }
+    return prefix*h;
+  }
+
+  /// \brief chi-square of the weighted normal equations in sums
+  ///
+  /// \return false if the matrix is singular, in which case chi2 is 0,
+  /// still a lower bound on the chi-square of any superset
+  static inline bool normalChiSquare(const double sums[6], double &chi2)
+  {
+    double det=sums[0]*sums[2]-sums[1]*sums[1];
+    if (!(sums[0]>0 && det>1e-12*sums[0]*sums[2]))
+    {
+      chi2=0;
+      return false;
+    }
+    double x0=(sums[2]*sums[3]-sums[1]*sums[4])/det;
+    double x1=(sums[0]*sums[4]-sums[1]*sums[3])/det;
+    chi2=std::max(0.0,sums[5]-sums[3]*x0-sums[4]*x1);
+    return true;
+  }
+
+  /// \brief ranking of search results: consistent first, then fewer
+  /// excluded if consistent, then more probable, then smaller
+  /// chi-square per degree of freedom, then by the excluded indices
+  static bool betterResult(const ExclusionResult &a, const ExclusionResult &b)
+  {
+    if (a.consistent!=b.consistent)
+      return a.consistent;
+    if (a.consistent && a.excluded.size()!=b.excluded.size())
+      return a.excluded.size()<b.excluded.size();
+    if (a.probability!=b.probability)
+      return a.probability>b.probability;
+    double za=(a.chiSquare-a.degreesOfFreedom)/sqrt(2.0*a.degreesOfFreedom);
+    double zb=(b.chiSquare-b.degreesOfFreedom)/sqrt(2.0*b.degreesOfFreedom);
+    if (za!=zb)
+      return za<zb;
+    return a.excluded<b.excluded;
+  }
+
+  /// \brief add a result to a list kept sorted and no longer than numBest
+  static void offerResult(std::vector<ExclusionResult> &best,
+                          const ExclusionResult &result, int numBest)
+  {
+    if ((int)best.size()==numBest && !betterResult(result,best.back()))
+      return;
+    best.insert(std::upper_bound(best.begin(),best.end(),result,
+                                 betterResult),
+                result);
+    if ((int)best.size()>numBest)
+      best.pop_back();
+  }
+
+  ExclusionSearch::ExclusionSearch(int n, const double *x, const double *y,
+                                   const double *bearing, const double *sigma,
+                                   const unsigned char *valid)
+    : numReports(n),
+      xs(x),
+      ys(y),
+      bearings(bearing),
+      sigmas(sigma),
+      valids(valid),
+      significance(0.05),
+      numEvaluated(0),
+      numValid(0)
+  {
+  }
+
+  void ExclusionSearch::setSignificance(double alpha)
+  {
+    if (!(alpha>0 && alpha<1))
+      throw(Util::Exception("ExclusionSearch significance must be between 0 and 1"));
+    significance=alpha;
+  }
+
+  /// \brief weights, terms and exclusion order for a reference point
+  ///
+  /// Reports are ordered by how much leaving each one alone out would
+  /// lower the chi-square of all of them, largest first, so that the
+  /// likely culprits are tried first and passing over one of them kills
+  /// a branch quickly.
+  void ExclusionSearch::setReference(const std::vector<double> &point)
+  {
+    std::vector<int> index;
+    std::vector<double> cs,ss,ws,bs;
+    std::vector<double> unordered;
+    double total[6]={0,0,0,0,0,0};
+    for (int i=0; i<numReports; ++i)
+    {
+      if (valids && !valids[i])
+        continue;
+      double c=cos(bearings[i]);
+      double s=sin(bearings[i]);
+      double dx=xs[i]-point[0];
+      double dy=ys[i]-point[1];
+      double d2=dx*dx+dy*dy;
+      double w=(d2>0)?1/(sigmas[i]*sigmas[i]*d2):0;
+      // the bearing line is a.x=b, with a=(c,-s), relative to point
+      double b=c*dx-s*dy;
+      double t[6]={w*c*c,-w*s*c,w*s*s,w*c*b,-w*s*b,w*b*b};
+      index.push_back(i);
+      cs.push_back(c);
+      ss.push_back(s);
+      ws.push_back(w);
+      bs.push_back(b);
+      for (int k=0; k<6; ++k)
+      {
+        unordered.push_back(t[k]);
+        total[k] += t[k];
+      }
+    }
+    numValid=index.size();
+
+    // Drop in chi-square from leaving each report out alone, w e^2/(1-h),
+    // from its residual e and leverage h.  A report the rest cannot do
+    // without goes last.
+    double det=total[0]*total[2]-total[1]*total[1];
+    double x0=(total[2]*total[3]-total[1]*total[4])/det;
+    double x1=(total[0]*total[4]-total[1]*total[3])/det;
+    std::vector<std::pair<double,int> > suspicion(numValid);
+    for (int k=0; k<numValid; ++k)
+    {
+      double c=cs[k];
+      double s=ss[k];
+      double e=c*x0-s*x1-bs[k];
+      double h=ws[k]*(total[2]*c*c+2*total[1]*c*s+total[0]*s*s)/det;
+      double drop=(1-h>1e-10)?ws[k]*e*e/(1-h):-1;
+      // negated so that sorting puts the largest drop first, ties by
+      // report index
+      suspicion[k]=std::make_pair(-drop,k);
+    }
+    std::sort(suspicion.begin(),suspicion.end());
+
+    order.resize(numValid);
+    terms.resize(6*numValid);
+    prefix.assign(6*(numValid+1),0.0);
+    for (int p=0; p<numValid; ++p)
+    {
+      int k=suspicion[p].second;
+      order[p]=index[k];
+      for (int j=0; j<6; ++j)
+      {
+        terms[6*p+j]=unordered[6*k+j];
+        prefix[6*(p+1)+j]=prefix[6*p+j]+terms[6*p+j];
+      }
+    }
+  }
+
+  /// \brief score the subset that leaves out the reports at positions
+  /// \return true if it is consistent
+  bool ExclusionSearch::evaluate(const std::vector<int> &positions,
+                                 const double sums[6], int numBest,
+                                 std::vector<ExclusionResult> &best) const
+  {
+    ExclusionResult result;
+    result.degreesOfFreedom=numValid-positions.size()-2;
+    if (!normalChiSquare(sums,result.chiSquare))
+      result.chiSquare=std::numeric_limits<double>::infinity();
+    result.probability=chiSquareUpperTail(result.chiSquare,
+                                          result.degreesOfFreedom);
+    result.consistent=(result.chiSquare<=critical[result.degreesOfFreedom]);
+    result.am2=result.bm2=result.phi=0;
+    result.excluded.resize(positions.size());
+    for (int k=0; k<positions.size(); ++k)
+      result.excluded[k]=order[positions[k]];
+    std::sort(result.excluded.begin(),result.excluded.end());
+    offerResult(best,result,numBest);
+    return result.consistent;
+  }
+
+  /// \brief search every subset that excludes the reports at positions
+  /// and possibly some at later positions
+  ///
+  /// sums are the normal equation terms of the reports not excluded.
+  void ExclusionSearch::descend(std::vector<int> &positions,
+                                const double sums[6], int maxExcluded,
+                                int numBest,
+                                std::vector<ExclusionResult> &best,
+                                int &evaluated) const
+  {
+    int numExcluded=positions.size();
+    ++evaluated;
+    // Supersets of a consistent subset are not wanted
+    if (evaluate(positions,sums,numBest,best) || numExcluded==maxExcluded)
+      return;
+
+    // Terms of the excluded reports, which all come before any position
+    // tried next
+    double excludedSums[6];
+    double child[6];
+    const double *total=&prefix[6*numValid];
+    for (int j=0; j<6; ++j)
+      excludedSums[j]=total[j]-sums[j];
+
+    int start=(numExcluded>0)?positions.back()+1:0;
+    double bound=critical[numValid-numExcluded-3];
+    for (int p=start; numValid-numExcluded-1>=3 && p<numValid; ++p)
+    {
+      // Everything before p that is not excluded stays in every subset
+      // from here on, and that only gets worse as p grows
+      double kept[6];
+      for (int j=0; j<6; ++j)
+        kept[j]=prefix[6*p+j]-excludedSums[j];
+      double lower;
+      normalChiSquare(kept,lower);
+      if (lower>bound)
+        break;
+
+      for (int j=0; j<6; ++j)
+        child[j]=sums[j]-terms[6*p+j];
+      positions.push_back(p);
+      descend(positions,child,maxExcluded,numBest,best,evaluated);
+      positions.pop_back();
+    }
+  }
+
+  /// \brief search from one reference point, keeping the numBest best
+  /// subsets
+  void ExclusionSearch::searchFrom(const std::vector<double> &reference,
+                                   int maxExcluded, int numBest,
+                                   std::vector<ExclusionResult> &best)
+  {
+    setReference(reference);
+    best.clear();
+    std::vector<int> positions;
+    const double *total=&prefix[6*numValid];
+    int evaluated=1;
+    if (evaluate(positions,total,numBest,best) || maxExcluded==0)
+    {
+      numEvaluated += evaluated;
+      return;
+    }
+
+    // The first exclusions that can lead anywhere, as in descend
+    std::vector<int> firsts;
+    for (int p=0; numValid-1>=3 && p<numValid; ++p)
+    {
+      double lower;
+      normalChiSquare(&prefix[6*p],lower);
+      if (lower>critical[numValid-3])
+        break;
+      firsts.push_back(p);
+    }
+
+    int numFirsts=firsts.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<ExclusionResult> threadBest;
+      std::vector<int> threadPositions(1);
+      int threadEvaluated=0;
+      double child[6];
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic)
+#endif
+      for (int f=0; f<numFirsts; ++f)
+      {
+        int p=firsts[f];
+        for (int j=0; j<6; ++j)
+          child[j]=total[j]-terms[6*p+j];
+        threadPositions[0]=p;
+        descend(threadPositions,child,maxExcluded,numBest,threadBest,
+                threadEvaluated);
+      }
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      {
+        for (int k=0; k<threadBest.size(); ++k)
+          offerResult(best,threadBest[k],numBest);
+        evaluated += threadEvaluated;
+      }
+    }
+    numEvaluated += evaluated;
+  }
+
+  /// \brief full fixes and chi-square of a result
+  void ExclusionSearch::finish(ExclusionResult &result)
+  {
+    std::vector<unsigned char> mask(numReports,1);
+    for (int i=0; i<numReports; ++i)
+      if (valids && !valids[i])
+        mask[i]=0;
+    for (int k=0; k<result.excluded.size(); ++k)
+      mask[result.excluded[k]]=0;
+    ArrayCollection remaining(numReports,xs,ys,bearings,sigmas,&mask[0]);
+
+    remaining.computeLeastSquaresFix(result.leastSquaresFix);
+    result.fix=result.leastSquaresFix;
+    try
+    {
+      remaining.computeStansfieldFix(result.fix,result.am2,result.bm2,
+                                     result.phi);
+    }
+    catch (Util::Exception x)
+    {
+      result.fix=result.leastSquaresFix;
+      result.am2=result.bm2=result.phi=0;
+    }
+    result.chiSquare=2*remaining.computeCostFunction(result.fix);
+    result.probability=chiSquareUpperTail(result.chiSquare,
+                                          result.degreesOfFreedom);
+    result.consistent=(result.probability>=significance);
+  }
+
+  int ExclusionSearch::search(int maxExcluded, int numBest,
+                              std::vector<ExclusionResult> &results)
+  {
+    int m=0;
+    for (int i=0; i<numReports; ++i)
+      if (!valids || valids[i])
+        ++m;
+    if (m<3)
+      throw(Util::Exception("Exclusion search needs at least three valid reports"));
+    if (numBest<1)
+      throw(Util::Exception("Exclusion search must return at least one result"));
+
+    // Chi-square at the significance level for each number of degrees of
+    // freedom, by bisection
+    critical.assign(m-1,0.0);
+    for (int dof=1; dof<=m-2; ++dof)
+    {
+      double lo=0;
+      double hi=dof+20*sqrt(2.0*dof)+100;
+      for (int k=0; k<100; ++k)
+      {
+        double mid=.5*(lo+hi);
+        if (chiSquareUpperTail(mid,dof)>significance)
+          lo=mid;
+        else
+          hi=mid;
+      }
+      critical[dof]=.5*(lo+hi);
+    }
+
+    // First pass from the fix of all the reports
+    numEvaluated=0;
+    ExclusionResult all;
+    all.degreesOfFreedom=m-2;
+    finish(all);
+    searchFrom(all.fix,maxExcluded,numBest,results);
+
+    // Second pass from the fix of the best subset of the first
+    finish(results[0]);
+    searchFrom(results[0].fix,maxExcluded,numBest,results);
+
+    for (int k=0; k<results.size(); ++k)
+      finish(results[k]);
+    std::stable_sort(results.begin(),results.end(),betterResult);
+    return results.size();
+  }
+}
@@ -0,0 +1,168 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Find the fewest reports to leave out to make the rest
+//                  consistent with a single transmitter.
+//
+// Special Notes  : Subsets are searched depth first, excluding reports in
+//                  a fixed order, most suspicious first.  Every report
+//                  passed over on the way down stays in all the subsets
+//                  below, so the chi-square of those reports alone bounds
+//                  the chi-square of everything below from beneath, and
+//                  a branch is dropped as soon as that bound says none
+//                  of it can be consistent.  Top level branches are
+//                  searched in parallel when DFLib is built with OpenMP.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_EXCLUSION_SEARCH_HPP
+#define DF_EXCLUSION_SEARCH_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+
+namespace DFLib
+{
+  /// \brief A set of reports to leave out, and the fix of the rest
+  struct ExclusionResult
+  {
+    /// indices of the reports left out, ascending
+    std::vector<int> excluded;
+    /// Stansfield fix of the remaining reports
+    std::vector<double> fix;
+    /// Stansfield error ellipse of fix
+    double am2;
+    double bm2;
+    double phi;
+    /// least squares fix of the remaining reports
+    std::vector<double> leastSquaresFix;
+    /// sum of squared normalized bearing residuals of the remaining
+    /// reports at fix
+    double chiSquare;
+    /// number of remaining reports less 2
+    int degreesOfFreedom;
+    /// chance of a chi-square at least this large if every remaining
+    /// bearing is good
+    double probability;
+    /// true if probability is at least the search's significance level
+    bool consistent;
+  };
+
+  /// \brief Search for the best reports to leave out of a fix
+  ///
+  /// A set of reports is consistent if the chi-square of its fix is
+  /// not improbably large for its degrees of freedom, at a given
+  /// significance level.  The search looks for the smallest sets of
+  /// reports whose exclusion leaves the rest consistent, trying sets of
+  /// up to maxExcluded reports, and ranks them: consistent sets first,
+  /// fewest excluded first, then most probable.  Supersets of a
+  /// consistent set are never reported, since there is no call to throw
+  /// out more reports than that.
+  ///
+  /// The chi-square of each subset comes from Stansfield's weighted
+  /// least squares with the weights frozen at a reference point, which
+  /// takes a 2x2 solve per subset from running sums.  The reference is
+  /// first the fix of all the reports, then the fix of the best subset
+  /// found from it, and the search is run again from there.  The
+  /// results returned have their fixes and chi-squares recomputed in
+  /// full.
+  ///
+  /// If no subset of up to maxExcluded reports is consistent, the
+  /// results are the most nearly consistent subsets the search visited,
+  /// which, because of the pruning, need not be the most nearly
+  /// consistent of all.
+  ///
+  /// Like ArrayCollection, the search uses the report arrays in place.
+  class CPL_DLL ExclusionSearch
+  {
+  private:
+    int numReports;
+    const double *xs;
+    const double *ys;
+    const double *bearings;
+    const double *sigmas;
+    const unsigned char *valids;
+    double significance;
+    int numEvaluated;
+
+    // Valid reports in the order they are tried for exclusion, and
+    // each one's terms of the weighted normal equations, six per report:
+    // the matrix (3), the right hand side (2) and the sum of weighted
+    // squares.  prefix holds running sums of terms, starting from zero.
+    int numValid;
+    std::vector<int> order;
+    std::vector<double> terms;
+    std::vector<double> prefix;
+    // chi-square at the significance level, by degrees of freedom
+    std::vector<double> critical;
+
+    void setReference(const std::vector<double> &point);
+    bool evaluate(const std::vector<int> &positions, const double sums[6],
+                  int numBest, std::vector<ExclusionResult> &best) const;
+    void descend(std::vector<int> &positions, const double sums[6],
+                 int maxExcluded, int numBest,
+                 std::vector<ExclusionResult> &best, int &evaluated) const;
+    void searchFrom(const std::vector<double> &reference, int maxExcluded,
+                    int numBest, std::vector<ExclusionResult> &best);
+    void finish(ExclusionResult &result);
+
+  public:
+    /// \brief Search the given arrays, as for ArrayCollection
+    ExclusionSearch(int n, const double *x, const double *y,
+                    const double *bearing, const double *sigma,
+                    const unsigned char *valid=0);
+
+    /// \brief Probability below which a chi-square is inconsistent.
+    /// Default 0.05.
+    void setSignificance(double alpha);
+    inline double getSignificance() const { return significance; };
+
+    /// \brief Find the best sets of up to maxExcluded reports to leave
+    /// out
+    ///
+    /// \param maxExcluded most reports to leave out at once.  At least
+    ///        three reports are always kept.
+    /// \param numBest how many sets to return at most
+    /// \param results the sets, best first
+    /// \return number of results
+    int search(int maxExcluded, int numBest,
+               std::vector<ExclusionResult> &results);
+
+    /// \brief number of subsets whose chi-square the last search
+    /// evaluated, over both of its passes
+    inline int getNumEvaluated() const { return numEvaluated; };
+  };
+
+  /// \brief Probability of a chi-square at least chi2 with dof degrees of
+  /// freedom
+  CPL_DLL double chiSquareUpperTail(double chi2, int dof);
+}
+#endif // DF_EXCLUSION_SEARCH_HPP
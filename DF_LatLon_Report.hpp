@@ -61,6 +61,8 @@ namespace DFLib
     private:
       Point receiverLocation;            
       double bearing,sigma;
+      // unit bearing vector and 1/sigma^2, kept up to date by the setters
+      double cosBearing,sinBearing,inverseVariance;
     public:
       Report(const std::vector<double> &theLocationLL, 
                      const double &bearing,const double &std_dev,
@@ -71,6 +73,9 @@ namespace DFLib
       virtual  double getBearing() const;
       virtual  double getBearingStandardDeviationRadians() const;
       virtual  double getSigma() const;
+      virtual  double getBearingCosine() const;
+      virtual  double getBearingSine() const;
+      virtual  double getBearingInverseVariance() const;
       virtual  void  setReceiverLocationLL(std::vector<double> &theLocation);
       virtual  void  setReceiverLocationMercator(std::vector<double> &theLocation);
       //! set bearing in degrees
@@ -100,6 +105,9 @@ namespace DFLib
     while (bearing >= 2*M_PI)
       bearing -= 2*M_PI;
 
+    cosBearing=cos(bearing);
+    sinBearing=sin(bearing);
+    inverseVariance=1/(sigma*sigma);
   }        
 
   inline DFLib::LatLon::Report::~Report()
@@ -126,6 +134,19 @@ namespace DFLib
     return sigma*180/M_PI;
   }
 
+  inline double DFLib::LatLon::Report::getBearingCosine() const
+  {
+    return cosBearing;
+  }
+  inline double DFLib::LatLon::Report::getBearingSine() const
+  {
+    return sinBearing;
+  }
+  inline double DFLib::LatLon::Report::getBearingInverseVariance() const
+  {
+    return inverseVariance;
+  }
+
   inline void DFLib::LatLon::Report::setReceiverLocationLL(std::vector<double> &theLocation)
   {
     receiverLocation.setLL(theLocation);
@@ -149,10 +170,13 @@ namespace DFLib
       bearing += 2*M_PI;
     while (bearing >= 2*M_PI)
       bearing -= 2*M_PI;
+    cosBearing=cos(bearing);
+    sinBearing=sin(bearing);
   }
   inline void DFLib::LatLon::Report::setSigma(double Sigma)
   {
     sigma=Sigma*M_PI/180;
+    inverseVariance=1/(sigma*sigma);
   }
 }
 #endif // DF_LATLON_REPORT_HPP
@@ -0,0 +1,424 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Particle filter localizer
+//
+// Special Notes  : All loops over particles run over fixed blocks of
+//                  particles.  Blocks are spread over threads, but what
+//                  happens in a block, including which random number
+//                  stream it draws from, depends only on the block.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include "DF_Particle_Filter.hpp"
+#include "gaussian_random.hpp"
+#include "Util_Misc.hpp"
+#include "Util_Fast_Math.hpp"
+#include "Util_Reduction.hpp"
+
+namespace DFLib
+{
+  /// particles per block
+  static const int blockSize=4096;
+
+  // Terms of the sums over particles, for Util::deterministicSum, so
+  // that the effective sample size, mean and covariance do not depend
+  // on the number of threads.
+
+  /// \brief weight and squared weight of each particle
+  class ParticleFilter::WeightTerms
+  {
+  private:
+    const std::vector<double> &logWeights;
+  public:
+    WeightTerms(const std::vector<double> &theLogWeights)
+      : logWeights(theLogWeights)
+    {
+    }
+    inline bool operator()(int i, double *t) const
+    {
+      double w=exp(logWeights[i]);
+      t[0]=w;
+      t[1]=w*w;
+      return true;
+    }
+  };
+
+  /// \brief weighted position of each particle
+  class ParticleFilter::MeanTerms
+  {
+  private:
+    const ParticleFilter &filter;
+  public:
+    MeanTerms(const ParticleFilter &theFilter)
+      : filter(theFilter)
+    {
+    }
+    inline bool operator()(int i, double *t) const
+    {
+      double w=exp(filter.logWeights[i]);
+      t[0]=w*filter.xs[i];
+      t[1]=w*filter.ys[i];
+      return true;
+    }
+  };
+
+  /// \brief weighted second moments of each particle about a point
+  class ParticleFilter::CovarianceTerms
+  {
+  private:
+    const ParticleFilter &filter;
+    double mx,my;
+  public:
+    CovarianceTerms(const ParticleFilter &theFilter,
+                    const std::vector<double> &mean)
+      : filter(theFilter),
+        mx(mean[0]),
+        my(mean[1])
+    {
+    }
+    inline bool operator()(int i, double *t) const
+    {
+      double w=exp(filter.logWeights[i]);
+      double dx=filter.xs[i]-mx;
+      double dy=filter.ys[i]-my;
+      t[0]=w*dx*dx;
+      t[1]=w*dy*dy;
+      t[2]=w*dx*dy;
+      return true;
+    }
+  };
+
+  ParticleFilter::ParticleFilter(int n, uint64_t theSeed)
+    : numParticles(n),
+      xs(n,0.0),
+      ys(n,0.0),
+      logWeights(n,0.0),
+      costs(n,0.0),
+      scratchX(n),
+      scratchY(n),
+      scratchCosts(n),
+      cumulative(n),
+      seed(theSeed),
+      nextStream(0),
+      resampleThreshold(0.5),
+      roughening(0.2),
+      numResamples(0)
+  {
+    if (n<1)
+      throw(Util::Exception("ParticleFilter needs at least one particle"));
+  }
+
+  void ParticleFilter::initializeUniform(double xmin, double xmax,
+                                         double ymin, double ymax)
+  {
+    int numBlocks=(numParticles+blockSize-1)/blockSize;
+    uint64_t firstStream=nextStream;
+    nextStream += numBlocks;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<double> u(2*blockSize);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int b=0; b<numBlocks; ++b)
+      {
+        int first=b*blockSize;
+        int n=std::min(blockSize,numParticles-first);
+        DFLib::Util::gaussian_random_generator gen(0,1,seed,firstStream+b);
+        gen.fillUniform(&u[0],2*n);
+        for (int i=0; i<n; ++i)
+        {
+          xs[first+i]=xmin+(xmax-xmin)*u[2*i];
+          ys[first+i]=ymin+(ymax-ymin)*u[2*i+1];
+          logWeights[first+i]=0;
+          costs[first+i]=0;
+        }
+      }
+    }
+    numResamples=0;
+  }
+
+  void ParticleFilter::initializeAroundReceivers(int n, const double *rx,
+                                                 const double *ry,
+                                                 double margin)
+  {
+    if (n<1)
+      throw(Util::Exception("Need at least one receiver in ParticleFilter::initializeAroundReceivers"));
+    double xmin=*std::min_element(rx,rx+n);
+    double xmax=*std::max_element(rx,rx+n);
+    double ymin=*std::min_element(ry,ry+n);
+    double ymax=*std::max_element(ry,ry+n);
+    double extent=std::max(xmax-xmin,ymax-ymin);
+    if (extent<=0)
+      extent=1;
+    double halfWidth=(0.5+margin)*extent;
+    double centerX=0.5*(xmin+xmax);
+    double centerY=0.5*(ymin+ymax);
+    initializeUniform(centerX-halfWidth,centerX+halfWidth,
+                      centerY-halfWidth,centerY+halfWidth);
+  }
+
+  bool ParticleFilter::update(DFLib::Abstract::Report *report)
+  {
+    if (!report->isValid())
+      return false;
+    const std::vector<double> &receiver=report->getReceiverLocation();
+    double bearing=report->getReportBearingRadians();
+    double sigma=report->getBearingStandardDeviationRadians();
+    update(1,&receiver[0],&receiver[1],&bearing,&sigma);
+    return true;
+  }
+
+  void ParticleFilter::update(double rx, double ry, double bearing,
+                              double sigma)
+  {
+    update(1,&rx,&ry,&bearing,&sigma);
+  }
+
+  void ParticleFilter::update(int n, const double *rx, const double *ry,
+                              const double *bearing, const double *sigma)
+  {
+    int numBlocks=(numParticles+blockSize-1)/blockSize;
+
+    // Reports outside, particles inside.  Rotating each particle's
+    // offset from the receiver by the reported bearing gives the bearing
+    // error directly in (-pi,pi], with one atan2 and no wrapping.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int b=0; b<numBlocks; ++b)
+    {
+      int first=b*blockSize;
+      int last=std::min(first+blockSize,numParticles);
+      for (int k=0; k<n; ++k)
+      {
+        double w=1/(2*sigma[k]*sigma[k]);
+        double c=cos(bearing[k]);
+        double s=sin(bearing[k]);
+        double x0=rx[k];
+        double y0=ry[k];
+        for (int i=first; i<last; ++i)
+        {
+          double dx=xs[i]-x0;
+          double dy=ys[i]-y0;
+          double deltatheta=Util::angleAtan2(dx*c-dy*s,dy*c+dx*s);
+          double cost=w*deltatheta*deltatheta;
+          logWeights[i] -= cost;
+          costs[i] += cost;
+        }
+      }
+    }
+
+    double sumWeights,sumSquares;
+    normalizeLogWeights(sumWeights,sumSquares);
+    if (sumWeights*sumWeights/sumSquares < resampleThreshold*numParticles)
+      resample();
+  }
+
+  /// \brief shift log weights so the largest is 0, and sum the weights
+  /// and their squares
+  void ParticleFilter::normalizeLogWeights(double &sumWeights,
+                                           double &sumSquares)
+  {
+    double maxLogWeight=-std::numeric_limits<double>::max();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      double localMax=-std::numeric_limits<double>::max();
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int i=0; i<numParticles; ++i)
+        localMax=std::max(localMax,logWeights[i]);
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+      maxLogWeight=std::max(maxLogWeight,localMax);
+    }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i=0; i<numParticles; ++i)
+      logWeights[i] -= maxLogWeight;
+
+    double sums[2];
+    Util::deterministicSum<2>(numParticles,WeightTerms(logWeights),sums);
+    sumWeights=sums[0];
+    sumSquares=sums[1];
+  }
+
+  /// \brief systematic resampling, then roughening
+  void ParticleFilter::resample()
+  {
+    // The running sum is inherently serial, but it is one add per
+    // particle.
+    double total=0;
+    for (int i=0; i<numParticles; ++i)
+    {
+      total += exp(logWeights[i]);
+      cumulative[i]=total;
+    }
+
+    int numBlocks=(numParticles+blockSize-1)/blockSize;
+    double u0;
+    {
+      DFLib::Util::gaussian_random_generator gen(0,1,seed,nextStream++);
+      u0=gen.getUniform();
+    }
+    double spacing=total/numParticles;
+
+    // Output particle k is the first particle whose cumulative weight
+    // reaches (u0+k)*spacing.  Each block finds its first one by binary
+    // search and walks from there.
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int b=0; b<numBlocks; ++b)
+    {
+      int first=b*blockSize;
+      int last=std::min(first+blockSize,numParticles);
+      int j=std::lower_bound(cumulative.begin(),cumulative.end(),
+                             (u0+first)*spacing)-cumulative.begin();
+      for (int k=first; k<last; ++k)
+      {
+        double target=(u0+k)*spacing;
+        while (j<numParticles-1 && cumulative[j]<target)
+          ++j;
+        scratchX[k]=xs[j];
+        scratchY[k]=ys[j];
+        scratchCosts[k]=costs[j];
+      }
+    }
+    xs.swap(scratchX);
+    ys.swap(scratchY);
+    costs.swap(scratchCosts);
+    std::fill(logWeights.begin(),logWeights.end(),0.0);
+    ++numResamples;
+
+    if (roughening<=0)
+      return;
+
+    // Jitter each coordinate by a Gaussian whose width is a fraction of
+    // the cloud's extent.
+    double xmin=*std::min_element(xs.begin(),xs.end());
+    double xmax=*std::max_element(xs.begin(),xs.end());
+    double ymin=*std::min_element(ys.begin(),ys.end());
+    double ymax=*std::max_element(ys.begin(),ys.end());
+    double scale=roughening/sqrt(static_cast<double>(numParticles));
+    double sigmaX=scale*(xmax-xmin);
+    double sigmaY=scale*(ymax-ymin);
+    uint64_t firstStream=nextStream;
+    nextStream += numBlocks;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+    {
+      std::vector<double> noise(2*blockSize);
+#ifdef _OPENMP
+#pragma omp for schedule(static)
+#endif
+      for (int b=0; b<numBlocks; ++b)
+      {
+        int first=b*blockSize;
+        int n=std::min(blockSize,numParticles-first);
+        DFLib::Util::gaussian_random_generator gen(0,1,seed,firstStream+b);
+        gen.fill(&noise[0],2*n);
+        for (int i=0; i<n; ++i)
+        {
+          xs[first+i] += sigmaX*noise[2*i];
+          ys[first+i] += sigmaY*noise[2*i+1];
+        }
+      }
+    }
+  }
+
+  double ParticleFilter::effectiveSampleSize()
+  {
+    double sumWeights,sumSquares;
+    normalizeLogWeights(sumWeights,sumSquares);
+    return (sumWeights*sumWeights/sumSquares);
+  }
+
+  void ParticleFilter::getWeights(std::vector<double> &weights)
+  {
+    double sumWeights,sumSquares;
+    normalizeLogWeights(sumWeights,sumSquares);
+    weights.resize(numParticles);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (int i=0; i<numParticles; ++i)
+      weights[i]=exp(logWeights[i])/sumWeights;
+  }
+
+  void ParticleFilter::getMean(std::vector<double> &mean,
+                               std::vector<std::vector<double> > &covariance)
+  {
+    double sumWeights,sumSquares;
+    normalizeLogWeights(sumWeights,sumSquares);
+
+    double sums[3];
+    Util::deterministicSum<2>(numParticles,MeanTerms(*this),sums);
+    mean.resize(2);
+    mean[0]=sums[0]/sumWeights;
+    mean[1]=sums[1]/sumWeights;
+
+    Util::deterministicSum<3>(numParticles,CovarianceTerms(*this,mean),sums);
+    covariance.resize(2);
+    covariance[0].resize(2);
+    covariance[1].resize(2);
+    covariance[0][0]=sums[0]/sumWeights;
+    covariance[1][1]=sums[1]/sumWeights;
+    covariance[0][1]=covariance[1][0]=sums[2]/sumWeights;
+  }
+
+  void ParticleFilter::getBestParticle(std::vector<double> &position)
+  {
+    int best=std::min_element(costs.begin(),costs.end())-costs.begin();
+    position.resize(2);
+    position[0]=xs[best];
+    position[1]=ys[best];
+  }
+}
@@ -0,0 +1,188 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Locate a transmitter by sequential importance
+//                  resampling (a particle filter) over the ML bearing
+//                  likelihood.
+//
+// Special Notes  : Particles are kept as separate arrays of x, y and log
+//                  weight (structure of arrays) so that the per-report
+//                  weight update is a straight pass over contiguous
+//                  memory that vectorizes, and is split over threads when
+//                  DFLib is built with OpenMP.
+//
+//                  Random numbers come from counter-based streams tied to
+//                  fixed blocks of particles, so the particles drawn for a
+//                  given seed do not depend on the number of threads.
+//                  Only weight sums may differ, in the last few bits.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_PARTICLE_FILTER_HPP
+#define DF_PARTICLE_FILTER_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include <stdint.h>
+#include "DF_Abstract_Report.hpp"
+
+namespace DFLib
+{
+  /// \brief Particle filter localizer for a stationary transmitter
+  ///
+  /// Each particle is a candidate transmitter position.  Every report
+  /// multiplies each particle's weight by the report's likelihood,
+  /// \f$\exp(-\Delta\theta^2/2\sigma^2)\f$, where \f$\Delta\theta\f$ is
+  /// the difference between the reported bearing and the bearing from
+  /// the receiver to the particle.  This is exactly the likelihood whose
+  /// negative log is ReportCollection::computeCostFunction, so after all
+  /// reports are in, the particles sample the same posterior the ML fix
+  /// maximizes, all of its modes included.
+  ///
+  /// When the weights get too uneven (effective sample size below a
+  /// threshold fraction of the particle count), the particles are
+  /// resampled systematically and jittered slightly so that duplicates
+  /// spread out again.
+  ///
+  /// Reports may be added one at a time as they arrive.
+  class CPL_DLL ParticleFilter
+  {
+  private:
+    int numParticles;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> logWeights;
+    std::vector<double> costs;
+    std::vector<double> scratchX;
+    std::vector<double> scratchY;
+    std::vector<double> scratchCosts;
+    std::vector<double> cumulative;
+    uint64_t seed;
+    uint64_t nextStream;
+    double resampleThreshold;
+    double roughening;
+    int numResamples;
+
+    // Terms of the sums over particles, for Util::deterministicSum
+    class WeightTerms;
+    class MeanTerms;
+    class CovarianceTerms;
+
+    void normalizeLogWeights(double &sumWeights, double &sumSquares);
+    void resample();
+
+  public:
+    /// \brief Make a filter
+    ///
+    /// \param n number of particles
+    /// \param theSeed seed of the filter's random number streams
+    ParticleFilter(int n, uint64_t theSeed=1);
+
+    /// \brief Scatter particles uniformly over a rectangle, equal weights
+    void initializeUniform(double xmin, double xmax,
+                           double ymin, double ymax);
+
+    /// \brief Scatter particles uniformly over a square around receivers
+    ///
+    /// The square covers the given receivers, widened on each side by
+    /// margin times their extent, as ArrayCollection::globalComputeMLFix
+    /// does for its search.
+    ///
+    /// \param n number of receivers
+    /// \param rx receiver x coordinates
+    /// \param ry receiver y coordinates
+    /// \param margin widening of the square
+    void initializeAroundReceivers(int n, const double *rx, const double *ry,
+                                   double margin=5.0);
+
+    /// \brief Resample when the effective sample size falls below this
+    /// fraction of the particle count.  Default 0.5.
+    inline void setResampleThreshold(double f) { resampleThreshold=f; };
+
+    /// \brief Jitter after resampling, as a fraction of the particle
+    /// cloud's extent scaled by \f$N^{-1/2}\f$.  Default 0.2; 0 turns
+    /// jitter off.
+    inline void setRoughening(double k) { roughening=k; };
+
+    /// \brief Weight the particles by one report
+    ///
+    /// \return false, leaving the filter unchanged, if the report is
+    ///         invalid.
+    bool update(DFLib::Abstract::Report *report);
+
+    /// \brief Weight the particles by one bearing
+    ///
+    /// \param rx receiver x coordinate
+    /// \param ry receiver y coordinate
+    /// \param bearing bearing in radians clockwise from north
+    /// \param sigma bearing standard deviation in radians
+    void update(double rx, double ry, double bearing, double sigma);
+
+    /// \brief Weight the particles by several bearings at once
+    ///
+    /// Same as calling update for each, but with a single pass over the
+    /// particles and at most one resampling.
+    void update(int n, const double *rx, const double *ry,
+                const double *bearing, const double *sigma);
+
+    inline int size() const { return numParticles; };
+
+    /// \brief number of times the particles have been resampled
+    inline int getNumResamples() const { return numResamples; };
+
+    /// \brief effective sample size, \f$1/\sum_i w_i^2\f$ for
+    /// normalized weights \f$w_i\f$
+    double effectiveSampleSize();
+
+    /// \brief weighted mean and covariance of the particles
+    ///
+    /// For a multimodal posterior the mean may lie between the modes;
+    /// see getBestParticle.
+    void getMean(std::vector<double> &mean,
+                 std::vector<std::vector<double> > &covariance);
+
+    /// \brief position of the particle of lowest accumulated cost
+    ///
+    /// Each particle carries the sum of the ML cost function terms of
+    /// every report seen so far, evaluated where the particle was at
+    /// the time.  The particle with the lowest sum is a good starting
+    /// point for computeMLFix, in whichever mode it lies.
+    void getBestParticle(std::vector<double> &position);
+
+    /// \brief particle x coordinates
+    inline const double *getParticleX() const { return &xs[0]; };
+    /// \brief particle y coordinates
+    inline const double *getParticleY() const { return &ys[0]; };
+    /// \brief normalized particle weights
+    void getWeights(std::vector<double> &weights);
+  };
+}
+#endif // DF_PARTICLE_FILTER_HPP
@@ -79,6 +79,9 @@ namespace DFLib
       while (bearing >= 2*M_PI)
         bearing -= 2*M_PI;
 
+      cosBearing=cos(bearing);
+      sinBearing=sin(bearing);
+      inverseVariance=1/(sigma*sigma);
     }        
 
     /// \brief Copy constructor
@@ -86,7 +89,10 @@ namespace DFLib
      Report::Report(const DFLib::Proj::Report & right)
        : DFLib::Abstract::Report(right),
          bearing(right.bearing),
-         sigma(right.sigma)
+         sigma(right.sigma),
+         cosBearing(right.cosBearing),
+         sinBearing(right.sinBearing),
+         inverseVariance(right.inverseVariance)
      {
        // do not copy the pointer to the point, make a copy and save a
        // pointer to it.
@@ -109,6 +115,9 @@ namespace DFLib
       receiverLocation = new Point(*(rhs.receiverLocation));
       bearing=rhs.bearing;
       sigma=rhs.sigma;
+      cosBearing=rhs.cosBearing;
+      sinBearing=rhs.sinBearing;
+      inverseVariance=rhs.inverseVariance;
       return *this;
     }
 
@@ -69,6 +69,8 @@ namespace DFLib
     private:
       Point *receiverLocation;            
       double bearing,sigma;
+      // unit bearing vector and 1/sigma^2, kept up to date by the setters
+      double cosBearing,sinBearing,inverseVariance;
     public:
       Report(const std::vector<double> &theLocationUser, 
                      const double &bearing,const double &std_dev,
@@ -85,6 +87,9 @@ namespace DFLib
       virtual  double getBearing() const;
       virtual  double getBearingStandardDeviationRadians() const;
       virtual  double getSigma() const;
+      virtual  double getBearingCosine() const;
+      virtual  double getBearingSine() const;
+      virtual  double getBearingInverseVariance() const;
       virtual  void  setReceiverLocationUser(const std::vector<double> &theLocation);
       virtual  void  setReceiverLocationMercator(const std::vector<double> &theLocation);
       //! set bearing in degrees
@@ -116,6 +121,19 @@ namespace DFLib
     return sigma*180/M_PI;
   }
 
+  inline double DFLib::Proj::Report::getBearingCosine() const
+  {
+    return cosBearing;
+  }
+  inline double DFLib::Proj::Report::getBearingSine() const
+  {
+    return sinBearing;
+  }
+  inline double DFLib::Proj::Report::getBearingInverseVariance() const
+  {
+    return inverseVariance;
+  }
+
   inline void DFLib::Proj::Report::setReceiverLocationUser(const std::vector<double> &theLocation)
   {
     receiverLocation->setUserCoords(theLocation);
@@ -144,11 +162,13 @@ namespace DFLib
       bearing += 2*M_PI;
     while (bearing >= 2*M_PI)
       bearing -= 2*M_PI;
-
+    cosBearing=cos(bearing);
+    sinBearing=sin(bearing);
   }
   inline void DFLib::Proj::Report::setSigma(double Sigma)
   {
     sigma=Sigma*M_PI/180;
+    inverseVariance=1/(sigma*sigma);
   }
 }
 #endif // DF_PROJ_REPORT_HPP
@@ -0,0 +1,240 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Grid index over receivers and bearing lines
+//
+// Special Notes  : Bearing lines are walked through the grid one cell
+//                  crossing at a time (Amanatides and Woo), so a line
+//                  lands in exactly the cells it passes through.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <algorithm>
+#include "DF_Receiver_Index.hpp"
+#include "DF_Report_Collection.hpp"
+#include "Util_Misc.hpp"
+
+namespace DFLib
+{
+  ReceiverIndex::ReceiverIndex(double theCellSize, double theMaxRange)
+    : cellSize(theCellSize),
+      maxRange(theMaxRange)
+  {
+    if (!(cellSize>0 && maxRange>0))
+      throw(Util::Exception("ReceiverIndex needs a positive cell size and range"));
+  }
+
+  ReceiverIndex::CellKey ReceiverIndex::cellOf(double x, double y) const
+  {
+    return CellKey(static_cast<int>(floor(x/cellSize)),
+                   static_cast<int>(floor(y/cellSize)));
+  }
+
+  void ReceiverIndex::build(int n, const double *x, const double *y,
+                            const double *bearing,
+                            const unsigned char *valid)
+  {
+    xs.assign(x,x+n);
+    ys.assign(y,y+n);
+    sines.resize(n);
+    cosines.resize(n);
+    receiverCells.clear();
+    lineCells.clear();
+    for (int i=0; i<n; ++i)
+    {
+      sines[i]=sin(bearing[i]);
+      cosines[i]=cos(bearing[i]);
+      if (valid && !valid[i])
+        continue;
+      receiverCells[cellOf(xs[i],ys[i])].push_back(i);
+      addLine(i);
+    }
+  }
+
+  void ReceiverIndex::build(DFLib::ReportCollection &collection)
+  {
+    int n=collection.size();
+    std::vector<double> x(n),y(n),bearing(n);
+    std::vector<unsigned char> valid(n);
+    for (int i=0; i<n; ++i)
+    {
+      const std::vector<double> &loc=collection.getReceiverLocationXY(i);
+      x[i]=loc[0];
+      y[i]=loc[1];
+      bearing[i]=collection.getReport(i)->getReportBearingRadians();
+      valid[i]=collection.isValid(i)?1:0;
+    }
+    // &v[0] is not allowed on an empty vector
+    if (n>0)
+      build(n,&x[0],&y[0],&bearing[0],&valid[0]);
+    else
+      build(0,0,0,0,0);
+  }
+
+  /// \brief put line i in every cell it crosses out to maxRange
+  void ReceiverIndex::addLine(int i)
+  {
+    // Bearings are clockwise from north, so the direction is (sin,cos)
+    double ux=sines[i];
+    double uy=cosines[i];
+    CellKey cell=cellOf(xs[i],ys[i]);
+    int stepX=(ux>0)?1:-1;
+    int stepY=(uy>0)?1:-1;
+
+    // Distance along the line to the next vertical and horizontal cell
+    // boundaries, and between successive ones
+    double huge=2*maxRange+1;
+    double nextX=huge;
+    double nextY=huge;
+    double deltaX=huge;
+    double deltaY=huge;
+    if (ux!=0)
+    {
+      double boundary=(cell.first+((ux>0)?1:0))*cellSize;
+      nextX=(boundary-xs[i])/ux;
+      deltaX=cellSize/fabs(ux);
+    }
+    if (uy!=0)
+    {
+      double boundary=(cell.second+((uy>0)?1:0))*cellSize;
+      nextY=(boundary-ys[i])/uy;
+      deltaY=cellSize/fabs(uy);
+    }
+
+    while (true)
+    {
+      lineCells[cell].push_back(i);
+      if (nextX<nextY)
+      {
+        if (nextX>maxRange)
+          break;
+        cell.first += stepX;
+        nextX += deltaX;
+      }
+      else
+      {
+        if (nextY>maxRange)
+          break;
+        cell.second += stepY;
+        nextY += deltaY;
+      }
+    }
+  }
+
+  /// \brief everything in the cells that overlap the square around a circle
+  ///
+  /// If the square covers more cells than are occupied, it is faster to
+  /// go through the occupied cells and keep the ones inside.
+  void ReceiverIndex::gather(const CellMap &cells, double x, double y,
+                             double radius,
+                             std::vector<int> &candidates) const
+  {
+    candidates.clear();
+    CellKey low=cellOf(x-radius,y-radius);
+    CellKey high=cellOf(x+radius,y+radius);
+    double numCovered=(double(high.first)-low.first+1)
+      *(double(high.second)-low.second+1);
+
+    if (numCovered > cells.size())
+    {
+      CellMap::const_iterator cellI;
+      for (cellI=cells.begin(); cellI!=cells.end(); ++cellI)
+      {
+        const CellKey &key=cellI->first;
+        if (key.first>=low.first && key.first<=high.first
+            && key.second>=low.second && key.second<=high.second)
+          candidates.insert(candidates.end(),cellI->second.begin(),
+                            cellI->second.end());
+      }
+    }
+    else
+    {
+      for (int cx=low.first; cx<=high.first; ++cx)
+      {
+        CellMap::const_iterator cellI=cells.lower_bound(CellKey(cx,low.second));
+        for (; cellI!=cells.end() && cellI->first.first==cx
+               && cellI->first.second<=high.second; ++cellI)
+          candidates.insert(candidates.end(),cellI->second.begin(),
+                            cellI->second.end());
+      }
+    }
+
+    // A line may be in several of the cells
+    std::sort(candidates.begin(),candidates.end());
+    candidates.erase(std::unique(candidates.begin(),candidates.end()),
+                     candidates.end());
+  }
+
+  void ReceiverIndex::findReceiversNear(double x, double y, double radius,
+                                        std::vector<int> &indices) const
+  {
+    std::vector<int> candidates;
+    gather(receiverCells,x,y,radius,candidates);
+    indices.clear();
+    for (int k=0; k<candidates.size(); ++k)
+    {
+      int i=candidates[k];
+      double dx=xs[i]-x;
+      double dy=ys[i]-y;
+      if (dx*dx+dy*dy <= radius*radius)
+        indices.push_back(i);
+    }
+  }
+
+  void ReceiverIndex::findBearingLinesNear(double x, double y, double radius,
+                                           std::vector<int> &indices) const
+  {
+    std::vector<int> candidates;
+    gather(lineCells,x,y,radius,candidates);
+    indices.clear();
+    for (int k=0; k<candidates.size(); ++k)
+    {
+      int i=candidates[k];
+      double dx=x-xs[i];
+      double dy=y-ys[i];
+      // nearest point of the line segment to (x,y)
+      double along=dx*sines[i]+dy*cosines[i];
+      if (along<0)
+        along=0;
+      else if (along>maxRange)
+        along=maxRange;
+      double ex=dx-along*sines[i];
+      double ey=dy-along*cosines[i];
+      if (ex*ex+ey*ey <= radius*radius)
+        indices.push_back(i);
+    }
+  }
+}
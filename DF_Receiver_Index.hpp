@@ -0,0 +1,141 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Find the receivers, and the bearing lines, that come
+//                  near a region of interest in a large network without
+//                  looking at every report.
+//
+// Special Notes  : This is a uniform grid, stored sparsely, rather than a
+//                  tree.  Receivers go in the cell they sit in, and each
+//                  bearing line, cut off at a maximum range, goes in
+//                  every cell it crosses.  A query only looks at the
+//                  cells that overlap it, then checks the few reports it
+//                  finds there exactly.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_RECEIVER_INDEX_HPP
+#define DF_RECEIVER_INDEX_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include <map>
+#include <utility>
+
+namespace DFLib
+{
+  class ReportCollection;
+
+  /// \brief Grid index over receiver positions and bearing lines
+  ///
+  /// Positions are the XY (Mercator) coordinates that
+  /// Abstract::Report::getReceiverLocation returns, so cell sizes, ranges
+  /// and radii are in Mercator meters, which are larger than true meters
+  /// away from the equator by the Mercator scale factor.
+  ///
+  /// The index refers to reports by their position in the arrays or the
+  /// collection it was built from, and does not notice later changes to
+  /// them.  Build it again after reports are added, removed or moved.
+  /// Reports that are not valid are left out.
+  ///
+  /// A typical use is to restrict the fix methods of a large collection
+  /// to the reports whose bearing lines pass near a candidate area:
+  /// \code
+  ///   DFLib::ReceiverIndex index(10000,500000);
+  ///   index.build(collection);
+  ///   std::vector<int> nearby;
+  ///   index.findBearingLinesNear(x,y,20000,nearby);
+  ///   collection.materialize(nearby);
+  ///   collection.computeMLFix(fix);
+  /// \endcode
+  class CPL_DLL ReceiverIndex
+  {
+  private:
+    typedef std::pair<int,int> CellKey;
+    typedef std::map<CellKey,std::vector<int> > CellMap;
+
+    double cellSize;
+    double maxRange;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> sines;
+    std::vector<double> cosines;
+    CellMap receiverCells;
+    CellMap lineCells;
+
+    CellKey cellOf(double x, double y) const;
+    void addLine(int i);
+    void gather(const CellMap &cells, double x, double y, double radius,
+                std::vector<int> &candidates) const;
+
+  public:
+    /// \brief Make an empty index
+    ///
+    /// \param theCellSize width of the grid cells.  About the size of a
+    ///        typical query radius works well.
+    /// \param theMaxRange bearing lines are indexed out to this distance
+    ///        from their receivers, and no farther
+    ReceiverIndex(double theCellSize, double theMaxRange);
+
+    /// \brief Index bearings given as arrays, as for ArrayCollection
+    ///
+    /// \param n number of bearings
+    /// \param x receiver x coordinates
+    /// \param y receiver y coordinates
+    /// \param bearing bearings in radians clockwise from north
+    /// \param valid 0 for bearings to leave out; may be null
+    void build(int n, const double *x, const double *y,
+               const double *bearing, const unsigned char *valid=0);
+
+    /// \brief Index the reports of a collection
+    void build(DFLib::ReportCollection &collection);
+
+    /// \brief number of reports the index was built from, valid or not
+    inline int size() const { return static_cast<int>(xs.size()); };
+
+    /// \brief Indices of receivers within radius of (x,y), ascending
+    void findReceiversNear(double x, double y, double radius,
+                           std::vector<int> &indices) const;
+
+    /// \brief Indices of bearing lines that pass within radius of (x,y)
+    ///
+    /// A bearing line is the ray from its receiver in the direction of
+    /// its bearing, out to the maximum range.  Only the ray counts: a
+    /// point behind the receiver is as far from the line as it is from
+    /// the receiver.
+    ///
+    /// \return indices in ascending order, so they may be handed to
+    ///         ReportCollection::materialize directly.
+    void findBearingLinesNear(double x, double y, double radius,
+                              std::vector<int> &indices) const;
+  };
+}
+#endif // DF_RECEIVER_INDEX_HPP
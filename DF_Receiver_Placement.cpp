@@ -0,0 +1,260 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Receiver site selection by Cramer-Rao bounds
+//
+// Special Notes  : Trying a candidate never changes the map: its terms
+//                  are added on the fly while the grid is scored, and
+//                  only the winner is added to the map for real.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include "DF_Receiver_Placement.hpp"
+#include "Util_Misc.hpp"
+
+namespace DFLib
+{
+  ReceiverPlacement::ReceiverPlacement(const std::vector<double> &theGridX,
+                                       const std::vector<double> &theGridY)
+    : gridX(theGridX),
+      gridY(theGridY),
+      map(theGridX,theGridY)
+  {
+    double width=*std::max_element(gridX.begin(),gridX.end())
+      -*std::min_element(gridX.begin(),gridX.end());
+    double height=*std::max_element(gridY.begin(),gridY.end())
+      -*std::min_element(gridY.begin(),gridY.end());
+    double size=std::max(width,height);
+    if (size<=0)
+      size=1;
+    priorInformation=1/(size*size);
+  }
+
+  int ReceiverPlacement::addCandidate(double x, double y, double sigma)
+  {
+    if (!(sigma>0))
+      throw(Util::Exception("ReceiverPlacement candidates need positive standard deviations"));
+    candX.push_back(x);
+    candY.push_back(y);
+    candSigma.push_back(sigma);
+    return candX.size()-1;
+  }
+
+  void ReceiverPlacement::addFixedReceiver(double x, double y, double sigma)
+  {
+    map.addReceiver(x,y,sigma);
+    fixedX.push_back(x);
+    fixedY.push_back(y);
+    fixedSigma.push_back(sigma);
+  }
+
+  /// \brief start the map over with just the fixed receivers
+  void ReceiverPlacement::resetMap()
+  {
+    map=DFLib::CRBMap(gridX,gridY);
+    if (!fixedX.empty())
+      map.addReceivers(fixedX.size(),&fixedX[0],&fixedY[0],&fixedSigma[0]);
+  }
+
+  /// \brief score of the map with one candidate added, or of the map as
+  /// it is if candidate is -1
+  ///
+  /// Same terms as CRBMap, plus the prior on the diagonal.
+  double ReceiverPlacement::scoreWith(int candidate,
+                                      Criterion criterion) const
+  {
+    int nx=gridX.size();
+    int ny=gridY.size();
+    double x0=0,y0=0,w=0;
+    if (candidate>=0)
+    {
+      x0=candX[candidate];
+      y0=candY[candidate];
+      w=1/(candSigma[candidate]*candSigma[candidate]);
+    }
+    const std::vector<double> &lambda=map.getLambda();
+    const std::vector<double> &mu=map.getMu();
+    const std::vector<double> &nu=map.getNu();
+    double prior=priorInformation;
+
+    std::vector<double> dets(nx);
+    double sum=0;
+    double worst=0;
+    for (int k=0; k<ny; ++k)
+    {
+      const double *l=&lambda[k*nx];
+      const double *m=&mu[k*nx];
+      const double *n=&nu[k*nx];
+      double dy=gridY[k]-y0;
+      double dy2=dy*dy;
+      if (dy2>0)
+      {
+        for (int i=0; i<nx; ++i)
+        {
+          double dx=gridX[i]-x0;
+          double d2=dx*dx+dy2;
+          double f=w/(d2*d2);
+          double a=l[i]+prior+f*dy2;
+          double b=m[i]+prior+f*dx*dx;
+          double c=n[i]+f*dx*dy;
+          dets[i]=a*b-c*c;
+        }
+      }
+      else
+      {
+        for (int i=0; i<nx; ++i)
+        {
+          double dx=gridX[i]-x0;
+          double b=m[i]+prior;
+          if (dx!=0)
+            b += w/(dx*dx);
+          dets[i]=(l[i]+prior)*b-n[i]*n[i];
+        }
+      }
+      // sqrt is kept out of the loops above, which then vectorize
+      // even where the math library must set errno
+      for (int i=0; i<nx; ++i)
+      {
+        double area=M_PI/sqrt(dets[i]);
+        sum += area;
+        worst=std::max(worst,area);
+      }
+    }
+    return (criterion==WORST_AREA)?worst:sum/(nx*ny);
+  }
+
+  /// \brief the candidate, not excluded, whose addition scores best
+  ///
+  /// Ties go to the lowest index, so the answer does not depend on the
+  /// number of threads.
+  int ReceiverPlacement::bestCandidate(const std::vector<unsigned char> &excluded,
+                                       Criterion criterion,
+                                       double &bestScore) const
+  {
+    int nc=candX.size();
+    std::vector<double> scores(nc,std::numeric_limits<double>::infinity());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+    for (int c=0; c<nc; ++c)
+    {
+      if (!excluded[c])
+        scores[c]=scoreWith(c,criterion);
+    }
+
+    int best=-1;
+    bestScore=std::numeric_limits<double>::infinity();
+    for (int c=0; c<nc; ++c)
+    {
+      if (!excluded[c] && (best<0 || scores[c]<bestScore))
+      {
+        best=c;
+        bestScore=scores[c];
+      }
+    }
+    return best;
+  }
+
+  double ReceiverPlacement::choose(int k, std::vector<int> &chosen,
+                                   Criterion criterion, int maxSwapPasses)
+  {
+    int nc=candX.size();
+    if (k<1 || k>nc)
+      throw(Util::Exception("ReceiverPlacement::choose asked for more sites than there are candidates"));
+
+    resetMap();
+    chosen.clear();
+    std::vector<int> ids;
+    std::vector<unsigned char> excluded(nc,0);
+    double score=0;
+
+    for (int j=0; j<k; ++j)
+    {
+      int c=bestCandidate(excluded,criterion,score);
+      chosen.push_back(c);
+      excluded[c]=1;
+      ids.push_back(map.addReceiver(candX[c],candY[c],candSigma[c]));
+    }
+
+    // Take each chosen site out in turn and put back whichever
+    // candidate does best in its place, which may be the same one.
+    for (int pass=0; pass<maxSwapPasses; ++pass)
+    {
+      bool improved=false;
+      for (int j=0; j<k; ++j)
+      {
+        int current=chosen[j];
+        map.removeReceiver(ids[j]);
+        excluded[current]=0;
+
+        double newScore;
+        int c=bestCandidate(excluded,criterion,newScore);
+        if (c!=current && newScore<score*(1-1e-9))
+        {
+          chosen[j]=c;
+          score=newScore;
+          improved=true;
+        }
+        excluded[chosen[j]]=1;
+        ids[j]=map.addReceiver(candX[chosen[j]],candY[chosen[j]],
+                               candSigma[chosen[j]]);
+      }
+      if (!improved)
+        break;
+    }
+
+    // Rebuild from scratch, so the map carries no rounding left over
+    // from the swaps
+    map.refresh();
+    return scoreWith(-1,criterion);
+  }
+
+  double ReceiverPlacement::computeScore(const std::vector<int> &sites,
+                                         Criterion criterion)
+  {
+    resetMap();
+    for (int j=0; j<int(sites.size()); ++j)
+    {
+      int c=sites[j];
+      if (c<0 || c>=int(candX.size()))
+        throw(Util::Exception("ReceiverPlacement::computeScore given a bad candidate index"));
+      map.addReceiver(candX[c],candY[c],candSigma[c]);
+    }
+    return scoreWith(-1,criterion);
+  }
+}
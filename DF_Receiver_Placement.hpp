@@ -0,0 +1,134 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Choose receiver sites from a list of candidates so as
+//                  to make the Cramer-Rao error ellipses over a target
+//                  area as small as possible.
+//
+// Special Notes  : Sites are chosen greedily, one at a time, and the
+//                  choice is then improved by swapping chosen sites for
+//                  unchosen ones while that helps.  The information sums
+//                  of the sites chosen so far live in a CRBMap, so trying
+//                  a candidate costs one pass over the target grid, and
+//                  candidates are tried in parallel when DFLib is built
+//                  with OpenMP.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_RECEIVER_PLACEMENT_HPP
+#define DF_RECEIVER_PLACEMENT_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include "DF_CRB_Map.hpp"
+
+namespace DFLib
+{
+  /// \brief Choose k receiver sites for the best Cramer-Rao bounds
+  ///
+  /// The target area is a grid of points, as for CRBMap.  A site plan is
+  /// scored by the mean or the largest area of the one standard
+  /// deviation error ellipse over the grid.
+  ///
+  /// Points the network cannot locate at all have infinite ellipses,
+  /// which would make every plan with fewer than two sites score the
+  /// same.  Scores are therefore computed as if every point also had
+  /// a prior standard deviation as large as the target area in each
+  /// direction, which matters only where the bearings say next to
+  /// nothing.
+  ///
+  /// Receivers that are already in place may be given with
+  /// addFixedReceiver; they count in every plan.
+  class CPL_DLL ReceiverPlacement
+  {
+  public:
+    /// \brief What a plan is scored by
+    enum Criterion
+    {
+      MEAN_AREA,   ///< mean ellipse area over the grid
+      WORST_AREA   ///< largest ellipse area over the grid
+    };
+
+  private:
+    std::vector<double> gridX;
+    std::vector<double> gridY;
+    std::vector<double> candX;
+    std::vector<double> candY;
+    std::vector<double> candSigma;
+    std::vector<double> fixedX;
+    std::vector<double> fixedY;
+    std::vector<double> fixedSigma;
+    double priorInformation;
+    DFLib::CRBMap map;
+
+    void resetMap();
+    double scoreWith(int candidate, Criterion criterion) const;
+    int bestCandidate(const std::vector<unsigned char> &excluded,
+                      Criterion criterion, double &bestScore) const;
+
+  public:
+    /// \brief Plan for the target area given by grid coordinates
+    ReceiverPlacement(const std::vector<double> &theGridX,
+                      const std::vector<double> &theGridY);
+
+    /// \brief Add a candidate site
+    /// \param sigma bearing standard deviation of a receiver there
+    /// \return index of the candidate
+    int addCandidate(double x, double y, double sigma);
+
+    /// \brief Add a receiver that is in every plan
+    void addFixedReceiver(double x, double y, double sigma);
+
+    inline int numCandidates() const { return candX.size(); };
+
+    /// \brief Choose k of the candidates
+    ///
+    /// \param k number of sites to choose
+    /// \param chosen indices of the chosen candidates, in the order
+    ///        the greedy pass took them
+    /// \param criterion what to minimize
+    /// \param maxSwapPasses how many times at most to go through the
+    ///        chosen sites looking for better swaps.  0 keeps the
+    ///        greedy choice.
+    /// \return score of the chosen plan
+    double choose(int k, std::vector<int> &chosen,
+                  Criterion criterion=MEAN_AREA, int maxSwapPasses=10);
+
+    /// \brief Score any plan, for comparison
+    double computeScore(const std::vector<int> &sites,
+                        Criterion criterion=MEAN_AREA);
+
+    /// \brief Bound map of the fixed receivers and the last plan chosen
+    /// or scored
+    inline const DFLib::CRBMap &getMap() const { return map; };
+  };
+}
+#endif // DF_RECEIVER_PLACEMENT_HPP
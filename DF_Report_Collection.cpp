@@ -55,27 +55,239 @@
 #define _USE_MATH_DEFINES
 #endif
 #include <iostream>
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include "DF_Abstract_Report.hpp"
 #include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "DF_Exclusion_Search.hpp"
 #include "Util_Minimization_Methods.hpp"
 #include "Util_Misc.hpp"
+#include "Util_Fast_Math.hpp"
+#include "Util_Reduction.hpp"
 
 namespace DFLib
 {
+  // Terms of the collection-wide sums, one report at a time, for
+  // Util::deterministicSum.  Each report is looked at by one thread
+  // only, so the lazy coordinate conversion in getReceiverLocation is
+  // safe as long as a report is not in the collection twice.
+
+  /// \brief ML cost function terms at a point
+  ///
+  /// order 0 gives just the cost, order 1 the cost and gradient, order 2
+  /// the cost, gradient and Hessian by rows.
+  class CostFunctionTerms
+  {
+  private:
+    const std::vector<DFLib::Abstract::Report *> &reports;
+    double px,py;
+    int order;
+  public:
+    CostFunctionTerms(const std::vector<DFLib::Abstract::Report *> &theReports,
+                      const std::vector<double> &point, int theOrder)
+      : reports(theReports), px(point[0]), py(point[1]), order(theOrder)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      DFLib::Abstract::Report *report=reports[i];
+      if (!report->isValid())
+        return false;
+      const std::vector<double> &loc=report->getReceiverLocation();
+      double dx=px-loc[0];
+      double dy=py-loc[1];
+      double sm=report->getBearingSine();
+      double cm=report->getBearingCosine();
+      double w=report->getBearingInverseVariance();
+      if (order==0)
+      {
+        // bearing to point minus measured bearing, as the angle between
+        // their unit vectors, so already in range -pi<deltatheta<=pi
+        double deltatheta=Util::angleAtan2(dx*cm-dy*sm,dy*cm+dx*sm);
+        t[0]=0.5*w*(deltatheta)*(deltatheta);
+        return true;
+      }
+
+      double d=sqrt(dx*dx+dy*dy);
+      // sine and cosine of the bearing to the point
+      double c=dy/d;
+      double s=dx/d;
+      // measured bearing minus bearing to point, in -pi<deltatheta<=pi
+      double deltatheta=Util::angleAtan2(sm*c-cm*s,cm*c+sm*s);
+      t[0]=0.5*w*(deltatheta*deltatheta);
+      t[1]=(deltatheta)*w/d*(-c);
+      t[2]=(deltatheta)*w/d*( s);
+      if (order>1)
+      {
+        double coef = w/(d*d);
+        t[3]=coef*(c*c-s*c*deltatheta);
+        t[4]=coef*(-s*c-s*s*deltatheta);
+        t[5]=coef*(-s*c+c*c*deltatheta);
+        t[6]=coef*(s*s-c*s*deltatheta);
+      }
+      return true;
+    }
+  };
+
+  /// \brief least squares normal equation terms: atb1, atb2, a11, a12, a22
+  class LeastSquaresTerms
+  {
+  private:
+    const std::vector<DFLib::Abstract::Report *> &reports;
+  public:
+    LeastSquaresTerms(const std::vector<DFLib::Abstract::Report *> &theReports)
+      : reports(theReports)
+    {};
+    bool operator()(int i, double *t) const
+    {
+      DFLib::Abstract::Report *report=reports[i];
+      if (!report->isValid())
+        return false;
+      double c=report->getBearingCosine();
+      double s=report->getBearingSine();
+      const std::vector<double> &loc=report->getReceiverLocation();
+      double b=loc[0]*c-loc[1]*s;
+      t[0]=c*b;
+      t[1]=-s*b;
+      t[2]=s*s;
+      t[3]=s*c;
+      t[4]=c*c;
+      return true;
+    }
+  };
+
+  /// \brief Fisher information terms at a point: lambda, nu, mu
+  class CramerRaoTerms
+  {
+  private:
+    const std::vector<DFLib::Abstract::Report *> &reports;
+    double px,py;
+  public:
+    CramerRaoTerms(const std::vector<DFLib::Abstract::Report *> &theReports,
+                   const std::vector<double> &point)
+      : reports(theReports), px(point[0]), py(point[1])
+    {};
+    bool operator()(int i, double *t) const
+    {
+      DFLib::Abstract::Report *report=reports[i];
+      if (!report->isValid())
+        return false;
+      const std::vector<double> &loc=report->getReceiverLocation();
+      double dx=px-loc[0];
+      double dy=py-loc[1];
+      double ds2=dx*dx+dy*dy;
+      double w=report->getBearingInverseVariance()/(ds2*ds2);
+      t[0]=dy*dy*w;
+      t[1]=dx*dy*w;
+      t[2]=dx*dx*w;
+      return true;
+    }
+  };
+
+  /// \brief one Stansfield iteration's terms, over the valid reports
+  ///
+  /// With step false, mu, nu and lambda.  With step true, the two
+  /// components of the step before division by the determinant, for the
+  /// given mu, nu and lambda.
+  class StansfieldTerms
+  {
+  private:
+    const std::vector<double> &distances;
+    const std::vector<double> &sines;
+    const std::vector<double> &cosines;
+    const std::vector<double> &inverseVariances;
+    const std::vector<double> &p;
+    bool step;
+    double mu,nu,lambda;
+  public:
+    StansfieldTerms(const std::vector<double> &theDistances,
+                    const std::vector<double> &theSines,
+                    const std::vector<double> &theCosines,
+                    const std::vector<double> &theInverseVariances,
+                    const std::vector<double> &theP)
+      : distances(theDistances), sines(theSines), cosines(theCosines),
+        inverseVariances(theInverseVariances), p(theP),
+        step(false), mu(0), nu(0), lambda(0)
+    {};
+    void setStep(double theMu, double theNu, double theLambda)
+    {
+      step=true;
+      mu=theMu;
+      nu=theNu;
+      lambda=theLambda;
+    };
+    bool operator()(int i, double *t) const
+    {
+      double w=inverseVariances[i]/(distances[i]*distances[i]);
+      if (!step)
+      {
+        // again, sine and cosine opposite from Stansfield because of
+        // angular convention
+        t[0]=(sines[i]*sines[i])*w;
+        t[1]=(cosines[i]*sines[i])*w;
+        t[2]=(cosines[i]*cosines[i])*w;
+      }
+      else
+      {
+        t[0]=p[i]*(nu*sines[i]-mu*cosines[i])*w;
+        t[1]=p[i]*(lambda*sines[i]-nu*cosines[i])*w;
+      }
+      return true;
+    }
+  };
+
+  /// \brief Materializes a ReportCollection for the life of a scope
+  ///
+  /// Methods that only exist on the snapshot make a temporary one if the
+  /// caller has not materialized the collection.  This discards it again
+  /// however the method is left, exception or not, so a temporary
+  /// snapshot is never left behind looking like the caller's.  A
+  /// snapshot the caller made is left alone.
+  class ScopedSnapshot
+  {
+  private:
+    ReportCollection &collection;
+    bool temporary;
+
+    // Never copied
+    ScopedSnapshot(const ScopedSnapshot &right);
+    ScopedSnapshot &operator=(const ScopedSnapshot &right);
+
+  public:
+    ScopedSnapshot(ReportCollection &c)
+      : collection(c),
+        temporary(!c.isMaterialized())
+    {
+      if (temporary)
+        collection.materialize();
+    };
+    ~ScopedSnapshot()
+    {
+      if (temporary)
+        collection.invalidateSnapshot();
+    };
+  };
+
   // Class DFReportCollection
 
   ReportCollection::ReportCollection()
     :f_is_valid(false),
      g_is_valid(false),
-     h_is_valid(false)
+     h_is_valid(false),
+     snapshotValid(false),
+     snapshot(new DFLib::ArrayCollection(0,0,0,0,0)),
+     cutPoint(0),
+     numGoodCuts(0),
+     cutChangesSinceRefresh(0)
   {
     theReports.clear();
   }
 
   ReportCollection::~ReportCollection()
   {
+    delete cutPoint;
+    delete snapshot;
   }
 
   void ReportCollection::deleteReports()
@@ -88,67 +300,313 @@ namespace DFLib
       ++iterReport;
     }
     theReports.clear();
+    snapshotValid=false;
+    clearFixCuts();
   }
 
   int ReportCollection::addReport(DFLib::Abstract::Report *aReport)
   {
     theReports.push_back(aReport);
+    snapshotValid=false;
     return (theReports.size()-1); // return the index to this report.
   }
 
+  DFLib::Abstract::Report * ReportCollection::removeReport(int i)
+  {
+    DFLib::Abstract::Report *removed=0;
+    if (i<theReports.size() && i>=0)
+    {
+      removed=theReports[i];
+      theReports.erase(theReports.begin()+i);
+      if (i<cutTable.size())
+        removeCutRow(i);
+      snapshotValid=false;
+      // Anything cached for the old evaluation point is now stale
+      f_is_valid=false;
+      g_is_valid=false;
+      h_is_valid=false;
+    }
+    return (removed);
+  }
+
+  ReportCollection *
+  ReportCollection::makeSubset(const std::vector<int> &reportIndices) const
+  {
+    ReportCollection *subset=new ReportCollection;
+    for (int k=0; k<reportIndices.size(); ++k)
+    {
+      int i=reportIndices[k];
+      if (i>=0 && i<theReports.size())
+        subset->addReport(theReports[i]);
+    }
+    return subset;
+  }
+
+  void ReportCollection::materialize()
+  {
+    std::vector<int> all(theReports.size());
+    for (int i=0; i<all.size(); ++i)
+      all[i]=i;
+    materialize(all);
+  }
+
+  void ReportCollection::materialize(const std::vector<int> &reportIndices)
+  {
+    snapX.clear();
+    snapY.clear();
+    snapBearing.clear();
+    snapSigma.clear();
+    snapCosine.clear();
+    snapSine.clear();
+    snapInverseVariance.clear();
+    snapValid.clear();
+    for (int k=0; k<reportIndices.size(); ++k)
+    {
+      int i=reportIndices[k];
+      if (i<0 || i>=theReports.size())
+        continue;
+      const std::vector<double> &loc=theReports[i]->getReceiverLocation();
+      snapX.push_back(loc[0]);
+      snapY.push_back(loc[1]);
+      snapBearing.push_back(theReports[i]->getReportBearingRadians());
+      snapSigma.push_back(theReports[i]->getBearingStandardDeviationRadians());
+      // The reports' own cached values, so the snapshot's sums are the
+      // reports' sums to the last bit
+      snapCosine.push_back(theReports[i]->getBearingCosine());
+      snapSine.push_back(theReports[i]->getBearingSine());
+      snapInverseVariance.push_back(theReports[i]->getBearingInverseVariance());
+      snapValid.push_back((theReports[i]->isValid())?1:0);
+    }
+    int n=snapX.size();
+    // &v[0] is not allowed on an empty vector
+    if (n>0)
+      snapshot->setArrays(n,&snapX[0],&snapY[0],&snapBearing[0],
+                          &snapSigma[0],&snapCosine[0],&snapSine[0],
+                          &snapInverseVariance[0],&snapValid[0]);
+    else
+      snapshot->setArrays(0,0,0,0,0,0);
+    snapshotValid=true;
+    f_is_valid=false;
+    g_is_valid=false;
+    h_is_valid=false;
+  }
+
+  /// \brief cut of report i with report j, into cut
+  ///
+  /// Computed as report i's cut with report j, with i<j, exactly as the
+  /// cut average always has been.
+  void ReportCollection::computeCut(int i, int j, FixCut &cut)
+  {
+    cut.angle=-1;
+    if (!theReports[i]->isValid() || !theReports[j]->isValid())
+      return;
+
+    FixStatus fs;
+    double cutAngle;
+    theReports[i]->computeFixCut(theReports[j],*cutPoint,cutAngle,fs);
+    if (fs == GOOD_FIX)
+    {
+      cut.angle=fabs(cutAngle);
+      const std::vector<double> &uv=cutPoint->getUserCoords();
+      cut.u=uv[0];
+      cut.v=uv[1];
+    }
+  }
+
+  void ReportCollection::addCutToSums(const FixCut &cut, double sign)
+  {
+    if (cut.angle>=0)
+    {
+      numGoodCuts += (sign>0)?1:-1;
+      cutSumU.add(sign*cut.u);
+      cutSumV.add(sign*cut.v);
+      cutSumU2.add(sign*cut.u*cut.u);
+      cutSumV2.add(sign*cut.v*cut.v);
+    }
+  }
+
+  /// \brief recompute the running sums from the table
+  ///
+  /// Subtracting a cut from the sums does not give back exactly the sums
+  /// without it, so this is done once there have been as many row
+  /// changes as there are rows, as WindowedCollection does with its
+  /// sums.
+  void ReportCollection::refreshCutSums()
+  {
+    numGoodCuts=0;
+    cutSumU=cutSumV=cutSumU2=cutSumV2=Util::NeumaierSum();
+    for (int i=0; i<cutTable.size(); ++i)
+      for (int j=0; j<cutTable[i].size(); ++j)
+        addCutToSums(cutTable[i][j],1.0);
+    cutChangesSinceRefresh=0;
+  }
+
+  /// \brief recompute every cut involving report r, its row and column
+  void ReportCollection::recomputeCutRow(int r)
+  {
+    const std::vector<double> &loc=theReports[r]->getReceiverLocation();
+    cutReportX[r]=loc[0];
+    cutReportY[r]=loc[1];
+    cutReportBearing[r]=theReports[r]->getReportBearingRadians();
+    cutReportValid[r]=(theReports[r]->isValid())?1:0;
+
+    for (int j=0; j<r; ++j)
+    {
+      addCutToSums(cutTable[r][j],-1.0);
+      computeCut(j,r,cutTable[r][j]);
+      addCutToSums(cutTable[r][j],1.0);
+    }
+    for (int i=r+1; i<cutTable.size(); ++i)
+    {
+      addCutToSums(cutTable[i][r],-1.0);
+      computeCut(r,i,cutTable[i][r]);
+      addCutToSums(cutTable[i][r],1.0);
+    }
+    if (++cutChangesSinceRefresh >= cutTable.size())
+      refreshCutSums();
+  }
+
+  /// \brief add the row of the first report not yet in the table
+  void ReportCollection::appendCutRow()
+  {
+    int r=cutTable.size();
+    const std::vector<double> &loc=theReports[r]->getReceiverLocation();
+    cutReportX.push_back(loc[0]);
+    cutReportY.push_back(loc[1]);
+    cutReportBearing.push_back(theReports[r]->getReportBearingRadians());
+    cutReportValid.push_back((theReports[r]->isValid())?1:0);
+
+    cutTable.push_back(std::vector<FixCut>(r));
+    for (int j=0; j<r; ++j)
+    {
+      computeCut(j,r,cutTable[r][j]);
+      addCutToSums(cutTable[r][j],1.0);
+    }
+  }
+
+  /// \brief drop report r's cuts, when it leaves the collection
+  void ReportCollection::removeCutRow(int r)
+  {
+    for (int j=0; j<r; ++j)
+      addCutToSums(cutTable[r][j],-1.0);
+    for (int i=r+1; i<cutTable.size(); ++i)
+    {
+      addCutToSums(cutTable[i][r],-1.0);
+      cutTable[i].erase(cutTable[i].begin()+r);
+    }
+    cutTable.erase(cutTable.begin()+r);
+    cutReportX.erase(cutReportX.begin()+r);
+    cutReportY.erase(cutReportY.begin()+r);
+    cutReportBearing.erase(cutReportBearing.begin()+r);
+    cutReportValid.erase(cutReportValid.begin()+r);
+    if (++cutChangesSinceRefresh >= cutTable.size())
+      refreshCutSums();
+  }
+
+  /// \brief bring the cut table up to date with the reports
+  void ReportCollection::updateFixCuts(DFLib::Abstract::Point &FCA)
+  {
+    // Cuts are stored in the user coordinates of the point they were
+    // computed with.  If FCA converts the probe point differently, it
+    // is in another coordinate system, and the table starts over.
+    DFLib::Abstract::Point *probe=FCA.Clone();
+    bool sameCoordinates=false;
+    if (cutPoint!=0 && !cutProbeXY.empty())
+    {
+      probe->setXY(cutProbeXY);
+      sameCoordinates=(probe->getUserCoords()==cutProbeUV);
+    }
+    if (sameCoordinates)
+    {
+      delete probe;
+    }
+    else
+    {
+      clearFixCuts();
+      delete cutPoint;
+      cutPoint=probe;
+    }
+
+    // Reports changed since their cuts were computed
+    for (int r=0; r<cutTable.size(); ++r)
+    {
+      const std::vector<double> &loc=theReports[r]->getReceiverLocation();
+      if (loc[0]!=cutReportX[r] || loc[1]!=cutReportY[r]
+          || theReports[r]->getReportBearingRadians()!=cutReportBearing[r]
+          || theReports[r]->isValid()!=(cutReportValid[r]!=0))
+        recomputeCutRow(r);
+    }
+
+    // Reports added since
+    while (cutTable.size()<theReports.size())
+      appendCutRow();
+
+    if (cutProbeXY.empty() && !theReports.empty())
+    {
+      cutProbeXY=theReports[0]->getReceiverLocation();
+      cutPoint->setXY(cutProbeXY);
+      cutProbeUV=cutPoint->getUserCoords();
+    }
+  }
+
+  void ReportCollection::clearFixCuts()
+  {
+    cutTable.clear();
+    cutReportX.clear();
+    cutReportY.clear();
+    cutReportBearing.clear();
+    cutReportValid.clear();
+    cutProbeXY.clear();
+    cutProbeUV.clear();
+    refreshCutSums();
+  }
+
   bool ReportCollection::computeFixCutAverage(DFLib::Abstract::Point &FCA,
                                               std::vector<double> &FCA_stddev,
                                               double minAngle)
   {
-    std::vector<double> tempVec;
-    FixStatus fs;
     bool retval;
     int numCuts=0;
-    std::vector<double> tempFCA;
-    std::vector<double> tempScratch;
-    DFLib::Abstract::Point *tempPoint;
-
-    // Make a point object that uses the same coordinate system that our
-    // return object will use, and initialize it to 0.
-    tempPoint = FCA.Clone();
-    tempFCA.resize(2);
-    tempFCA[0]=tempFCA[1]=0;
-    tempPoint->setXY(tempFCA);
-
+    std::vector<double> tempFCA(2,0.0);
     FCA_stddev.resize(2);
     FCA_stddev[0]=FCA_stddev[1]=0;
 
-    std::vector<DFLib::Abstract::Report *>::iterator iterReportI;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
-    // loop over all reports
-    for (iterReportI=theReports.begin();iterReportI!=reportEnd;
-         ++iterReportI)
+    updateFixCuts(FCA);
+
+    if (minAngle<=0)
     {
-      if ((*iterReportI)->isValid())
+      numCuts=numGoodCuts;
+      tempFCA[0]=cutSumU.value();
+      tempFCA[1]=cutSumV.value();
+      FCA_stddev[0]=cutSumU2.value();
+      FCA_stddev[1]=cutSumV2.value();
+    }
+    else
+    {
+      // Leave out shallow cuts, by their stored angles
+      double minRadians=minAngle*M_PI/180.0;
+      Util::NeumaierSum sumU,sumV,sumU2,sumV2;
+      for (int i=0; i<cutTable.size(); ++i)
       {
-        // loop over all reports after this one
-        std::vector<DFLib::Abstract::Report *>::iterator iterReportJ;
-        for (iterReportJ=iterReportI,++iterReportJ;
-             iterReportJ != reportEnd;
-             ++iterReportJ)
+        for (int j=0; j<cutTable[i].size(); ++j)
         {
-          if ((*iterReportJ)->isValid())
+          const FixCut &cut=cutTable[i][j];
+          if (cut.angle >= minRadians)
           {
-            double cutAngle;
-            (*iterReportI)->computeFixCut(*iterReportJ,*tempPoint,cutAngle,fs);
-            if (fs == GOOD_FIX && fabs(cutAngle) >= minAngle*M_PI/180.0)
-            {
-              numCuts++;
-              tempVec = tempPoint->getUserCoords();
-              tempFCA[0] += tempVec[0];
-              tempFCA[1] += tempVec[1];
-              FCA_stddev[0] += tempVec[0]*tempVec[0];
-              FCA_stddev[1] += tempVec[1]*tempVec[1];
-            }
+            numCuts++;
+            sumU.add(cut.u);
+            sumV.add(cut.v);
+            sumU2.add(cut.u*cut.u);
+            sumV2.add(cut.v*cut.v);
           }
         }
       }
+      tempFCA[0]=sumU.value();
+      tempFCA[1]=sumV.value();
+      FCA_stddev[0]=sumU2.value();
+      FCA_stddev[1]=sumV2.value();
     }
+
     if (numCuts != 0) // we actually got at least one cut
     {
       tempFCA[0] /= numCuts;
@@ -161,9 +619,10 @@ namespace DFLib
         FCA_stddev[0] /= numCuts;
         FCA_stddev[1] /= numCuts;
         // FCA_stddev now has <tempFCA^2>.  Now compute 
-        // sqrt((<tempFCA^2>-<tempFCA>^2)), the standard deviation
-        FCA_stddev[0] = sqrt((FCA_stddev[0]-tempFCA[0]*tempFCA[0]));
-        FCA_stddev[1] = sqrt((FCA_stddev[1]-tempFCA[1]*tempFCA[1]));
+        // sqrt((<tempFCA^2>-<tempFCA>^2)), the standard deviation.
+        // Rounding can leave that a hair below zero when all cuts agree.
+        FCA_stddev[0] = sqrt(std::max(0.0,FCA_stddev[0]-tempFCA[0]*tempFCA[0]));
+        FCA_stddev[1] = sqrt(std::max(0.0,FCA_stddev[1]-tempFCA[1]*tempFCA[1]));
       }
       else
       {
@@ -177,17 +636,38 @@ namespace DFLib
     }
 
     FCA.setUserCoords(tempFCA);
-    delete tempPoint;
     return retval;
   }
 
 
+  void ReportCollection::computeAllFixes(DFLib::Abstract::Point &FCA,
+                                         DFLib::AllFixes &fixes,
+                                         double minAngle)
+  {
+    {
+      ScopedSnapshot scope(*this);
+      snapshot->computeAllFixes(fixes);
+    }
+
+    // The fix cut table is kept up to date from the report objects, not
+    // the snapshot
+    fixes.fixCutValid=computeFixCutAverage(FCA,fixes.fixCutStdDev,minAngle);
+    fixes.fixCutAverage=FCA.getUserCoords();
+  }
+
   /// \brief compute ML fix
   void ReportCollection::aggressiveComputeMLFix(DFLib::Abstract::Point &MLFix)
   {
 
-    DFLib::Util::Minimizer bogus(this);
     std::vector<double> NR_fix = MLFix.getXY();
+    if (snapshotValid)
+    {
+      snapshot->aggressiveComputeMLFix(NR_fix);
+      MLFix.setXY(NR_fix);
+      return;
+    }
+
+    DFLib::Util::Minimizer bogus(this);
     int j;
 
     // First do a quickie Nelder-Mead simplex minimize
@@ -231,24 +711,158 @@ namespace DFLib
   void ReportCollection::computeMLFix(DFLib::Abstract::Point &MLFix)
   {
 
-    DFLib::Util::Minimizer bogus(this);
     std::vector<double> NR_fix = MLFix.getXY();
+    if (snapshotValid)
+    {
+      snapshot->computeMLFix(NR_fix);
+      MLFix.setXY(NR_fix);
+      return;
+    }
+
+    DFLib::Util::Minimizer bogus(this);
     int j;
 
     double tempF=bogus.conjugateGradientMinimize(NR_fix,1e-5,j);
     MLFix.setXY(NR_fix);
   }
 
+  /// \brief compute ML fix by global grid search
+  int ReportCollection::globalComputeMLFix(DFLib::Abstract::Point &MLFix,
+                                           int coarseSize, int fineSize,
+                                           int numLevels, int numKeep,
+                                           double margin)
+  {
+    std::vector<double> NR_fix = MLFix.getXY();
+    int numEvals;
+    ScopedSnapshot scope(*this);
+
+    numEvals=snapshot->globalComputeMLFix(NR_fix,coarseSize,fineSize,
+                                         numLevels,numKeep,margin);
+
+    MLFix.setXY(NR_fix);
+    return numEvals;
+  }
+
+  /// \brief compute HPD confidence regions around a fix
+  void ReportCollection::computeConfidenceRegions
+  (DFLib::Abstract::Point &fix,
+   const std::vector<double> &probabilities,
+   std::vector<DFLib::ConfidenceRegion> &regions,
+   int gridSize)
+  {
+    std::vector<double> fixXY = fix.getXY();
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeConfidenceRegions(fixXY,probabilities,regions,gridSize);
+  }
+
+  void ReportCollection::computeBootstrap(DFLib::FixMethod method,
+                                          DFLib::Abstract::Point &fix,
+                                          int numReplicates,
+                                          DFLib::ResamplingEstimate &estimate,
+                                          uint64_t seed)
+  {
+    std::vector<double> fixXY = fix.getXY();
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeBootstrap(method,fixXY,numReplicates,estimate,seed);
+  }
+
+  void ReportCollection::computeJackknife(DFLib::FixMethod method,
+                                          DFLib::Abstract::Point &fix,
+                                          DFLib::ResamplingEstimate &estimate)
+  {
+    std::vector<double> fixXY = fix.getXY();
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeJackknife(method,fixXY,estimate);
+  }
+
+  void ReportCollection::computeFixDiagnostics(DFLib::Abstract::Point &fix,
+                                               DFLib::FixDiagnostics &diagnostics)
+  {
+    std::vector<double> fixXY = fix.getXY();
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeFixDiagnostics(fixXY,diagnostics);
+  }
+
+  void ReportCollection::computeLeaveOneOutLeastSquares(DFLib::LeaveOneOutFixes &fixes)
+  {
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeLeaveOneOutLeastSquares(fixes);
+  }
+
+  void ReportCollection::computeLeaveOneOutML(DFLib::Abstract::Point &MLFix,
+                                              DFLib::LeaveOneOutFixes &fixes)
+  {
+    std::vector<double> fixXY = MLFix.getXY();
+    ScopedSnapshot scope(*this);
+
+    snapshot->computeLeaveOneOutML(fixXY,fixes);
+  }
+
+  int ReportCollection::searchExclusions(int maxExcluded, int numBest,
+                                         std::vector<DFLib::ExclusionResult> &results,
+                                         double significance)
+  {
+    int numResults;
+    ScopedSnapshot scope(*this);
+
+    if (snapX.empty())
+      throw(Util::Exception("Exclusion search needs at least three valid reports"));
+    DFLib::ExclusionSearch search(snapX.size(),&snapX[0],&snapY[0],
+                                  &snapBearing[0],&snapSigma[0],
+                                  &snapValid[0]);
+    search.setSignificance(significance);
+    numResults=search.search(maxExcluded,numBest,results);
+    return numResults;
+  }
+
+  /// \brief compute weighted, bias-compensated pseudo-linear fix
+  void ReportCollection::computePseudoLinearFix(DFLib::Abstract::Point &PLFix,
+                         std::vector<std::vector<double> > &covariance,
+                         int numReweightings)
+  {
+    std::vector<double> fixXY;
+    ScopedSnapshot scope(*this);
+
+    snapshot->computePseudoLinearFix(fixXY,covariance,numReweightings);
+
+    PLFix.setXY(fixXY);
+  }
+
+  void ReportCollection::computePseudoLinearFix(DFLib::Abstract::Point &PLFix,
+                                                double &am2, double &bm2,
+                                                double &phi,
+                                                int numReweightings)
+  {
+    std::vector<double> fixXY;
+    ScopedSnapshot scope(*this);
+
+    snapshot->computePseudoLinearFix(fixXY,am2,bm2,phi,numReweightings);
+
+    PLFix.setXY(fixXY);
+  }
+
   /// \brief Compute Stansfield fix
   void ReportCollection::computeStansfieldFix(DFLib::Abstract::Point &SFix,
                                               double &am2, double &bm2,
                                               double &phi)
   {
     std::vector<double> initialFix = SFix.getXY();
+    if (snapshotValid)
+    {
+      snapshot->computeStansfieldFix(initialFix,am2,bm2,phi);
+      SFix.setXY(initialFix);
+      return;
+    }
+
     std::vector<double> distances;
     std::vector<double> sines;
     std::vector<double> cosines;
-    std::vector<double> sigmas;
+    std::vector<double> inverseVariances;
     std::vector<double> p;   // Stansfield's "p_i"
     std::vector<double> temp(2);
     std::vector<double> deltas(2);
@@ -267,7 +881,7 @@ namespace DFLib
     distances.reserve(theReports.size());
     cosines.reserve(theReports.size());
     sines.reserve(theReports.size());
-    sigmas.reserve(theReports.size());
+    inverseVariances.reserve(theReports.size());
     int i=0;
 
     // initialize
@@ -278,9 +892,9 @@ namespace DFLib
       if ((*iterReport)->isValid())
       {
         distances.push_back((*iterReport)->computeDistanceToPoint(initialFix));
-        cosines.push_back(cos((*iterReport)->getReportBearingRadians()));
-        sines.push_back(sin((*iterReport)->getReportBearingRadians()));
-        sigmas.push_back((*iterReport)->getBearingStandardDeviationRadians());
+        cosines.push_back((*iterReport)->getBearingCosine());
+        sines.push_back((*iterReport)->getBearingSine());
+        inverseVariances.push_back((*iterReport)->getBearingInverseVariance());
         temp=(*iterReport)->getReceiverLocation();
         // remember difference between Stansfield and DFLib convention
         // This is the perpendicular distance between the bearing line
@@ -299,29 +913,19 @@ namespace DFLib
     // we are now ready to iterate.
     do 
     {
-      mu=nu=lambda=0;
       lastNorm=currentNorm;
       // compute mu, nu, lambda
-      for (int i=0; i< p.size(); ++i)
-      {
-        double dsigma2=(distances[i]*distances[i]*sigmas[i]*sigmas[i]);
-        // again, sine and cosine opposite from Stansfield because of
-        // angular convention
-        mu += (sines[i]*sines[i])/dsigma2;
-        nu += (cosines[i]*sines[i])/dsigma2;
-        lambda += (cosines[i]*cosines[i])/dsigma2;
-      }
+      StansfieldTerms terms(distances,sines,cosines,inverseVariances,p);
+      double sums[3];
+      Util::deterministicSum<3>(p.size(),terms,sums);
+      mu=sums[0];
+      nu=sums[1];
+      lambda=sums[2];
       double denom=lambda*mu-nu*nu;
-      deltas[0]=0;
-      deltas[1]=0;
-      for (int i=0; i< p.size(); ++i)
-      {
-        double dsigma2=(distances[i]*distances[i]*sigmas[i]*sigmas[i]);
-        deltas[0] += p[i]*(nu*sines[i]-mu*cosines[i])/dsigma2;
-        deltas[1] += p[i]*(lambda*sines[i]-nu*cosines[i])/dsigma2;
-      }
-      deltas[0] /= denom;
-      deltas[1] /= denom;
+      terms.setStep(mu,nu,lambda);
+      Util::deterministicSum<2>(p.size(),terms,sums);
+      deltas[0]=sums[0]/denom;
+      deltas[1]=sums[1]/denom;
       currentNorm=sqrt(deltas[0]*deltas[0]+deltas[1]*deltas[1]);
 
       temp[0]=initialFix[0]+deltas[0];
@@ -369,29 +973,19 @@ namespace DFLib
     am2=0;
     bm2=0;
     std::vector<double> initialFix = MLFix.getXY();
-    std::vector<double> temp(2);
-    double lambda=0;
-    double mu=0;
-    double nu=0;
-    std::vector<DFLib::Abstract::Report *>::iterator iterReport;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
-    for (iterReport=theReports.begin(); iterReport!=reportEnd; ++iterReport)
+    if (snapshotValid)
     {
-      if ((*iterReport)->isValid())
-      {
-        temp=(*iterReport)->getReceiverLocation();
-        double dx=initialFix[0]-temp[0];
-        double dy=initialFix[1]-temp[1];
-        double sigma=(*iterReport)->getBearingStandardDeviationRadians();
-        double ds2=dx*dx+dy*dy;
-        double denom=sigma*sigma*ds2*ds2;
-
-        lambda += dy*dy/denom;
-        nu += dx*dy/denom;
-        mu += dx*dx/denom;
-      }
+      snapshot->computeCramerRaoBounds(initialFix,am2,bm2,phi);
+      return;
     }
 
+    double sums[3];
+    Util::deterministicSum<3>(theReports.size(),
+                              CramerRaoTerms(theReports,initialFix),sums);
+    double lambda=sums[0];
+    double nu=sums[1];
+    double mu=sums[2];
+
     phi=.5*atan2(-2*nu,lambda-mu);
     am2=(lambda-nu*tan(phi));
     bm2=(mu+nu*tan(phi));
@@ -403,35 +997,15 @@ namespace DFLib
 
   double ReportCollection::computeCostFunction(std::vector<double> &evaluationPoint)
   {
-    double f=0;
-    std::vector<DFLib::Abstract::Report *>::iterator iterReport;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
+    if (snapshotValid)
+      return (snapshot->computeCostFunction(evaluationPoint));
 
-    // Loop over all reports, sum up 
+    // Sum over all reports
     //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
-
-    for (iterReport=theReports.begin();
-         iterReport!=reportEnd;
-         ++iterReport)
-    {
-      if ((*iterReport)->isValid())
-      {
-        double bearing = (*iterReport)->getReportBearingRadians();
-        double bearing_to_point 
-          = (*iterReport)->computeBearingToPoint(evaluationPoint);
-        double sigma = (*iterReport)->getBearingStandardDeviationRadians();
-        double deltatheta=bearing_to_point - bearing;
-
-        // Make deltatheta in range -pi<deltatheta<=pi
-        while (deltatheta <= -M_PI)
-          deltatheta += 2*M_PI;
-        while (deltatheta > M_PI)
-          deltatheta -= 2*M_PI;
-
-        f += 1/(2*sigma*sigma)*(deltatheta)*
-          (deltatheta);
-      }
-    }
+    double f;
+    Util::deterministicSum<1>(theReports.size(),
+                              CostFunctionTerms(theReports,evaluationPoint,0),
+                              &f);
     return (f);
   }
 
@@ -444,48 +1018,23 @@ namespace DFLib
    std::vector<double> &gradient
    )
   {
-
-    std::vector<DFLib::Abstract::Report *>::iterator iterReport;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
-
-    f=0;
-    gradient.resize(2);
-    gradient[0]=gradient[1]=0;
-
-    // Loop over all reports, sum up 
-    //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
-
-    for (iterReport=theReports.begin();
-         iterReport!=reportEnd;
-         ++iterReport)
+    if (snapshotValid)
     {
-      if ((*iterReport)->isValid())
-      {
-        double bearing = (*iterReport)->getReportBearingRadians();
-        double bearing_to_point 
-          = (*iterReport)->computeBearingToPoint(evaluationPoint);
-        double sigma = (*iterReport)->getBearingStandardDeviationRadians();
-        double deltatheta;
-        double xr=
-          (*iterReport)->getReceiverLocation()[0]-evaluationPoint[0];
-        double yr=
-          (*iterReport)->getReceiverLocation()[1]-evaluationPoint[1];
-        double d=sqrt(xr*xr+yr*yr);
-        double c=cos(bearing_to_point);
-        double s=sin(bearing_to_point);
-        
-        deltatheta=(bearing-bearing_to_point);
-        // Make deltatheta in range -pi<deltatheta<=pi
-        while (deltatheta <= -M_PI)
-          deltatheta += 2*M_PI;
-        while (deltatheta > M_PI)
-          deltatheta -= 2*M_PI;
-
-        f += 1/(2*sigma*sigma)*(deltatheta*deltatheta);
-        gradient[0] += (deltatheta)/(sigma*sigma*d)*(-c);
-        gradient[1] += (deltatheta)/(sigma*sigma*d)*( s);
-      }
+      snapshot->computeCostFunctionAndGradient(evaluationPoint,f,gradient);
+      return;
     }
+
+    // Sum over all reports
+    //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
+    // and its gradient
+    double sums[3];
+    Util::deterministicSum<3>(theReports.size(),
+                              CostFunctionTerms(theReports,evaluationPoint,1),
+                              sums);
+    f=sums[0];
+    gradient.resize(2);
+    gradient[0]=sums[1];
+    gradient[1]=sums[2];
   }
 
   /// \brief compute cost function for point x,y its gradient, and its hessian.
@@ -496,93 +1045,58 @@ namespace DFLib
    double &f, std::vector<double> &gradient, std::vector<std::vector<double> > &hessian
    )
   {
+    if (snapshotValid)
+    {
+      snapshot->computeCostFunctionAndHessian(evaluationPoint,f,gradient,
+                                             hessian);
+      return;
+    }
 
-    std::vector<DFLib::Abstract::Report *>::iterator iterReport;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
-
-    f=0;
+    // Sum over all reports
+    //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
+    // and its gradient and Hessian
+    double sums[7];
+    Util::deterministicSum<7>(theReports.size(),
+                              CostFunctionTerms(theReports,evaluationPoint,2),
+                              sums);
+    f=sums[0];
     gradient.resize(2);
-    gradient[0]=gradient[1]=0;
+    gradient[0]=sums[1];
+    gradient[1]=sums[2];
     hessian.resize(2);
     hessian[0].resize(2);
     hessian[1].resize(2);
-    hessian[0][0]=hessian[0][1]=hessian[1][0]=hessian[1][1]=0.0;
-
-    // Loop over all reports, sum up 
-    //    (1/(2*sigma^2)*(measured_bearing-bearing_to_point)^2
-
-    for (iterReport=theReports.begin();
-         iterReport!=reportEnd;
-         ++iterReport)
-    {
-      if ((*iterReport)->isValid())
-      {
-        double bearing = (*iterReport)->getReportBearingRadians();
-        double bearing_to_point 
-          = (*iterReport)->computeBearingToPoint(evaluationPoint);
-        double sigma = (*iterReport)->getBearingStandardDeviationRadians();
-        double deltatheta=(bearing-bearing_to_point);
-        double xr=
-          (*iterReport)->getReceiverLocation()[0]-evaluationPoint[0];
-        double yr=
-          (*iterReport)->getReceiverLocation()[1]-evaluationPoint[1];
-        double d=sqrt(xr*xr+yr*yr);
-        double c=cos(bearing_to_point);
-        double s=sin(bearing_to_point);
-        double coef = (1/(sigma*sigma*d*d));
-        
-        deltatheta=(bearing-bearing_to_point);
-        // Make deltatheta in range -pi<deltatheta<=pi
-        while (deltatheta <= -M_PI)
-          deltatheta += 2*M_PI;
-        while (deltatheta > M_PI)
-          deltatheta -= 2*M_PI;
-        
-        f += 1/(2*sigma*sigma)*(deltatheta*deltatheta);
-        gradient[0] += (deltatheta)/(sigma*sigma*d)*(-c);
-        gradient[1] += (deltatheta)/(sigma*sigma*d)*( s);
-        
-        hessian[0][0] += coef*(c*c-s*c*deltatheta);
-        hessian[0][1] += coef*(-s*c-s*s*deltatheta);
-        hessian[1][0] += coef*(-s*c+c*c*deltatheta);
-        hessian[1][1] += coef*(s*s-c*s*deltatheta);
-      }
-    }
+    hessian[0][0]=sums[3];
+    hessian[0][1]=sums[4];
+    hessian[1][0]=sums[5];
+    hessian[1][1]=sums[6];
   }
 
   /// \brief compute least squares solution from all df reports.
   void ReportCollection::computeLeastSquaresFix(DFLib::Abstract::Point &LS_Fix)
   {
 
-    double atb1,atb2,a11,a12,a22;
-    atb1=atb2=a11=a12=a22=0.0;
     double det;
     std::vector <double> LS_point;
-    
-    std::vector<DFLib::Abstract::Report *>::iterator iterReport;
-    std::vector<DFLib::Abstract::Report *>::iterator reportEnd=theReports.end();
-    
-    LS_point.resize(2);
-    
-    for (iterReport=theReports.begin();iterReport!=reportEnd;++iterReport)
+
+    if (snapshotValid)
     {
-      if ((*iterReport)->isValid())
-      {
-        double bearing=(*iterReport)->getReportBearingRadians();
-        double c=cos(bearing);
-        double s=sin(bearing);
-        double rx=(*iterReport)->getReceiverLocation()[0];
-        double ry=(*iterReport)->getReceiverLocation()[1];
-        double b=rx*c-ry*s;
-	
-        atb1 += c*b;
-        atb2 += -s*b;
-        a11 += s*s;
-        a12 += s*c;
-        a22 += c*c;
-      }
+      snapshot->computeLeastSquaresFix(LS_point);
+      LS_Fix.setXY(LS_point);
+      return;
     }
     
+    LS_point.resize(2);
+
+    double sums[5];
+    Util::deterministicSum<5>(theReports.size(),LeastSquaresTerms(theReports),
+                              sums);
+    double atb1=sums[0];
+    double atb2=sums[1];
+    double a11=sums[2];
+    double a12=sums[3];
+    double a22=sums[4];
+    
     det = a11*a22-a12*a12;
     LS_point[0]=(a11*atb1+a12*atb2)/det;
     LS_point[1]=(a12*atb1+a22*atb2)/det;
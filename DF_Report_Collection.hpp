@@ -60,9 +60,18 @@
 #include "Util_Abstract_Group.hpp"
 #include "DF_Abstract_Report.hpp"
 #include "DF_Abstract_Point.hpp"
+#include "Util_Reduction.hpp"
 
 namespace DFLib
 {
+  class ArrayCollection;
+  struct ConfidenceRegion;
+  struct ResamplingEstimate;
+  struct FixDiagnostics;
+  struct LeaveOneOutFixes;
+  struct AllFixes;
+  struct ExclusionResult;
+
   class CPL_DLL ReportCollection : public DFLib::Abstract::Group
   {
   private: 
@@ -75,6 +84,52 @@ namespace DFLib
     std::vector<double> gradient;
     std::vector<std::vector<double> > hessian;
 
+    // Native copy of the report data, used by the fix methods in place
+    // of the report objects while snapshotValid is true.
+    bool snapshotValid;
+    std::vector<double> snapX;
+    std::vector<double> snapY;
+    std::vector<double> snapBearing;
+    std::vector<double> snapSigma;
+    std::vector<double> snapCosine;
+    std::vector<double> snapSine;
+    std::vector<double> snapInverseVariance;
+    std::vector<unsigned char> snapValid;
+    DFLib::ArrayCollection *snapshot;
+
+    // Fix cut table for computeFixCutAverage.  Row i holds the cuts of
+    // report i with reports 0 through i-1, for the first
+    // cutTable.size() reports, along with the data each report had when
+    // its cuts were computed.  Cuts are in the user coordinates of
+    // cutPoint, and the sums run over all good cuts.  cutProbeXY is a
+    // point whose user coordinates under cutPoint were cutProbeUV, for
+    // noticing when the caller switches coordinate systems.
+    struct FixCut
+    {
+      double u,v;      // user coordinates of the cut
+      double angle;    // cut angle, or -1 if the pair has no good cut
+    };
+    std::vector<std::vector<FixCut> > cutTable;
+    std::vector<double> cutReportX;
+    std::vector<double> cutReportY;
+    std::vector<double> cutReportBearing;
+    std::vector<unsigned char> cutReportValid;
+    DFLib::Abstract::Point *cutPoint;
+    std::vector<double> cutProbeXY;
+    std::vector<double> cutProbeUV;
+    int numGoodCuts;
+    Util::NeumaierSum cutSumU,cutSumV,cutSumU2,cutSumV2;
+    int cutChangesSinceRefresh;
+
+    void computeCut(int i, int j, FixCut &cut);
+    void addCutToSums(const FixCut &cut, double sign);
+    void refreshCutSums();
+    void recomputeCutRow(int r);
+    void appendCutRow();
+    void removeCutRow(int r);
+    void clearFixCuts();
+    void updateFixCuts(DFLib::Abstract::Point &FCA);
+
     // Declare the copy constructor and assignment operators, but
     // don't define them.  We should *never* copy a collection or attempt
     // to assign one to another.  This makes it illegal to do so.
@@ -101,6 +156,59 @@ namespace DFLib
     /// \return this report's number in the collection.
     virtual int addReport(DFLib::Abstract::Report * aReport);
 
+    /// \brief Remove a DF report from the collection
+    ///
+    /// The report is not deleted, since the collection does not own it.
+    /// Reports after the removed one move down one index.
+    ///
+    /// \param i index of the report to remove
+    /// \return pointer to the removed report, or 0 if i is out of range.
+    virtual DFLib::Abstract::Report * removeReport(int i);
+
+    /// \brief Make a new collection of some of this one's reports
+    ///
+    /// The new collection holds the same report objects, which neither
+    /// collection owns.  The caller must delete the new collection.
+    /// Indices out of range are ignored.
+    ///
+    /// \param reportIndices indices of the reports to put in it
+    ReportCollection *makeSubset(const std::vector<int> &reportIndices) const;
+
+    /// \brief Copy the data of all reports into native storage
+    ///
+    /// After this call, every fix method except computeFixCutAverage
+    /// works from the copied receiver locations, bearings, standard
+    /// deviations and validity flags, and the reports' cached bearing
+    /// cosines, sines and inverse variances, and never calls the
+    /// reports' methods.  This matters when the reports are implemented
+    /// in an interpreted language, where each call is expensive.
+    ///
+    /// Adding, removing or toggling reports through the collection
+    /// discards the snapshot.  If the caller changes a report object
+    /// directly, it must call invalidateSnapshot() or materialize()
+    /// again, or the fixes will use the old data.
+    void materialize();
+
+    /// \brief Snapshot only some of the reports
+    ///
+    /// Like materialize(), but the fix methods then see only the listed
+    /// reports, as if the others were not in the collection.  This is how
+    /// a large collection is limited to the reports near a region of
+    /// interest (see ReceiverIndex).  Indices out of range are ignored.
+    /// invalidateSnapshot() or materialize() goes back to all reports.
+    ///
+    /// computeFixCutAverage, numValidReports and the accessors of single
+    /// reports still see the whole collection.
+    ///
+    /// \param reportIndices indices of the reports to use
+    void materialize(const std::vector<int> &reportIndices);
+
+    /// \brief Discard the snapshot and go back to using the reports
+    inline void invalidateSnapshot() { snapshotValid=false; };
+
+    /// \brief true if fixes are currently computed from a snapshot
+    inline bool isMaterialized() const { return snapshotValid; };
+
     /// \brief return the fix cut average of this collection's reports
     ///
     /// A fix cut is the intersection of two DF reports.  The Fix Cut 
@@ -108,6 +216,16 @@ namespace DFLib
     /// in the collection.  Fix cuts at shallow angles can be excluded by 
     /// specifying a non-zero value for minAngle (in degrees).
     ///
+    /// The collection keeps every cut it has computed.  On each call,
+    /// only the cuts of reports added since the last call, and of
+    /// reports whose location, bearing or validity has changed, are
+    /// recomputed, which is O(N) per such report.  The mean and standard
+    /// deviation come from running sums, so with minAngle of 0 nothing
+    /// else is done; a non-zero minAngle is applied to the stored cut
+    /// angles in one pass over the table.  Changes to report objects
+    /// are found by comparing each report with what it was at the last
+    /// call, so unlike snapshots they need not be announced.
+    ///
     /// \param FCA Returned fix cut average
     /// \param FCA_stddev standard deviation of fix cuts <em>in user coordinates corresponding to the point provided in FCA</em>
     /// \param minAngle reports whose fix cut occur at less than this angle will not be included in the average.
@@ -115,6 +233,25 @@ namespace DFLib
                                       std::vector<double> &FCA_stddev,
                                       double minAngle=0);
 
+    /// \brief Every fix at once: least squares, fix cut average,
+    /// Stansfield and ML, with the Stansfield ellipse and the Cramer-Rao
+    /// bounds of the ML fix
+    ///
+    /// Gives the same answers as calling computeLeastSquaresFix,
+    /// computeFixCutAverage, computeStansfieldFix (from the least
+    /// squares fix), computeMLFix (likewise) and computeCramerRaoBounds
+    /// in turn, but reads the reports once and shares the trig between
+    /// the fixes that need it; see ArrayCollection::computeAllFixes.
+    /// Failures are reported in the valid flags of fixes rather than
+    /// thrown.
+    ///
+    /// \param FCA set to the fix cut average, whose user coordinates are
+    ///        also those of fixes.fixCutAverage and fixes.fixCutStdDev
+    /// \param fixes the fixes
+    /// \param minAngle as for computeFixCutAverage
+    void computeAllFixes(DFLib::Abstract::Point &FCA, DFLib::AllFixes &fixes,
+                         double minAngle=0);
+
     /*!
       \brief Computes least squares solution of DF problem.
        
@@ -377,6 +514,55 @@ namespace DFLib
     */
     void computeStansfieldFix(DFLib::Abstract::Point &SFix,double &am2, 
                               double &bm2, double &phi);
+
+    /*!
+      \brief Computes a weighted, bias-compensated pseudo-linear fix
+
+      Like computeLeastSquaresFix, this treats each bearing as a
+      straight line through its receiver,
+      \f$\cos\tilde{\theta}_i (x-x_i) - \sin\tilde{\theta}_i (y-y_i) = 0\f$,
+      and finds the point that best satisfies all of them.  Unlike it:
+
+      - Each line is weighted by \f$1/(d_i\sigma_i)^2\f$, as in
+        computeStansfieldFix, so that a line counts in proportion to how
+        well it actually locates the transmitter.  The distances
+        \f$d_i\f$ come from the previous pass; the first pass weights
+        by \f$1/\sigma_i^2\f$ alone.
+
+      - The least squares solution of the lines is biased, mostly toward
+        the receivers, because a bearing error moves both the line and
+        the coefficients used to solve for the point.  Each pass
+        estimates the bias to second order in the bearing errors, at the
+        previous pass's fix, and takes it out.  (The details are with
+        ArrayCollection::computePseudoLinearFix.)
+
+      - The lines are solved by a QR factorization built up by Givens
+        rotations, not through the normal equations.
+
+      The first pass plus numReweightings more are made, each a single
+      pass over the reports, so the cost is fixed and linear in the
+      number of reports.  There is no line search and no convergence
+      test.  The result is close to the ML fix when bearings are good
+      and the geometry is not badly conditioned, and makes a good
+      starting point for computeMLFix when they are not.
+
+      The error ellipse is that of the final weighted solve,
+      \f$(A^TWA)^{-1}\f$, in the same form as computeStansfieldFix.
+
+      The initial value of PLFix is not used.  Throws Util::Exception
+      with fewer than two valid reports or if all their bearings are
+      parallel.
+    */
+    void computePseudoLinearFix(DFLib::Abstract::Point &PLFix, double &am2,
+                                double &bm2, double &phi,
+                                int numReweightings=3);
+
+    /// \brief Pseudo-linear fix with its 2x2 XY covariance
+    ///
+    /// See the other computePseudoLinearFix.
+    void computePseudoLinearFix(DFLib::Abstract::Point &PLFix,
+                                std::vector<std::vector<double> > &covariance,
+                                int numReweightings=3);
     /*!
       \brief Computes Maximum Likelihood solution of DF problem
 
@@ -457,6 +643,127 @@ namespace DFLib
     */
     void aggressiveComputeMLFix(DFLib::Abstract::Point &MLFix);
 
+    /*! \brief ML fix by global coarse-to-fine grid search
+
+      This is the most robust way to get at an ML fix.  It does not use
+      the input value of MLFix as a starting guess at all, but searches
+      successively finer grids over the region around the receivers for
+      the best few candidates, and then polishes them with the same
+      conjugate gradient method as computeMLFix.  The number of cost
+      function evaluations in the grid search is fixed by the arguments.
+      See ArrayCollection::globalComputeMLFix for their meaning.
+
+      The search always runs on a snapshot of the reports.  If the
+      collection is not materialized, a temporary snapshot is made and
+      discarded afterwards.
+
+      \return number of grid cost function evaluations
+    */
+    int globalComputeMLFix(DFLib::Abstract::Point &MLFix,
+                           int coarseSize=64, int fineSize=16,
+                           int numLevels=4, int numKeep=4,
+                           double margin=5.0);
+
+    /*! \brief probability-mass confidence regions around a fix
+
+      Error ellipses (Cramer-Rao or Stansfield) assume the posterior
+      is Gaussian, which it is not when the receivers are few, close
+      together, or nearly in line with the transmitter.  This method
+      finds instead the highest posterior density region of the
+      normalized posterior \f$\exp(-\mbox{cost})\f$ for each requested
+      probability, by evaluating it on a grid around the fix.  Each
+      region comes back as XY boundary polygons with its area and the
+      cost function level that bounds it.  See
+      ArrayCollection::computeConfidenceRegions for details.
+
+      Like globalComputeMLFix, this always runs on a snapshot of the
+      reports, making a temporary one if the collection is not
+      materialized.
+    */
+    void computeConfidenceRegions(DFLib::Abstract::Point &fix,
+                                  const std::vector<double> &probabilities,
+                                  std::vector<DFLib::ConfidenceRegion> &regions,
+                                  int gridSize=201);
+
+    /*! \brief bootstrap estimate of the spread of a fix
+
+      The Stansfield and Cramer-Rao ellipses hold only for small,
+      Gaussian bearing errors.  This estimates the spread of a fix
+      empirically instead: the reports are resampled with replacement
+      numReplicates times, the fix is recomputed by the given method
+      for each resample, and the spread of the results is returned.
+      See ArrayCollection::computeBootstrap for details.
+
+      fix must be the fix of all the reports by the same method.  It is
+      where Stansfield and ML replicates start, and what the bias is
+      measured from.
+
+      Like globalComputeMLFix, this always runs on a snapshot of the
+      reports, making a temporary one if the collection is not
+      materialized.  Every replicate works from that one snapshot.
+    */
+    void computeBootstrap(DFLib::FixMethod method,
+                          DFLib::Abstract::Point &fix, int numReplicates,
+                          DFLib::ResamplingEstimate &estimate,
+                          uint64_t seed=1);
+
+    /*! \brief jackknife estimate of the spread of a fix
+
+      As computeBootstrap, but with one replicate per valid report,
+      leaving that report out.  See ArrayCollection::computeJackknife.
+    */
+    void computeJackknife(DFLib::FixMethod method,
+                          DFLib::Abstract::Point &fix,
+                          DFLib::ResamplingEstimate &estimate);
+
+    /*! \brief residuals, chi-square, conditioning and influence at a fix
+
+      Computes everything in DFLib::FixDiagnostics in one pass over the
+      reports.  The chi-square is twice the ML cost function and, at the
+      ML fix with correct bearing standard deviations, follows a
+      chi-square distribution with degreesOfFreedom degrees of freedom,
+      which makes it a test of the fit.  Reports with large normalized
+      residuals or Cook's distances are the ones to look at first.
+
+      Runs on a snapshot of the reports, making a temporary one if the
+      collection is not materialized.
+    */
+    void computeFixDiagnostics(DFLib::Abstract::Point &fix,
+                               DFLib::FixDiagnostics &diagnostics);
+
+    /*! \brief least squares fix with each report left out in turn
+
+      Finds which reports a bad least squares fix owes the most to, in
+      time proportional to the number of reports, instead of toggling
+      each report's validity and refitting.  See
+      ArrayCollection::computeLeaveOneOutLeastSquares.  Fixes are in XY.
+    */
+    void computeLeaveOneOutLeastSquares(DFLib::LeaveOneOutFixes &fixes);
+
+    /*! \brief approximate ML fix with each report left out in turn
+
+      See ArrayCollection::computeLeaveOneOutML.  Fixes are in XY.
+    */
+    void computeLeaveOneOutML(DFLib::Abstract::Point &MLFix,
+                              DFLib::LeaveOneOutFixes &fixes);
+
+    /*! \brief find the fewest reports to leave out to make the rest
+      consistent
+
+      Tries leaving out up to maxExcluded reports at once, and returns
+      up to numBest sets of them, best first.  See
+      DFLib::ExclusionSearch for what is searched and how.  Report
+      indices are positions in this collection, and fixes are in XY.
+
+      Runs on a snapshot of the reports, making a temporary one if the
+      collection is not materialized.
+
+      \return number of results
+    */
+    int searchExclusions(int maxExcluded, int numBest,
+                         std::vector<DFLib::ExclusionResult> &results,
+                         double significance=0.05);
+
     /*! \brief compute Cramer-Rao bounding ellipse parameters
 
       This function returns the inverse squares and rotation angle for
@@ -545,7 +852,10 @@ namespace DFLib
     inline virtual void toggleValidity(int i)
     {
       if (i<theReports.size()&&i>=0)
+      {
         theReports[i]->toggleValidity();
+        snapshotValid=false;
+      }
     };
 
     inline bool isValid(int i) const
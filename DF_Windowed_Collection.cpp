@@ -0,0 +1,250 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Time-windowed report collection
+//
+// Special Notes  : Subtracting a report's terms from the running least
+//                  squares sums does not give back exactly the sums
+//                  without it, so after as many removals as there are
+//                  slots in the ring, the sums are recomputed from
+//                  scratch.  That keeps rounding error from building up
+//                  at an amortized cost of O(1) per report.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include "DF_Windowed_Collection.hpp"
+#include "Util_Misc.hpp"
+
+namespace DFLib
+{
+  WindowedCollection::WindowedCollection(double theWindowLength,
+                                         int initialCapacity)
+    : windowLength(theWindowLength),
+      capacity((initialCapacity>0)?initialCapacity:1),
+      oldest(0),
+      count(0),
+      xs(capacity,0.0),
+      ys(capacity,0.0),
+      bearings(capacity,0.0),
+      sigmas(capacity,1.0),
+      cosines(capacity,1.0),
+      sines(capacity,0.0),
+      inverseVariances(capacity,1.0),
+      times(capacity,0.0),
+      valids(capacity,0),
+      window(0,0,0,0,0),
+      atb1(0),atb2(0),a11(0),a12(0),a22(0),
+      numValid(0),
+      removalsSinceRefresh(0)
+  {
+    setWindowArrays();
+  }
+
+  /// \brief point the window's ArrayCollection at the ring
+  ///
+  /// Needed whenever the contents change, so no cached cost function
+  /// value is reused.  The ring's own cosines, sines and inverse
+  /// variances are passed along, so this takes constant time.
+  void WindowedCollection::setWindowArrays()
+  {
+    window.setArrays(capacity,&xs[0],&ys[0],&bearings[0],&sigmas[0],
+                     &cosines[0],&sines[0],&inverseVariances[0],
+                     &valids[0]);
+  }
+
+  /// \brief add (sign=1) or remove (sign=-1) a slot's least squares terms
+  ///
+  /// Same terms as ArrayCollection::computeLeastSquaresFix
+  void WindowedCollection::addToSums(int slot, double sign)
+  {
+    double c=cosines[slot];
+    double s=sines[slot];
+    double b=xs[slot]*c-ys[slot]*s;
+
+    atb1 += sign*c*b;
+    atb2 += sign*(-s*b);
+    a11 += sign*s*s;
+    a12 += sign*s*c;
+    a22 += sign*c*c;
+  }
+
+  void WindowedCollection::refreshSums()
+  {
+    atb1=atb2=a11=a12=a22=0.0;
+    for (int k=0; k<count; ++k)
+    {
+      int slot=(oldest+k)%capacity;
+      if (valids[slot])
+        addToSums(slot,1.0);
+    }
+    removalsSinceRefresh=0;
+  }
+
+  /// \brief double the ring, unwrapping it so the oldest is in slot 0
+  void WindowedCollection::grow()
+  {
+    int newCapacity=2*capacity;
+    std::vector<double> newXs(newCapacity,0.0);
+    std::vector<double> newYs(newCapacity,0.0);
+    std::vector<double> newBearings(newCapacity,0.0);
+    std::vector<double> newSigmas(newCapacity,1.0);
+    std::vector<double> newCosines(newCapacity,1.0);
+    std::vector<double> newSines(newCapacity,0.0);
+    std::vector<double> newInverseVariances(newCapacity,1.0);
+    std::vector<double> newTimes(newCapacity,0.0);
+    std::vector<unsigned char> newValids(newCapacity,0);
+    for (int k=0; k<count; ++k)
+    {
+      int slot=(oldest+k)%capacity;
+      newXs[k]=xs[slot];
+      newYs[k]=ys[slot];
+      newBearings[k]=bearings[slot];
+      newSigmas[k]=sigmas[slot];
+      newCosines[k]=cosines[slot];
+      newSines[k]=sines[slot];
+      newInverseVariances[k]=inverseVariances[slot];
+      newTimes[k]=times[slot];
+      newValids[k]=valids[slot];
+    }
+    xs.swap(newXs);
+    ys.swap(newYs);
+    bearings.swap(newBearings);
+    sigmas.swap(newSigmas);
+    cosines.swap(newCosines);
+    sines.swap(newSines);
+    inverseVariances.swap(newInverseVariances);
+    times.swap(newTimes);
+    valids.swap(newValids);
+    capacity=newCapacity;
+    oldest=0;
+    setWindowArrays();
+  }
+
+  void WindowedCollection::removeOldest()
+  {
+    if (valids[oldest])
+    {
+      addToSums(oldest,-1.0);
+      --numValid;
+      valids[oldest]=0;
+    }
+    oldest=(oldest+1)%capacity;
+    --count;
+    if (++removalsSinceRefresh >= capacity)
+      refreshSums();
+  }
+
+  void WindowedCollection::addReport(DFLib::Abstract::Report *report)
+  {
+    const std::vector<double> &receiver=report->getReceiverLocation();
+    addReport(report->getReportTime(),receiver[0],receiver[1],
+              report->getReportBearingRadians(),
+              report->getBearingStandardDeviationRadians(),
+              report->isValid());
+  }
+
+  void WindowedCollection::addReport(double t, double x, double y,
+                                     double bearing, double sigma,
+                                     bool valid)
+  {
+    expire(t);
+    if (count==capacity)
+      grow();
+
+    int slot=(oldest+count)%capacity;
+    xs[slot]=x;
+    ys[slot]=y;
+    bearings[slot]=bearing;
+    sigmas[slot]=sigma;
+    cosines[slot]=cos(bearing);
+    sines[slot]=sin(bearing);
+    inverseVariances[slot]=1/(sigma*sigma);
+    times[slot]=t;
+    valids[slot]=valid?1:0;
+    ++count;
+    if (valid)
+    {
+      addToSums(slot,1.0);
+      ++numValid;
+    }
+
+    // contents changed, so no cached cost function value may be reused
+    setWindowArrays();
+  }
+
+  int WindowedCollection::expire(double now)
+  {
+    int numExpired=0;
+    while (count>0 && times[oldest] < now-windowLength)
+    {
+      removeOldest();
+      ++numExpired;
+    }
+    if (numExpired>0)
+      setWindowArrays();
+    return numExpired;
+  }
+
+  void WindowedCollection::clear()
+  {
+    while (count>0)
+      removeOldest();
+    refreshSums();
+    setWindowArrays();
+  }
+
+  double WindowedCollection::getOldestTime() const
+  {
+    if (count==0)
+      throw(Util::Exception("getOldestTime called on an empty window"));
+    return times[oldest];
+  }
+
+  double WindowedCollection::getNewestTime() const
+  {
+    if (count==0)
+      throw(Util::Exception("getNewestTime called on an empty window"));
+    return times[(oldest+count-1)%capacity];
+  }
+
+  void WindowedCollection::computeLeastSquaresFix(std::vector<double> &LS_Fix)
+  {
+    double det = a11*a22-a12*a12;
+    LS_Fix.resize(2);
+    LS_Fix[0]=(a11*atb1+a12*atb2)/det;
+    LS_Fix[1]=(a12*atb1+a22*atb2)/det;
+  }
+}
@@ -0,0 +1,194 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Keep only the reports of the last so many seconds, and
+//                  compute fixes from them, without rebuilding anything
+//                  as the window slides.
+//
+// Special Notes  : Report data are copied into a ring buffer of plain
+//                  arrays, oldest first.  Expiring a report just moves
+//                  the start of the ring, and the fix methods run on an
+//                  ArrayCollection that looks at the ring in place.
+//
+//                  The sums that the least squares fix is made of are
+//                  kept up to date as reports come and go, so the least
+//                  squares fix costs the same no matter how many reports
+//                  are in the window.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef DF_WINDOWED_COLLECTION_HPP
+#define DF_WINDOWED_COLLECTION_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+#include "DF_Abstract_Report.hpp"
+#include "DF_Array_Collection.hpp"
+
+namespace DFLib
+{
+  /// \brief Reports of the last windowLength seconds, and fixes from them
+  ///
+  /// Reports are added with their times (see
+  /// Abstract::Report::getReportTime), normally in time order.  Adding a
+  /// report expires every report more than windowLength seconds older
+  /// than it, and expire() may be called at any time to slide the window
+  /// up to the present.  A report that arrives late is kept until every
+  /// report added before it has expired.
+  ///
+  /// Unlike ReportCollection, the collection keeps copies of the report
+  /// data, not the report objects, so callers may delete reports as soon
+  /// as they are added.
+  class CPL_DLL WindowedCollection
+  {
+  private:
+    double windowLength;
+    int capacity;
+    int oldest;
+    int count;
+    std::vector<double> xs;
+    std::vector<double> ys;
+    std::vector<double> bearings;
+    std::vector<double> sigmas;
+    // cosines and sines of the bearings, and 1/sigma^2, kept with the
+    // reports so the window never recomputes them
+    std::vector<double> cosines;
+    std::vector<double> sines;
+    std::vector<double> inverseVariances;
+    std::vector<double> times;
+    std::vector<unsigned char> valids;
+    DFLib::ArrayCollection window;
+
+    // Least squares normal equations, summed over valid reports
+    double atb1,atb2,a11,a12,a22;
+    int numValid;
+    int removalsSinceRefresh;
+
+    void addToSums(int slot, double sign);
+    void refreshSums();
+    void grow();
+    void removeOldest();
+    void setWindowArrays();
+
+    // Never copied, like the other collections
+    WindowedCollection(WindowedCollection &right);
+    WindowedCollection &operator=(WindowedCollection &right);
+
+  public:
+    /// \brief Make an empty window
+    ///
+    /// \param theWindowLength how long reports are kept, in seconds
+    /// \param initialCapacity room for this many reports before the
+    ///        ring has to grow
+    WindowedCollection(double theWindowLength, int initialCapacity=64);
+
+    /// \brief Add a report's data at its report time
+    ///
+    /// Reports that are not valid are kept, but are not used in fixes.
+    void addReport(DFLib::Abstract::Report *report);
+
+    /// \brief Add one bearing
+    ///
+    /// \param t time of the bearing
+    /// \param x receiver x coordinate
+    /// \param y receiver y coordinate
+    /// \param bearing bearing in radians clockwise from north
+    /// \param sigma bearing standard deviation in radians
+    /// \param valid whether to use this bearing in fixes
+    void addReport(double t, double x, double y, double bearing,
+                   double sigma, bool valid=true);
+
+    /// \brief Drop all reports older than now-windowLength
+    /// \return number of reports dropped
+    int expire(double now);
+
+    /// \brief Drop all reports
+    void clear();
+
+    inline double getWindowLength() const { return windowLength; };
+    /// \brief Change the window length
+    ///
+    /// A shorter window takes effect at the next expire or addReport.
+    inline void setWindowLength(double theWindowLength)
+    { windowLength=theWindowLength; };
+
+    /// \return number of reports in the window, valid or not
+    inline int size() const { return count; };
+    /// \return number of valid reports in the window
+    inline int numValidReports() const { return numValid; };
+
+    /// \return time of the oldest report in the window
+    double getOldestTime() const;
+    /// \return time of the newest report in the window
+    double getNewestTime() const;
+
+    /// \brief Least squares fix of the window, from the running sums
+    void computeLeastSquaresFix(std::vector<double> &LS_Fix);
+
+    /// \brief ML fix of the window.  See ArrayCollection::computeMLFix
+    inline void computeMLFix(std::vector<double> &MLFix)
+    { window.computeMLFix(MLFix); };
+
+    /// \brief See ArrayCollection::aggressiveComputeMLFix
+    inline void aggressiveComputeMLFix(std::vector<double> &MLFix)
+    { window.aggressiveComputeMLFix(MLFix); };
+
+    /// \brief See ArrayCollection::globalComputeMLFix
+    inline int globalComputeMLFix(std::vector<double> &MLFix)
+    { return window.globalComputeMLFix(MLFix); };
+
+    /// \brief Stansfield fix of the window.
+    ///
+    /// Stansfield's weights depend on the distance from the fix to each
+    /// receiver, so this iterates over the reports in the window as
+    /// ArrayCollection::computeStansfieldFix does.
+    inline void computeStansfieldFix(std::vector<double> &SFix, double &am2,
+                                     double &bm2, double &phi)
+    { window.computeStansfieldFix(SFix,am2,bm2,phi); };
+
+    /// \brief See ArrayCollection::computePseudoLinearFix
+    inline void computePseudoLinearFix(std::vector<double> &PLFix,
+                                       double &am2, double &bm2, double &phi,
+                                       int numReweightings=3)
+    { window.computePseudoLinearFix(PLFix,am2,bm2,phi,numReweightings); };
+
+    /// \brief See ArrayCollection::computeCramerRaoBounds
+    inline void computeCramerRaoBounds(const std::vector<double> &MLFix,
+                                       double &am2, double &bm2, double &phi)
+    { window.computeCramerRaoBounds(MLFix,am2,bm2,phi); };
+
+    /// \brief The window as an ArrayCollection, for anything else
+    ///
+    /// Good only until the next report is added or expired.
+    inline DFLib::ArrayCollection &getArrayCollection() { return window; };
+  };
+}
+#endif // DF_WINDOWED_COLLECTION_HPP
@@ -65,6 +65,8 @@ namespace DFLib
     private:
       Point receiverLocation;            
       double bearing,sigma;
+      // unit bearing vector and 1/sigma^2, kept up to date by the setters
+      double cosBearing,sinBearing,inverseVariance;
     public:
       Report(const std::vector<double> &theLocation, 
                      const double &bearing,const double &std_dev,
@@ -75,6 +77,9 @@ namespace DFLib
       virtual  double getBearing() const;
       virtual  double getBearingStandardDeviationRadians() const;
       virtual  double getSigma() const;
+      virtual  double getBearingCosine() const;
+      virtual  double getBearingSine() const;
+      virtual  double getBearingInverseVariance() const;
       virtual  void  setReceiverLocation(std::vector<double> &theLocation);
       //! set bearing in degrees
       virtual  void  setBearing(double Bearing);
@@ -105,7 +110,9 @@ namespace DFLib
     while (bearing >= 2*M_PI)
       bearing -= 2*M_PI;
 
-
+    cosBearing=cos(bearing);
+    sinBearing=sin(bearing);
+    inverseVariance=1/(sigma*sigma);
   }        
 
   inline DFLib::XY::Report::~Report()
@@ -132,6 +139,19 @@ namespace DFLib
     return sigma*180/M_PI;
   }
 
+  inline double DFLib::XY::Report::getBearingCosine() const
+  {
+    return cosBearing;
+  }
+  inline double DFLib::XY::Report::getBearingSine() const
+  {
+    return sinBearing;
+  }
+  inline double DFLib::XY::Report::getBearingInverseVariance() const
+  {
+    return inverseVariance;
+  }
+
   inline void DFLib::XY::Report::setReceiverLocation(std::vector<double> &theLocation)
   {
     receiverLocation.setXY(theLocation);
@@ -150,10 +170,13 @@ namespace DFLib
       bearing += 2*M_PI;
     while (bearing >= 2*M_PI)
       bearing -= 2*M_PI;
+    cosBearing=cos(bearing);
+    sinBearing=sin(bearing);
   }
   inline void DFLib::XY::Report::setSigma(double Sigma)
   {
     sigma=Sigma*M_PI/180;
+    inverseVariance=1/(sigma*sigma);
   }
 }
 #endif // DF_XY_REPORT_HPP
@@ -0,0 +1,207 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of report time stamps and the EKF tracker.
+//
+// Special Notes  : The track test follows a simulated transmitter driving
+//                  past three receivers, with noisy bearings from a fixed
+//                  seed, so it is reproducible.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_EKF_Tracker.hpp"
+#include "gaussian_random.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::vector<double> xyVals(2,0.0);
+  DFLib::XY::Report aReport(xyVals,45,2,"aReport");
+
+  std::cout << " New report time is " << aReport.getReportTime();
+  if (aReport.getReportTime() == 0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  aReport.setReportTime(12.5);
+  DFLib::XY::Report copiedReport(aReport);
+  std::cout << " Set time 12.5, copy has time " << copiedReport.getReportTime();
+  if (copiedReport.getReportTime() == 12.5)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Ellipse in, same ellipse out.  The axes may come back swapped (a
+  // along the other axis, phi off by 90 degrees), so compare the
+  // covariance each describes.
+  DFLib::EKFTracker tracker(0.01);
+  tracker.initialize(xyVals,1/(300.0*300.0),1/(100.0*100.0),0.5,10,0);
+  double am2,bm2,phi;
+  tracker.getPositionEllipse(0,am2,bm2,phi);
+  double pxx=cos(phi)*cos(phi)/am2+sin(phi)*sin(phi)/bm2;
+  double pyy=sin(phi)*sin(phi)/am2+cos(phi)*cos(phi)/bm2;
+  double pxy=(1/am2-1/bm2)*cos(phi)*sin(phi);
+  double expectedPxx=cos(.5)*cos(.5)*90000+sin(.5)*sin(.5)*10000;
+  double expectedPyy=sin(.5)*sin(.5)*90000+cos(.5)*cos(.5)*10000;
+  double expectedPxy=80000*cos(.5)*sin(.5);
+  std::cout << " Initial ellipse a=" << sqrt(1/am2) << " b=" << sqrt(1/bm2)
+            << " phi=" << phi;
+  if (fabs(pxx-expectedPxx)<1e-6 && fabs(pyy-expectedPyy)<1e-6
+      && fabs(pxy-expectedPxy)<1e-6)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Transmitter starts at (0,0) and drives northeast at (8,6) m/s for
+  // 500 s, past receivers 3 to 5 km away.  Each second one receiver
+  // reports, in turn, with 2 degree bearing errors.
+  double receiverX[3]={-3000,4000,2000};
+  double receiverY[3]={1000,-2000,4000};
+  double vx=8;
+  double vy=6;
+  double sigmaDeg=2;
+  DFLib::Util::gaussian_random_generator noise(0,sigmaDeg,20091001,0);
+
+  std::vector<double> start(2);
+  start[0]=150;
+  start[1]=-200;
+  tracker.initialize(start,300,5,0);
+  int numUsed=0;
+  for (int k=1; k<=500; ++k)
+  {
+    double t=k;
+    int r=k%3;
+    std::vector<double> receiver(2);
+    receiver[0]=receiverX[r];
+    receiver[1]=receiverY[r];
+    std::vector<double> transmitter(2);
+    transmitter[0]=vx*t;
+    transmitter[1]=vy*t;
+    DFLib::XY::Report report(receiver,0,sigmaDeg,"report");
+    double bearing=report.computeBearingToPoint(transmitter)*180/M_PI;
+    report.setBearing(bearing+noise.getRandom());
+    report.setReportTime(t);
+    if (tracker.update(&report))
+      ++numUsed;
+  }
+
+  std::cout << " Tracker used " << numUsed << " of 500 reports";
+  if (numUsed == 500)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::vector<double> position,velocity;
+  tracker.getState(500,position,velocity);
+  double positionError=sqrt((position[0]-4000)*(position[0]-4000)
+                            +(position[1]-3000)*(position[1]-3000));
+  std::cout << " Final position (" << position[0] << "," << position[1]
+            << "), error " << positionError << " m";
+  if (positionError < 100)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  double velocityError=sqrt((velocity[0]-vx)*(velocity[0]-vx)
+                            +(velocity[1]-vy)*(velocity[1]-vy));
+  std::cout << " Final velocity (" << velocity[0] << "," << velocity[1]
+            << "), error " << velocityError << " m/s";
+  if (velocityError < 1)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Querying ahead is a pure prediction
+  std::vector<double> later,laterVelocity;
+  tracker.getState(510,later,laterVelocity);
+  std::cout << " Predicted 10 s ahead: (" << later[0] << "," << later[1] << ")";
+  if (fabs(later[0]-(position[0]+10*velocity[0]))<1e-9
+      && fabs(later[1]-(position[1]+10*velocity[1]))<1e-9
+      && tracker.getStateTime()==500)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Stale and wild reports are refused
+  std::vector<double> receiver(2);
+  receiver[0]=receiverX[0];
+  receiver[1]=receiverY[0];
+  DFLib::XY::Report staleReport(receiver,90,sigmaDeg,"stale");
+  staleReport.setReportTime(400);
+  tracker.setGate(5);
+  DFLib::XY::Report wildReport(receiver,
+                               staleReport.computeBearingToPoint(position)
+                               *180/M_PI+90,
+                               sigmaDeg,"wild");
+  wildReport.setReportTime(501);
+  std::cout << " Stale and gated reports refused";
+  if (!tracker.update(&staleReport) && !tracker.update(&wildReport))
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
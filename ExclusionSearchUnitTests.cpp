@@ -0,0 +1,247 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the search for reports to exclude.
+//
+// Special Notes  : Thirty reports, three of them bad.  The search must
+//                  find the three, and every smaller set of exclusions
+//                  must really be inconsistent, which is checked by
+//                  brute force.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "DF_Exclusion_Search.hpp"
+#include "Util_Misc.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+/// chi-square probability of the Stansfield fix of the reports left
+/// after excluding some
+static double probabilityWithout(int n, double *rx, double *ry,
+                                 double *bearing, double *sigmas,
+                                 const std::vector<int> &excluded)
+{
+  std::vector<unsigned char> mask(n,1);
+  for (int k=0; k<excluded.size(); ++k)
+    mask[excluded[k]]=0;
+  DFLib::ArrayCollection rest(n,rx,ry,bearing,sigmas,&mask[0]);
+  std::vector<double> fix;
+  double am2,bm2,phi;
+  rest.computeLeastSquaresFix(fix);
+  rest.computeStansfieldFix(fix,am2,bm2,phi);
+  return DFLib::chiSquareUpperTail(2*rest.computeCostFunction(fix),
+                                   n-excluded.size()-2);
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  // Known values of the chi-square tail
+  double q1=DFLib::chiSquareUpperTail(3.841459,1);
+  double q2=DFLib::chiSquareUpperTail(2.0,2);
+  double q10=DFLib::chiSquareUpperTail(18.307038,10);
+  double q40=DFLib::chiSquareUpperTail(20.0,40);
+  std::cout << " Chi-square tails " << q1 << " " << q2 << " " << q10
+            << " " << q40;
+  if (fabs(q1-0.05)<1e-6 && fabs(q2-exp(-1.0))<1e-12
+      && fabs(q10-0.05)<1e-6 && fabs(q40-0.9965457)<1e-7)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  const int n=30;
+  const double sigma=2*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  double tx=1500;
+  double ty=500;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,11);
+  spiralReceivers(n,10000,150,-3.0,0.2,rx,ry);
+  for (int i=0; i<n; ++i)
+    sigmas[i]=sigma;
+  noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+
+  // Good data need nothing excluded
+  DFLib::ExclusionSearch clean(n,rx,ry,bearing,sigmas);
+  std::vector<DFLib::ExclusionResult> results;
+  clean.search(3,5,results);
+  std::cout << " Clean reports: " << results[0].excluded.size()
+            << " excluded, chi-square " << results[0].chiSquare << " on "
+            << results[0].degreesOfFreedom << " degrees of freedom, "
+            << clean.getNumEvaluated() << " subsets evaluated";
+  if (results.size()==1 && results[0].excluded.empty()
+      && results[0].consistent && clean.getNumEvaluated()==2)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Three bad bearings
+  bearing[4] += 15*M_PI/180;
+  bearing[17] -= 20*M_PI/180;
+  bearing[23] += 12*M_PI/180;
+  DFLib::ExclusionSearch search(n,rx,ry,bearing,sigmas);
+  search.search(3,5,results);
+  int exhaustive=2*(1+n+n*(n-1)/2+n*(n-1)*(n-2)/6);
+  std::cout << " Excluded";
+  for (int k=0; k<results[0].excluded.size(); ++k)
+    std::cout << " " << results[0].excluded[k];
+  std::cout << ", probability " << results[0].probability << ", "
+            << search.getNumEvaluated() << " subsets evaluated of "
+            << exhaustive;
+  if (results[0].consistent && results[0].excluded.size()==3
+      && results[0].excluded[0]==4 && results[0].excluded[1]==17
+      && results[0].excluded[2]==23
+      && search.getNumEvaluated()<exhaustive/4)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // No set of two or fewer exclusions is consistent, by brute force
+  double bestProbability=probabilityWithout(n,rx,ry,bearing,sigmas,
+                                            std::vector<int>());
+  std::vector<int> excluded;
+  for (int i=0; i<n; ++i)
+  {
+    excluded.assign(1,i);
+    bestProbability=std::max(bestProbability,
+                             probabilityWithout(n,rx,ry,bearing,sigmas,
+                                                excluded));
+    for (int j=i+1; j<n; ++j)
+    {
+      excluded.assign(1,i);
+      excluded.push_back(j);
+      bestProbability=std::max(bestProbability,
+                               probabilityWithout(n,rx,ry,bearing,sigmas,
+                                                  excluded));
+    }
+  }
+  std::cout << " Best probability with two or fewer excluded "
+            << bestProbability;
+  if (bestProbability<0.05)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The report collection gives the same answer, with any number of
+  // threads, and without staying materialized
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(loc,bearing[i]*180/M_PI,
+                                     sigmas[i]*180/M_PI,"r");
+    rColl.addReport(reports[i]);
+  }
+  std::vector<DFLib::ExclusionResult> fromReports;
+#ifdef _OPENMP
+  int oldThreads=omp_get_max_threads();
+  omp_set_num_threads(3);
+#endif
+  rColl.searchExclusions(3,5,fromReports);
+#ifdef _OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+  bool same=(fromReports.size()==results.size());
+  for (int k=0; same && k<results.size(); ++k)
+    same=(fromReports[k].excluded==results[k].excluded
+          && fabs(fromReports[k].fix[0]-results[k].fix[0])<1e-6
+          && fabs(fromReports[k].fix[1]-results[k].fix[1])<1e-6);
+  std::cout << " Collection and array results";
+  if (same && !rColl.isMaterialized())
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // A search that fails must not leave its temporary snapshot behind,
+  // and one the caller made must outlast a search
+  std::vector<int> firstTwo(2);
+  firstTwo[0]=0;
+  firstTwo[1]=1;
+  DFLib::ReportCollection *tooFew=rColl.makeSubset(firstTwo);
+  bool threw=false;
+  try
+  {
+    tooFew->searchExclusions(1,1,fromReports);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    threw=true;
+  }
+  bool leftMaterialized=tooFew->isMaterialized();
+  delete tooFew;
+  rColl.materialize();
+  rColl.searchExclusions(3,5,fromReports);
+  std::cout << " Temporary snapshots discarded, caller's kept";
+  if (threw && !leftMaterialized && rColl.isMaterialized())
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
@@ -0,0 +1,135 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the angle arithmetic in Util_Fast_Math.hpp
+//
+// Special Notes  : The bounded versions are tested whichever precision
+//                  DFLib was built with.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "Util_Fast_Math.hpp"
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+
+/// \brief what the while loops used to compute
+double loopWrap(double a)
+{
+  while (a <= -M_PI)
+    a += 2*M_PI;
+  while (a > M_PI)
+    a -= 2*M_PI;
+  return a;
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::cout << " atan2Bounded within 1e-6 radians";
+  double maxError=0;
+  for (int i=0; i<=100000; ++i)
+  {
+    double a=-M_PI+i*(2*M_PI/100000);
+    double r=pow(10.0,(i%13)-6);
+    double y=r*sin(a);
+    double x=r*cos(a);
+    double e=fabs(DFLib::Util::atan2Bounded(y,x)-atan2(y,x));
+    // +pi and -pi are the same direction
+    if (e>M_PI)
+      e=fabs(e-2*M_PI);
+    if (e>maxError)
+      maxError=e;
+  }
+  if (maxError<1e-6 && DFLib::Util::atan2Bounded(0,0)==0
+      && DFLib::Util::atan2Bounded(1,0)==M_PI/2
+      && DFLib::Util::atan2Bounded(0,-1)==M_PI)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED (" << maxError << ")" << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " wrapAngle same as the loops";
+  bool ok=true;
+  for (int i=-3000; i<=3000; ++i)
+  {
+    double a=i*(3*M_PI/3000)*0.9999;
+    if (DFLib::Util::wrapAngle(a)!=loopWrap(a))
+      ok=false;
+  }
+  ok = ok && DFLib::Util::wrapAngle(M_PI)==M_PI
+    && DFLib::Util::wrapAngle(-M_PI)==M_PI
+    && DFLib::Util::wrapBearing(-M_PI/2)==1.5*M_PI
+    && DFLib::Util::wrapBearing(2*M_PI)==0;
+  if (ok)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Bearings to points all around a report";
+  std::vector<double> loc(2);
+  loc[0]=100;
+  loc[1]=-200;
+  DFLib::XY::Report report(loc,10,2,"r");
+  std::vector<double> p(2);
+  ok=true;
+  for (int i=0; i<360; ++i)
+  {
+    double b=i*M_PI/180+0.001;
+    p[0]=loc[0]+1000*sin(b);
+    p[1]=loc[1]+1000*cos(b);
+    double computed=report.computeBearingToPoint(p);
+    if (!(computed>=0 && computed<2*M_PI && fabs(computed-b)<1e-6))
+      ok=false;
+  }
+  if (ok)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
@@ -0,0 +1,241 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the fix cut table behind computeFixCutAverage.
+//
+// Special Notes  : After each change to the reports, the cut average of
+//                  the collection, which updates its table, must match
+//                  the cut average computed from scratch, pair by pair.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "Util_Timer.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+/// \brief a point whose user coordinates are kilometers
+class KmPoint : public DFLib::Abstract::Point
+{
+private:
+  std::vector<double> xy;
+  std::vector<double> km;
+public:
+  KmPoint() : xy(2,0.0), km(2,0.0) {};
+  virtual void setXY(const std::vector<double> &aPosition)
+  {
+    xy=aPosition;
+    km[0]=xy[0]/1000;
+    km[1]=xy[1]/1000;
+  };
+  virtual const std::vector<double> &getXY() { return xy; };
+  virtual const std::vector<double> &getUserCoords() { return km; };
+  virtual void setUserCoords(const std::vector<double> &uPosition)
+  {
+    km=uPosition;
+    xy[0]=km[0]*1000;
+    xy[1]=km[1]*1000;
+  };
+  virtual Point *Clone() { return new KmPoint(*this); };
+};
+
+/// \brief fix cut average from scratch, as it was always computed
+bool referenceAverage(DFLib::ReportCollection &rColl,
+                      DFLib::Abstract::Point &prototype, double minAngle,
+                      std::vector<double> &mean, std::vector<double> &stddev)
+{
+  DFLib::Abstract::Point *cutPoint=prototype.Clone();
+  int numCuts=0;
+  mean.assign(2,0.0);
+  stddev.assign(2,0.0);
+  for (int i=0; i<rColl.size(); ++i)
+  {
+    for (int j=i+1; j<rColl.size(); ++j)
+    {
+      DFLib::Abstract::Report *ri=
+        const_cast<DFLib::Abstract::Report *>(rColl.getReport(i));
+      DFLib::Abstract::Report *rj=
+        const_cast<DFLib::Abstract::Report *>(rColl.getReport(j));
+      if (!ri->isValid() || !rj->isValid())
+        continue;
+      double cutAngle;
+      DFLib::FixStatus fs;
+      ri->computeFixCut(rj,*cutPoint,cutAngle,fs);
+      if (fs==DFLib::GOOD_FIX && fabs(cutAngle) >= minAngle*M_PI/180.0)
+      {
+        const std::vector<double> &uv=cutPoint->getUserCoords();
+        ++numCuts;
+        mean[0] += uv[0];
+        mean[1] += uv[1];
+        stddev[0] += uv[0]*uv[0];
+        stddev[1] += uv[1]*uv[1];
+      }
+    }
+  }
+  delete cutPoint;
+  if (numCuts==0)
+    return false;
+  for (int k=0; k<2; ++k)
+  {
+    mean[k] /= numCuts;
+    stddev[k] = sqrt(std::max(0.0,stddev[k]/numCuts-mean[k]*mean[k]));
+  }
+  return true;
+}
+
+/// \brief compare the collection's cut average with the reference
+int check(const std::string &what, DFLib::ReportCollection &rColl,
+          DFLib::Abstract::Point &point, double minAngle=0)
+{
+  std::vector<double> stddev,refMean,refStddev;
+  rColl.computeFixCutAverage(point,stddev,minAngle);
+  std::vector<double> mean=point.getUserCoords();
+  referenceAverage(rColl,point,minAngle,refMean,refStddev);
+
+  double worst=0;
+  for (int k=0; k<2; ++k)
+  {
+    worst=std::max(worst,fabs(mean[k]-refMean[k])/(1+fabs(refMean[k])));
+    worst=std::max(worst,fabs(stddev[k]-refStddev[k])/(1+refStddev[k]));
+  }
+  std::cout << " " << what << ": (" << mean[0] << "," << mean[1]
+            << ") +/- (" << stddev[0] << "," << stddev[1] << ")";
+  if (worst < 1e-9)
+  {
+    std::cout << " PASSED " << std::endl;
+    return 0;
+  }
+  std::cout << " FAILED (reference (" << refMean[0] << "," << refMean[1]
+            << ") +/- (" << refStddev[0] << "," << refStddev[1] << "))"
+            << std::endl;
+  return 1;
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  DFLib::Util::gaussian_random_generator noise(0,2,20091001,9);
+  std::vector<DFLib::XY::Report *> reports;
+  DFLib::ReportCollection rColl;
+  std::vector<double> origin(2,0.0);
+  DFLib::XY::Point fca(origin);
+
+  const double tx=1500;
+  const double ty=2500;
+  double rx[400],ry[400];
+  spiralReceivers(65,20000,100,0,2.4,rx,ry);
+  for (int i=0; i<65; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    double bearing=bearingTo(rx[i],ry[i],tx,ty)*180/M_PI+noise.getRandom();
+    reports.push_back(new DFLib::XY::Report(loc,bearing,2,"r"));
+  }
+  for (int i=0; i<60; ++i)
+    rColl.addReport(reports[i]);
+
+  numFailed += check("Initial reports",rColl,fca);
+  for (int i=60; i<65; ++i)
+    rColl.addReport(reports[i]);
+  numFailed += check("Reports added",rColl,fca);
+
+  rColl.removeReport(30);
+  rColl.removeReport(10);
+  numFailed += check("Reports removed",rColl,fca);
+
+  reports[7]->setBearing(reports[7]->getBearing()+20);
+  std::vector<double> moved(2,-30000.0);
+  reports[50]->setReceiverLocation(moved);
+  numFailed += check("Report re-beared and moved",rColl,fca);
+
+  rColl.toggleValidity(3);
+  rColl.toggleValidity(40);
+  numFailed += check("Reports made invalid",rColl,fca);
+  numFailed += check("Cuts of at least 60 degrees",rColl,fca,60);
+  rColl.toggleValidity(40);
+  numFailed += check("Report made valid again",rColl,fca);
+
+  KmPoint km;
+  numFailed += check("Kilometer user coordinates",rColl,km);
+  numFailed += check("Back to XY",rColl,fca);
+
+  // Many reports in, one re-beared at a time, refixed each time
+  DFLib::ReportCollection big;
+  spiralReceivers(400,20000,50,0,2.4,rx,ry);
+  for (int i=0; i<400; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    double bearing=bearingTo(rx[i],ry[i],tx,ty)*180/M_PI+noise.getRandom();
+    reports.push_back(new DFLib::XY::Report(loc,bearing,2,"r"));
+    big.addReport(reports.back());
+  }
+  std::vector<double> stddev;
+  double t0=DFLib::Util::wallClockSeconds();
+  big.computeFixCutAverage(fca,stddev);
+  double tFull=DFLib::Util::wallClockSeconds()-t0;
+  const int numRefixes=50;
+  t0=DFLib::Util::wallClockSeconds();
+  for (int k=0; k<numRefixes; ++k)
+  {
+    DFLib::XY::Report *r=reports[65+(k*37)%400];
+    r->setBearing(r->getBearing()+0.5);
+    big.computeFixCutAverage(fca,stddev);
+  }
+  double tRefix=(DFLib::Util::wallClockSeconds()-t0)/numRefixes;
+  std::cout << " 400 reports: all cuts " << tFull*1000 << " ms, refix after "
+            << "one bearing changes " << tRefix*1000 << " ms";
+  if (tRefix < 0.1*tFull)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+  numFailed += check("400 reports after refixes",big,fca);
+
+  for (int i=0; i<reports.size(); ++i)
+    delete reports[i];
+  return numFailed;
+}
@@ -0,0 +1,230 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the fix diagnostics.
+//
+// Special Notes  : The residuals, chi-square and gradient are checked
+//                  against the cost function, the Hessian against finite
+//                  differences of the gradient, and the influence
+//                  measures against a deliberately bad report.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+static void check(bool passed, int &numFailed)
+{
+  if (passed)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  const int n=12;
+  const double sigma=2*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  unsigned char valid[n];
+  double tx=800;
+  double ty=-1500;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,3);
+  spiralReceivers(n,8000,500,-2.0,0.4,rx,ry);
+  for (int i=0; i<n; ++i)
+  {
+    sigmas[i]=sigma*(1+0.1*i);
+    valid[i]=(i!=5);
+  }
+  noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+  // Report 3 is off by 20 degrees
+  bearing[3] += 20*M_PI/180;
+
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas,valid);
+  std::vector<double> fix;
+  collection.computeLeastSquaresFix(fix);
+  collection.computeMLFix(fix);
+
+  DFLib::FixDiagnostics diag;
+  collection.computeFixDiagnostics(fix,diag);
+
+  // Residuals and chi-square against the cost function
+  double worstResidual=0;
+  for (int i=0; i<n; ++i)
+  {
+    double expected=0;
+    if (valid[i])
+    {
+      expected=bearing[i]-atan2(fix[0]-rx[i],fix[1]-ry[i]);
+      while (expected <= -M_PI)
+        expected += 2*M_PI;
+      while (expected > M_PI)
+        expected -= 2*M_PI;
+    }
+    worstResidual=std::max(worstResidual,fabs(diag.residuals[i]-expected));
+  }
+  double cost=collection.computeCostFunction(fix);
+  // expected is from libm; a fast angle build is good to 1e-6 radians
+#ifdef DFLIB_FAST_ANGLES
+  double residualTolerance=1e-6;
+#else
+  double residualTolerance=1e-12;
+#endif
+  std::cout << " Residuals off by at most " << worstResidual
+            << ", chi-square " << diag.chiSquare << " vs twice the cost "
+            << 2*cost << " with " << diag.degreesOfFreedom
+            << " degrees of freedom";
+  check(worstResidual<residualTolerance && fabs(diag.chiSquare-2*cost)<1e-9*cost
+        && diag.degreesOfFreedom==n-3, numFailed);
+
+  // Gradient against the cost function's own, and the Hessian against
+  // central differences of it, away from the minimum so the residual
+  // terms matter
+  std::vector<double> point(2);
+  point[0]=fix[0]+300;
+  point[1]=fix[1]-200;
+  DFLib::FixDiagnostics away;
+  collection.computeFixDiagnostics(point,away);
+  double f;
+  std::vector<double> grad;
+  collection.computeCostFunctionAndGradient(point,f,grad);
+  double gradError=std::max(fabs(away.gradient[0]-grad[0]),
+                            fabs(away.gradient[1]-grad[1]));
+  double h=1.0;
+  double worstHessian=0;
+  double largestHessian=0;
+  for (int j=0; j<2; ++j)
+  {
+    std::vector<double> plus(point),minus(point),gPlus,gMinus;
+    plus[j] += h;
+    minus[j] -= h;
+    collection.computeCostFunctionAndGradient(plus,f,gPlus);
+    collection.computeCostFunctionAndGradient(minus,f,gMinus);
+    for (int k=0; k<2; ++k)
+    {
+      double fd=(gPlus[k]-gMinus[k])/(2*h);
+      worstHessian=std::max(worstHessian,fabs(away.hessian[k][j]-fd));
+      largestHessian=std::max(largestHessian,fabs(fd));
+    }
+  }
+  std::cout << " Gradient off by " << gradError << ", Hessian off by "
+            << worstHessian << " of " << largestHessian;
+  check(gradError<1e-9*fabs(grad[0])+1e-15
+        && worstHessian<1e-4*largestHessian, numFailed);
+
+  // At the ML fix: zero gradient, positive definite Hessian, leverages
+  // adding up to 2, and the bad report standing out
+  double sumLeverage=0;
+  int mostInfluential=0;
+  int largestResidual=0;
+  for (int i=0; i<n; ++i)
+  {
+    sumLeverage += diag.leverages[i];
+    if (diag.cooksDistances[i]>diag.cooksDistances[mostInfluential])
+      mostInfluential=i;
+    if (fabs(diag.normalizedResiduals[i])
+        >fabs(diag.normalizedResiduals[largestResidual]))
+      largestResidual=i;
+  }
+  double gradNorm=sqrt(diag.gradient[0]*diag.gradient[0]
+                       +diag.gradient[1]*diag.gradient[1]);
+  std::cout << " At the fix: |gradient| " << gradNorm << ", Hessian eigenvalues "
+            << diag.hessianEigenvalues[0] << " " << diag.hessianEigenvalues[1]
+            << ", leverages sum to " << sumLeverage;
+  // a Newton step from the fix must be well under a meter
+  check(diag.hessianEigenvalues[0]>0
+        && gradNorm<0.01*diag.hessianEigenvalues[0] && fabs(sumLeverage-2)<1e-12
+        && diag.leverages[5]==0, numFailed);
+  std::cout << " Largest residual and Cook's distance at reports "
+            << largestResidual << " and " << mostInfluential;
+  check(largestResidual==3 && mostInfluential==3, numFailed);
+
+  // Parallel bearings give no least squares fix
+  double px[3]={0,100,200};
+  double py[3]={0,0,0};
+  double pb[3]={0.3,0.3,0.3};
+  double ps[3]={sigma,sigma,sigma};
+  DFLib::ArrayCollection parallel(3,px,py,pb,ps);
+  DFLib::FixDiagnostics parallelDiag;
+  parallel.computeFixDiagnostics(fix,parallelDiag);
+  double wellPosed=diag.leastSquaresConditionNumber;
+  std::cout << " Least squares condition numbers " << wellPosed
+            << " and " << parallelDiag.leastSquaresConditionNumber;
+  check(wellPosed>1 && wellPosed<100
+        && parallelDiag.leastSquaresConditionNumber>1e12, numFailed);
+
+  // The report collection gives the same answers without staying
+  // materialized
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(loc,bearing[i]*180/M_PI,
+                                     sigmas[i]*180/M_PI,"r");
+    if (!valid[i])
+      reports[i]->setInvalid();
+    rColl.addReport(reports[i]);
+  }
+  DFLib::XY::Point fixPoint(fix);
+  DFLib::FixDiagnostics fromReports;
+  rColl.computeFixDiagnostics(fixPoint,fromReports);
+  double worst=fabs(fromReports.chiSquare-diag.chiSquare);
+  for (int i=0; i<n; ++i)
+    worst=std::max(worst,fabs(fromReports.cooksDistances[i]
+                              -diag.cooksDistances[i]));
+  std::cout << " Largest difference between collection and array diagnostics "
+            << worst;
+  check(worst<1e-9 && !rColl.isMaterialized(), numFailed);
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
@@ -36,16 +36,18 @@
 //
 // Current Owner  : $Author$
 //-------------------------------------------------------------------------
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <limits>
 
 #include "DF_LatLon_Point.hpp"
 
-main(int argc, char **argv)
+int main(int argc, char **argv)
 {
+  int numFailed=0;
 
-  double dtol=10*sqrt(numeric_limits<double>::epsilon());
+  double dtol=10*sqrt(std::numeric_limits<double>::epsilon());
   std::vector<double> xyVals(2);
   xyVals[0]=-106.482;
   xyVals[1]=35.0913;
@@ -62,7 +64,10 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
 
   xyVals = myFirstPoint.getXY();
   xyVals[0] += 200;
@@ -80,6 +85,7 @@ main(int argc, char **argv)
   else
   {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
     std::cout << "       storedX=" << xyStored[0] << " Should be " << xyVals[0]
          << std::endl;
     std::cout << "       storedY=" << xyStored[1] << " Should be " << xyVals[1]
@@ -103,6 +109,7 @@ main(int argc, char **argv)
   else
   {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
     std::cout << "       storedX=" << xyStored[0] << " Should be " << xyVals[0]
          << " difference " << xyStored[0]-xyVals[0] << std::endl;
     std::cout << "       storedY=" << xyStored[1] << " Should be " << xyVals[1]
@@ -123,10 +130,14 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
 
   xyStored = mySecondPointPtr->getLL();
   std::cout << " Retrieved LL from modified, cloned point.  Lon = " << xyStored[0]
        << " Lat = " << xyStored[1] << std::endl;
     
+  return numFailed;
 }
@@ -0,0 +1,212 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the leave-one-out fixes.
+//
+// Special Notes  : The downdated least squares fixes must match refitting
+//                  with each report switched off, and the one-step ML
+//                  fixes must come close to full refits and put the same
+//                  report first.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <limits>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  const int n=25;
+  const double sigma=2*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  unsigned char valid[n];
+  double tx=-700;
+  double ty=1200;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,5);
+  spiralReceivers(n,6000,200,-3.0,0.25,rx,ry);
+  for (int i=0; i<n; ++i)
+  {
+    sigmas[i]=sigma;
+    valid[i]=(i!=4);
+  }
+  noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+  // Report 11 is off by 25 degrees
+  bearing[11] += 25*M_PI/180;
+
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas,valid);
+  std::vector<double> lsFix;
+  collection.computeLeastSquaresFix(lsFix);
+
+  // Least squares: exact against refits with each report switched off
+  DFLib::LeaveOneOutFixes lsOut;
+  collection.computeLeaveOneOutLeastSquares(lsOut);
+  double worst=0;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> refit(lsFix);
+    if (valid[i])
+    {
+      valid[i]=0;
+      collection.setArrays(n,rx,ry,bearing,sigmas,valid);
+      collection.computeLeastSquaresFix(refit);
+      valid[i]=1;
+    }
+    worst=std::max(worst,fabs(lsOut.x[i]-refit[0]));
+    worst=std::max(worst,fabs(lsOut.y[i]-refit[1]));
+  }
+  collection.setArrays(n,rx,ry,bearing,sigmas,valid);
+  std::cout << " Largest difference between downdated and refit least"
+            << " squares fixes " << worst << " m, worst offender "
+            << lsOut.ranking[0];
+  if (worst < 1e-6 && lsOut.ranking[0]==11 && lsOut.shifts[4]==0
+      && lsOut.ranking[n-1]==4)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // ML: one Newton step against full refits
+  std::vector<double> mlFix(lsFix);
+  collection.computeMLFix(mlFix);
+  DFLib::LeaveOneOutFixes mlOut;
+  collection.computeLeaveOneOutML(mlFix,mlOut);
+  double worstRelative=0;
+  int refitWorst=0;
+  double refitWorstShift=0;
+  for (int i=0; i<n; ++i)
+  {
+    if (!valid[i])
+      continue;
+    std::vector<double> refit(mlFix);
+    valid[i]=0;
+    collection.setArrays(n,rx,ry,bearing,sigmas,valid);
+    collection.computeMLFix(refit);
+    valid[i]=1;
+    double shift=sqrt((refit[0]-mlFix[0])*(refit[0]-mlFix[0])
+                      +(refit[1]-mlFix[1])*(refit[1]-mlFix[1]));
+    double miss=sqrt((refit[0]-mlOut.x[i])*(refit[0]-mlOut.x[i])
+                     +(refit[1]-mlOut.y[i])*(refit[1]-mlOut.y[i]));
+    worstRelative=std::max(worstRelative,miss/std::max(shift,1.0));
+    if (shift>refitWorstShift)
+    {
+      refitWorstShift=shift;
+      refitWorst=i;
+    }
+  }
+  collection.setArrays(n,rx,ry,bearing,sigmas,valid);
+  std::cout << " One-step ML fixes off by at most " << worstRelative
+            << " of the shift, worst offenders " << mlOut.ranking[0]
+            << " and " << refitWorst;
+  if (worstRelative < 0.2 && mlOut.ranking[0]==refitWorst
+      && refitWorst==11)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Of two parallel bearings and a crossing one, the crossing one cannot
+  // be done without
+  double px[3]={0,1000,500};
+  double py[3]={0,0,-2000};
+  double pb[3]={0.2,0.2,0.0};
+  double ps[3]={sigma,sigma,sigma};
+  DFLib::ArrayCollection three(3,px,py,pb,ps);
+  DFLib::LeaveOneOutFixes threeOut;
+  three.computeLeaveOneOutLeastSquares(threeOut);
+  std::cout << " Shifts without each of three reports " << threeOut.shifts[0]
+            << " " << threeOut.shifts[1] << " " << threeOut.shifts[2];
+  if (threeOut.shifts[2]==std::numeric_limits<double>::infinity()
+      && threeOut.x[2]!=threeOut.x[2] && threeOut.ranking[0]==2
+      && threeOut.shifts[0]<1e30 && threeOut.shifts[1]<1e30)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The report collection gives the same answers without staying
+  // materialized
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(loc,bearing[i]*180/M_PI,
+                                     sigmas[i]*180/M_PI,"r");
+    if (!valid[i])
+      reports[i]->setInvalid();
+    rColl.addReport(reports[i]);
+  }
+  DFLib::XY::Point mlPoint(mlFix);
+  DFLib::LeaveOneOutFixes fromReportsLS,fromReportsML;
+  rColl.computeLeaveOneOutLeastSquares(fromReportsLS);
+  rColl.computeLeaveOneOutML(mlPoint,fromReportsML);
+  worst=0;
+  for (int i=0; i<n; ++i)
+  {
+    worst=std::max(worst,fabs(fromReportsLS.shifts[i]-lsOut.shifts[i]));
+    worst=std::max(worst,fabs(fromReportsML.shifts[i]-mlOut.shifts[i]));
+  }
+  std::cout << " Largest difference between collection and array shifts "
+            << worst << " m";
+  if (worst < 1e-6 && !rColl.isMaterialized())
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
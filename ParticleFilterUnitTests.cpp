@@ -0,0 +1,173 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the particle filter localizer.
+//
+// Special Notes  : Reports are streamed into the filter one at a time,
+//                  and the resulting posterior is compared with the ML
+//                  fix and Cramer-Rao bounds of the same reports.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_Array_Collection.hpp"
+#include "DF_Particle_Filter.hpp"
+#include "gaussian_random.hpp"
+#include "Util_Timer.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  // Five receivers around a transmitter at (1000,2000), two reports
+  // each, 3 degree errors.
+  const int numReports=10;
+  double rx[numReports],ry[numReports],bearing[numReports],sigma[numReports];
+  double receiverX[5]={-4000,5000,3000,-2000,6000};
+  double receiverY[5]={-3000,-1000,7000,6000,4000};
+  DFLib::Util::gaussian_random_generator noise(0,3*M_PI/180,20091001,1);
+  for (int k=0; k<numReports; ++k)
+  {
+    rx[k]=receiverX[k%5];
+    ry[k]=receiverY[k%5];
+    sigma[k]=3*M_PI/180;
+    bearing[k]=atan2(1000-rx[k],2000-ry[k])+noise.getRandom();
+    if (bearing[k]<0)
+      bearing[k] += 2*M_PI;
+  }
+
+  DFLib::ArrayCollection collection(numReports,rx,ry,bearing,sigma);
+  std::vector<double> MLFix;
+  collection.computeLeastSquaresFix(MLFix);
+  collection.computeMLFix(MLFix);
+  double am2,bm2,phi;
+  collection.computeCramerRaoBounds(MLFix,am2,bm2,phi);
+  double crbScale=sqrt(1/std::min(am2,bm2));
+  std::cout << " ML fix (" << MLFix[0] << "," << MLFix[1]
+            << "), largest CRB semi-axis " << crbScale << std::endl;
+
+  const int numParticles=200000;
+  DFLib::ParticleFilter filter(numParticles,12);
+  filter.initializeAroundReceivers(5,receiverX,receiverY);
+  double start=DFLib::Util::wallClockSeconds();
+  for (int k=0; k<numReports; ++k)
+    filter.update(rx[k],ry[k],bearing[k],sigma[k]);
+  double elapsed=DFLib::Util::wallClockSeconds()-start;
+  std::cout << " " << numReports << " updates of " << numParticles
+            << " particles took " << elapsed << " s, with "
+            << filter.getNumResamples() << " resamplings" << std::endl;
+
+  std::vector<double> mean;
+  std::vector<std::vector<double> > covariance;
+  filter.getMean(mean,covariance);
+  double meanError=sqrt((mean[0]-MLFix[0])*(mean[0]-MLFix[0])
+                        +(mean[1]-MLFix[1])*(mean[1]-MLFix[1]));
+  std::cout << " Particle mean (" << mean[0] << "," << mean[1]
+            << ") is " << meanError << " from the ML fix";
+  if (meanError < crbScale)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Posterior spread should be on the order of the Cramer-Rao bound
+  double spread=sqrt(covariance[0][0]+covariance[1][1]);
+  double crbSpread=sqrt(1/am2+1/bm2);
+  std::cout << " Particle spread " << spread << ", CRB spread " << crbSpread;
+  if (spread > 0.5*crbSpread && spread < 2*crbSpread)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::vector<double> best;
+  filter.getBestParticle(best);
+  double bestError=sqrt((best[0]-MLFix[0])*(best[0]-MLFix[0])
+                        +(best[1]-MLFix[1])*(best[1]-MLFix[1]));
+  std::cout << " Best particle (" << best[0] << "," << best[1]
+            << ") is " << bestError << " from the ML fix";
+  if (bestError < crbScale)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // All at once gives the same posterior as one at a time, up to
+  // sampling noise.
+  DFLib::ParticleFilter batchFilter(numParticles,12);
+  batchFilter.initializeAroundReceivers(5,receiverX,receiverY);
+  batchFilter.update(numReports,rx,ry,bearing,sigma);
+  std::vector<double> batchMean;
+  batchFilter.getMean(batchMean,covariance);
+  double batchError=sqrt((batchMean[0]-mean[0])*(batchMean[0]-mean[0])
+                         +(batchMean[1]-mean[1])*(batchMean[1]-mean[1]));
+  std::cout << " Batch update mean (" << batchMean[0] << "," << batchMean[1]
+            << ") is " << batchError << " from streamed mean";
+  if (batchError < 0.25*crbScale)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Same seed, same answer
+  DFLib::ParticleFilter repeatFilter(numParticles,12);
+  repeatFilter.initializeAroundReceivers(5,receiverX,receiverY);
+  for (int k=0; k<numReports; ++k)
+    repeatFilter.update(rx[k],ry[k],bearing[k],sigma[k]);
+  std::vector<double> repeatMean;
+  repeatFilter.getMean(repeatMean,covariance);
+  std::cout << " Repeated run mean (" << repeatMean[0] << ","
+            << repeatMean[1] << ")";
+  if (fabs(repeatMean[0]-mean[0]) < 1e-6*fabs(mean[0])+1e-6
+      && fabs(repeatMean[1]-mean[1]) < 1e-6*fabs(mean[1])+1e-6)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
@@ -36,6 +36,7 @@
 //
 // Current Owner  : $Author$
 //-------------------------------------------------------------------------
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <limits>
@@ -43,10 +44,11 @@
 #include "Util_Misc.hpp"
 #include "DF_Proj_Point.hpp"
 
-main(int argc, char **argv)
+int main(int argc, char **argv)
 {
+  int numFailed=0;
 
-  double dtol=10*sqrt(numeric_limits<double>::epsilon());
+  double dtol=10*sqrt(std::numeric_limits<double>::epsilon());
   std::vector<double> xyVals(2);
   xyVals[0]=-106.482;
   xyVals[1]=35.0913;
@@ -71,7 +73,10 @@ main(int argc, char **argv)
     if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
       std::cout << " PASSED " << std::endl;
     else
+    {
       std::cout << " FAILED " << std::endl;
+      ++numFailed;
+    }
 
     xyVals = myFirstPoint.getXY();
     xyVals[0] += 200;
@@ -89,6 +94,7 @@ main(int argc, char **argv)
     else
     {
       std::cout << " FAILED " << std::endl;
+      ++numFailed;
       std::cout << "       storedX=" << xyStored[0] << " Should be " << xyVals[0]
            << std::endl;
       std::cout << "       storedY=" << xyStored[1] << " Should be " << xyVals[1]
@@ -112,6 +118,7 @@ main(int argc, char **argv)
     else
     {
       std::cout << " FAILED " << std::endl;
+      ++numFailed;
       std::cout << "       storedX=" << xyStored[0] << " Should be " << xyVals[0]
            << " difference " << xyStored[0]-xyVals[0] << std::endl;
       std::cout << "       storedY=" << xyStored[1] << " Should be " << xyVals[1]
@@ -132,7 +139,10 @@ main(int argc, char **argv)
     if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
       std::cout << " PASSED " << std::endl;
     else
+    {
       std::cout << " FAILED " << std::endl;
+      ++numFailed;
+    }
 
     xyStored = mySecondPointPtr->getUserCoords();
     std::cout << " Retrieved LL from modified, cloned point.  Lon = " << xyStored[0]
@@ -142,6 +152,8 @@ main(int argc, char **argv)
   {
     std::cerr << "Ooops... got exception creating myFirstPoint" 
          << x.getEmsg() << std::endl;
+    ++numFailed;
   }
     
+  return numFailed;
 }
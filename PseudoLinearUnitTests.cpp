@@ -0,0 +1,191 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the bias-compensated pseudo-linear fix.
+//
+// Special Notes  : Six receivers on an arc south of a transmitter report
+//                  it with 2 degree errors, many times over.  The plain
+//                  least squares fix falls measurably short of the
+//                  transmitter on average; the pseudo-linear fix must
+//                  not, and must scatter about as little as the ML fix.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  const int n=6;
+  const int numTrials=1000;
+  const double sigma=2*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  // An arc 20 km south of the origin, looking north at a far transmitter
+  spiralReceivers(n,20000,0,M_PI+1.25,-0.5,rx,ry);
+  for (int i=0; i<n; ++i)
+    sigmas[i]=sigma;
+  double tx=2000;
+  double ty=30000;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,9);
+
+  double biasLS[2]={0,0};
+  double biasPL[2]={0,0};
+  double sumSqPL=0;
+  double sumSqML=0;
+  double sumTrace=0;
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas);
+  for (int t=0; t<numTrials; ++t)
+  {
+    noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+    collection.setArrays(n,rx,ry,bearing,sigmas);
+
+    std::vector<double> LS,PL,ML;
+    std::vector<std::vector<double> > covariance;
+    collection.computeLeastSquaresFix(LS);
+    collection.computePseudoLinearFix(PL,covariance);
+    ML=PL;
+    collection.computeMLFix(ML);
+
+    biasLS[0] += (LS[0]-tx)/numTrials;
+    biasLS[1] += (LS[1]-ty)/numTrials;
+    biasPL[0] += (PL[0]-tx)/numTrials;
+    biasPL[1] += (PL[1]-ty)/numTrials;
+    sumSqPL += (PL[0]-tx)*(PL[0]-tx)+(PL[1]-ty)*(PL[1]-ty);
+    sumSqML += (ML[0]-tx)*(ML[0]-tx)+(ML[1]-ty)*(ML[1]-ty);
+    sumTrace += covariance[0][0]+covariance[1][1];
+  }
+  double rmsPL=sqrt(sumSqPL/numTrials);
+  double rmsML=sqrt(sumSqML/numTrials);
+  double predicted=sqrt(sumTrace/numTrials);
+  double sizeLS=hypot(biasLS[0],biasLS[1]);
+  double sizePL=hypot(biasPL[0],biasPL[1]);
+
+  std::cout << " Mean pseudo-linear error " << sizePL
+            << " m, least squares " << sizeLS << " m";
+  if (sizePL < 0.5*sizeLS)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " RMS error pseudo-linear " << rmsPL << " m, ML "
+            << rmsML << " m";
+  if (rmsPL < 1.05*rmsML)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " RMS error predicted by the covariance " << predicted
+            << " m";
+  if (fabs(predicted-rmsPL) < 0.15*rmsPL)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The report collection gives the same fix and ellipse as the arrays
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  std::vector<double> location(2);
+  for (int i=0; i<n; ++i)
+  {
+    location[0]=rx[i];
+    location[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(location,bearing[i]*180/M_PI,2,"rx");
+    rColl.addReport(reports[i]);
+  }
+  DFLib::XY::Point fix(location);
+  double am2,bm2,phi;
+  rColl.computePseudoLinearFix(fix,am2,bm2,phi);
+  std::vector<double> arrayFix;
+  double arrayAm2,arrayBm2,arrayPhi;
+  collection.computePseudoLinearFix(arrayFix,arrayAm2,arrayBm2,arrayPhi);
+  std::vector<double> fixXY=fix.getXY();
+  double difference=hypot(fixXY[0]-arrayFix[0],fixXY[1]-arrayFix[1]);
+  std::cout << " Report collection and array fixes differ by "
+            << difference << " m";
+  if (difference < 1e-6 && fabs(am2-arrayAm2) <= 1e-9*fabs(arrayAm2)
+      && fabs(bm2-arrayBm2) <= 1e-9*fabs(arrayBm2))
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Parallel bearings have no fix
+  bool threw=false;
+  for (int i=0; i<n; ++i)
+    bearing[i]=0.3;
+  collection.setArrays(n,rx,ry,bearing,sigmas);
+  try
+  {
+    collection.computePseudoLinearFix(arrayFix,arrayAm2,arrayBm2,arrayPhi);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    threw=true;
+  }
+  std::cout << " Parallel bearings throw";
+  if (threw)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+
+  return numFailed;
+}
@@ -1,4 +1,8 @@
-%module(directors="1") DFLib
+%module(directors="1", threads="1") DFLib
+// Keep the GIL by default.  Methods that may run for a long time release
+// it explicitly (see DF_Report_Collection.i); director up-calls take it
+// back when they need it.
+%nothread;
 %feature("director:except") {
   if( $error != NULL ) {
     PyObject *ptype, *pvalue, *ptraceback;
@@ -13,8 +17,18 @@
 %include "std_vector.i"
 namespace std{
   %template(vectord) vector<double>;
+  %template(vectori) vector<int>;
  };
 %include DFLib_port.h
 %include DF_Abstract_Point.i
 %include DF_Abstract_Report.i
+%include DF_Exclusion_Search.i
 %include DF_Report_Collection.i
+%include DF_Array_Collection.i
+%include DF_EKF_Tracker.i
+%include DF_Particle_Filter.i
+%include DF_Windowed_Collection.i
+%include DF_Receiver_Index.i
+%include DF_Bearing_Association.i
+%include DF_CRB_Map.i
+%include DF_Receiver_Placement.i
@@ -0,0 +1,317 @@
+// Array versions of the ReportCollection fix methods.
+//
+// The wrapped functions take any C-contiguous buffer (NumPy arrays in
+// practice) through the Python buffer protocol and work on it in place.
+// Results are written into caller-provided buffers, so the Python
+// functions at the bottom of this file allocate NumPy arrays and hand
+// them down; nothing is copied in either direction.  The GIL is released
+// while the fixes are computed.
+
+%{
+#include <cmath>
+#include <limits>
+#include <string>
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+
+// Holds a buffer view for the duration of a call.
+class DFLibBuffer
+{
+public:
+  Py_buffer view;
+  bool ok;
+
+  DFLibBuffer() : ok(false) {};
+  ~DFLibBuffer() { if (ok) PyBuffer_Release(&view); };
+
+  // Get a contiguous view of obj whose items are of the given struct
+  // format character.  Sets a Python exception and returns false on failure.
+  bool acquire(PyObject *obj, const char *name, const char *formats,
+               Py_ssize_t itemsize, bool writable)
+  {
+    int flags=PyBUF_C_CONTIGUOUS | PyBUF_FORMAT;
+    if (writable)
+      flags |= PyBUF_WRITABLE;
+    if (PyObject_GetBuffer(obj,&view,flags) != 0)
+      return false;
+    ok=true;
+
+    // Skip any byte order prefix; we only accept native layouts.
+    const char *f=(view.format)?view.format:"B";
+    if (*f=='@' || *f=='=' || *f=='<')
+      ++f;
+    if (view.itemsize != itemsize || f[0]=='\0' || f[1]!='\0'
+        || std::string(formats).find(f[0])==std::string::npos)
+    {
+      PyErr_Format(PyExc_TypeError,"%s has the wrong element type",name);
+      return false;
+    }
+    return true;
+  };
+
+  Py_ssize_t count() const {return view.len/view.itemsize;};
+};
+
+// Acquire the common report arrays, checking that they agree in length.
+static bool DFLibGetReportBuffers(PyObject *x, PyObject *y,
+                                  PyObject *bearing, PyObject *sigma,
+                                  PyObject *valid, DFLibBuffer b[5])
+{
+  if (!b[0].acquire(x,"x","d",sizeof(double),false)
+      || !b[1].acquire(y,"y","d",sizeof(double),false)
+      || !b[2].acquire(bearing,"bearing","d",sizeof(double),false)
+      || !b[3].acquire(sigma,"sigma","d",sizeof(double),false))
+    return false;
+  if (valid != Py_None && !b[4].acquire(valid,"valid","?Bb",1,false))
+    return false;
+
+  Py_ssize_t n=b[0].count();
+  if (b[1].count()!=n || b[2].count()!=n || b[3].count()!=n
+      || (b[4].ok && b[4].count()!=n))
+  {
+    PyErr_SetString(PyExc_ValueError,"report arrays differ in size");
+    return false;
+  }
+  return true;
+}
+
+// Shorthand for the arrays of scenario s when each scenario has n reports
+#define DFLIB_SCENARIO_ARRAYS(b,s,n)                                   \
+  (n),                                                                  \
+  static_cast<const double *>(b[0].view.buf)+(s)*(n),                   \
+  static_cast<const double *>(b[1].view.buf)+(s)*(n),                   \
+  static_cast<const double *>(b[2].view.buf)+(s)*(n),                   \
+  static_cast<const double *>(b[3].view.buf)+(s)*(n),                   \
+  (b[4].ok)?static_cast<const unsigned char *>(b[4].view.buf)+(s)*(n):0
+%}
+
+%inline %{
+// Fix method selectors for _arrayFixes
+enum { DFLIB_ARRAY_LS=0, DFLIB_ARRAY_ML=1, DFLIB_ARRAY_AGGRESSIVE_ML=2,
+       DFLIB_ARRAY_STANSFIELD=3, DFLIB_ARRAY_CRB=4,
+       DFLIB_ARRAY_GLOBAL_ML=5, DFLIB_ARRAY_PSEUDO_LINEAR=6 };
+
+// Compute one kind of fix for each of numScenarios scenarios laid end to
+// end in the report arrays.  fix holds 2 values per scenario; it is the
+// starting guess for ML and Stansfield and the point of evaluation for
+// CRB.  ellipse, if not None, gets am2, bm2, phi per scenario.  Failed
+// fixes are NaN.
+PyObject *_arrayFixes(int method, int numScenarios,
+                      PyObject *x, PyObject *y, PyObject *bearing,
+                      PyObject *sigma, PyObject *valid,
+                      PyObject *fix, PyObject *ellipse)
+{
+  DFLibBuffer b[5];
+  DFLibBuffer fixBuf,ellipseBuf;
+  if (!DFLibGetReportBuffers(x,y,bearing,sigma,valid,b)
+      || !fixBuf.acquire(fix,"fix","d",sizeof(double),true))
+    return NULL;
+  if (ellipse != Py_None
+      && !ellipseBuf.acquire(ellipse,"ellipse","d",sizeof(double),true))
+    return NULL;
+  if (numScenarios <= 0 || b[0].count()%numScenarios != 0
+      || fixBuf.count() != 2*numScenarios
+      || (ellipseBuf.ok && ellipseBuf.count() != 3*numScenarios))
+  {
+    PyErr_SetString(PyExc_ValueError,"output arrays do not match scenarios");
+    return NULL;
+  }
+
+  int n=b[0].count()/numScenarios;
+  double *fixes=static_cast<double *>(fixBuf.view.buf);
+  double *ellipses=0;
+  if (ellipseBuf.ok)
+    ellipses=static_cast<double *>(ellipseBuf.view.buf);
+  const double nan=std::numeric_limits<double>::quiet_NaN();
+
+  Py_BEGIN_ALLOW_THREADS
+  DFLib::ArrayCollection coll(0,0,0,0,0);
+  std::vector<double> aFix(2);
+  for (int s=0; s<numScenarios; ++s)
+  {
+    double am2=nan,bm2=nan,phi=nan;
+    coll.setArrays(DFLIB_SCENARIO_ARRAYS(b,s,n));
+    aFix[0]=fixes[2*s];
+    aFix[1]=fixes[2*s+1];
+    try
+    {
+      switch (method)
+      {
+      case DFLIB_ARRAY_LS:
+        coll.computeLeastSquaresFix(aFix);
+        break;
+      case DFLIB_ARRAY_ML:
+        coll.computeMLFix(aFix);
+        break;
+      case DFLIB_ARRAY_AGGRESSIVE_ML:
+        coll.aggressiveComputeMLFix(aFix);
+        break;
+      case DFLIB_ARRAY_STANSFIELD:
+        coll.computeStansfieldFix(aFix,am2,bm2,phi);
+        break;
+      case DFLIB_ARRAY_GLOBAL_ML:
+        coll.globalComputeMLFix(aFix);
+        break;
+      case DFLIB_ARRAY_CRB:
+        coll.computeCramerRaoBounds(aFix,am2,bm2,phi);
+        break;
+      case DFLIB_ARRAY_PSEUDO_LINEAR:
+        coll.computePseudoLinearFix(aFix,am2,bm2,phi);
+        break;
+      }
+    }
+    catch (DFLib::Util::Exception &e)
+    {
+      aFix[0]=aFix[1]=am2=bm2=phi=nan;
+    }
+    fixes[2*s]=aFix[0];
+    fixes[2*s+1]=aFix[1];
+    if (ellipses)
+    {
+      ellipses[3*s]=am2;
+      ellipses[3*s+1]=bm2;
+      ellipses[3*s+2]=phi;
+    }
+  }
+  Py_END_ALLOW_THREADS
+
+  Py_RETURN_NONE;
+}
+
+// Fill surface (len(gridY) rows of len(gridX)) with the ML cost function
+PyObject *_arrayCostSurface(PyObject *x, PyObject *y, PyObject *bearing,
+                            PyObject *sigma, PyObject *valid,
+                            PyObject *gridX, PyObject *gridY,
+                            PyObject *surface)
+{
+  DFLibBuffer b[5];
+  DFLibBuffer gx,gy,out;
+  if (!DFLibGetReportBuffers(x,y,bearing,sigma,valid,b)
+      || !gx.acquire(gridX,"gridX","d",sizeof(double),false)
+      || !gy.acquire(gridY,"gridY","d",sizeof(double),false)
+      || !out.acquire(surface,"surface","d",sizeof(double),true))
+    return NULL;
+  if (out.count() != gx.count()*gy.count())
+  {
+    PyErr_SetString(PyExc_ValueError,"surface does not match grid");
+    return NULL;
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  DFLib::ArrayCollection coll(DFLIB_SCENARIO_ARRAYS(b,0,b[0].count()));
+  coll.computeCostSurface(gx.count(),static_cast<const double *>(gx.view.buf),
+                          gy.count(),static_cast<const double *>(gy.view.buf),
+                          static_cast<double *>(out.view.buf));
+  Py_END_ALLOW_THREADS
+
+  Py_RETURN_NONE;
+}
+%}
+
+%pythoncode %{
+def _reportArrays(x, y, bearing, sigma, valid):
+    """Return C-contiguous 2-D views (scenarios x reports) of the inputs.
+
+    Arrays that are already float64 (bool for valid) and contiguous are
+    used as they are; anything else is converted once.
+    """
+    import numpy
+    arrays = [numpy.ascontiguousarray(numpy.atleast_2d(a), dtype=numpy.float64)
+              for a in (x, y, bearing, sigma)]
+    if valid is not None:
+        valid = numpy.ascontiguousarray(numpy.atleast_2d(valid), dtype=numpy.bool_)
+    return arrays[0], arrays[1], arrays[2], arrays[3], valid
+
+
+def _runArrayFixes(method, x, y, bearing, sigma, valid, fix, withEllipse):
+    import numpy
+    squeeze = numpy.ndim(x) == 1
+    x, y, bearing, sigma, valid = _reportArrays(x, y, bearing, sigma, valid)
+    numScenarios = x.shape[0]
+    if fix is None:
+        fix = numpy.zeros((numScenarios, 2))
+    else:
+        fix = numpy.array(fix, dtype=numpy.float64).reshape(numScenarios, 2)
+    ellipse = numpy.empty((numScenarios, 3)) if withEllipse else None
+    _arrayFixes(method, numScenarios, x, y, bearing, sigma, valid, fix, ellipse)
+    if squeeze:
+        fix = fix[0]
+        ellipse = ellipse[0] if withEllipse else None
+    return (fix, ellipse) if withEllipse else fix
+
+
+def arrayLeastSquaresFix(x, y, bearing, sigma, valid=None):
+    """Least squares fix from arrays of report data.
+
+    x, y are receiver XY coordinates, bearing and sigma are in radians
+    (bearing clockwise from north), valid is an optional boolean mask.
+    1-D inputs are one scenario and give a fix of shape (2,); 2-D inputs
+    of shape (m, n) are m scenarios of n reports and give shape (m, 2).
+    """
+    return _runArrayFixes(DFLIB_ARRAY_LS, x, y, bearing, sigma, valid,
+                          None, False)
+
+
+def arrayMLFix(x, y, bearing, sigma, valid=None, initial=None,
+               aggressive=False):
+    """Maximum likelihood fix from arrays of report data.
+
+    Starts from initial, or from the least squares fix if initial is
+    None.  aggressive=True uses aggressiveComputeMLFix.  See also
+    arrayGlobalMLFix.
+    """
+    if initial is None:
+        initial = arrayLeastSquaresFix(x, y, bearing, sigma, valid)
+    method = DFLIB_ARRAY_AGGRESSIVE_ML if aggressive else DFLIB_ARRAY_ML
+    return _runArrayFixes(method, x, y, bearing, sigma, valid, initial, False)
+
+
+def arrayGlobalMLFix(x, y, bearing, sigma, valid=None):
+    """Maximum likelihood fix by global coarse-to-fine grid search.
+
+    Needs no starting guess; see ReportCollection::globalComputeMLFix.
+    """
+    return _runArrayFixes(DFLIB_ARRAY_GLOBAL_ML, x, y, bearing, sigma, valid,
+                          None, False)
+
+
+def arrayStansfieldFix(x, y, bearing, sigma, valid=None, initial=None):
+    """Stansfield fix and ellipse (am2, bm2, phi) from arrays of report data.
+
+    Scenarios where the iteration fails to converge give NaN.
+    """
+    if initial is None:
+        initial = arrayLeastSquaresFix(x, y, bearing, sigma, valid)
+    return _runArrayFixes(DFLIB_ARRAY_STANSFIELD, x, y, bearing, sigma, valid,
+                          initial, True)
+
+
+def arrayPseudoLinearFix(x, y, bearing, sigma, valid=None):
+    """Bias-compensated pseudo-linear fix and ellipse (am2, bm2, phi).
+
+    Needs no starting guess; see ReportCollection::computePseudoLinearFix.
+    Scenarios whose bearings are all parallel give NaN.
+    """
+    return _runArrayFixes(DFLIB_ARRAY_PSEUDO_LINEAR, x, y, bearing, sigma,
+                          valid, None, True)
+
+
+def arrayCramerRaoBounds(x, y, bearing, sigma, fix, valid=None):
+    """Cramer-Rao ellipse (am2, bm2, phi) at fix for arrays of report data."""
+    return _runArrayFixes(DFLIB_ARRAY_CRB, x, y, bearing, sigma, valid,
+                          fix, True)[1]
+
+
+def arrayCostSurface(x, y, bearing, sigma, gridX, gridY, valid=None):
+    """ML cost function on the grid gridX by gridY for one scenario.
+
+    Returns an array of shape (len(gridY), len(gridX)).
+    """
+    import numpy
+    x, y, bearing, sigma, valid = _reportArrays(x, y, bearing, sigma, valid)
+    gridX = numpy.ascontiguousarray(gridX, dtype=numpy.float64)
+    gridY = numpy.ascontiguousarray(gridY, dtype=numpy.float64)
+    surface = numpy.empty((gridY.size, gridX.size))
+    _arrayCostSurface(x, y, bearing, sigma, valid, gridX, gridY, surface)
+    return surface
+%}
@@ -0,0 +1,13 @@
+%{
+#include "DF_Bearing_Association.hpp"
+%}
+
+// Raw arrays don't map to Python, and a vector of new collections would
+// leave their ownership unclear.  Use the labels and
+// ReportCollection.makeSubset instead.
+%ignore DFLib::BearingAssociator::associate(int, const double *, const double *, const double *, const double *, const unsigned char *, std::vector<int> &);
+%ignore DFLib::BearingAssociator::associate(DFLib::ReportCollection &, std::vector<DFLib::ReportCollection *> &);
+%ignore DFLib::BearingAssociator::getGrid;
+%thread DFLib::BearingAssociator::associate;
+
+%include "DF_Bearing_Association.hpp"
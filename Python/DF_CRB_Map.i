@@ -0,0 +1,12 @@
+%{
+#include "DF_CRB_Map.hpp"
+%}
+
+// Raw arrays don't map to Python; add receivers one at a time
+%ignore DFLib::CRBMap::addReceivers;
+%thread DFLib::CRBMap::addReceiver;
+%thread DFLib::CRBMap::removeReceiver;
+%thread DFLib::CRBMap::moveReceiver;
+%thread DFLib::CRBMap::refresh;
+
+%include "DF_CRB_Map.hpp"
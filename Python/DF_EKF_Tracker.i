@@ -0,0 +1,5 @@
+%{
+#include "DF_EKF_Tracker.hpp"
+%}
+
+%include "DF_EKF_Tracker.hpp"
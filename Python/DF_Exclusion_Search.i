@@ -0,0 +1,11 @@
+%{
+#include "DF_Exclusion_Search.hpp"
+%}
+
+// Python runs the search through ReportCollection::searchExclusions; the
+// class itself wants raw arrays.
+%ignore DFLib::ExclusionSearch;
+%include "DF_Exclusion_Search.hpp"
+namespace std {
+  %template(vectorExclusionResult) vector<DFLib::ExclusionResult>;
+}
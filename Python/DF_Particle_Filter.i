@@ -0,0 +1,16 @@
+%{
+#include "DF_Particle_Filter.hpp"
+%}
+
+// Raw particle arrays mean nothing to Python; use getWeights, getMean
+// and getBestParticle instead.
+%ignore DFLib::ParticleFilter::getParticleX;
+%ignore DFLib::ParticleFilter::getParticleY;
+%ignore DFLib::ParticleFilter::update(int, const double *, const double *,
+                                      const double *, const double *);
+%thread DFLib::ParticleFilter::initializeUniform;
+%thread DFLib::ParticleFilter::initializeAroundReceivers;
+%thread DFLib::ParticleFilter::update;
+
+%include "stdint.i"
+%include "DF_Particle_Filter.hpp"
@@ -0,0 +1,8 @@
+%{
+#include "DF_Receiver_Index.hpp"
+%}
+
+// Build from a ReportCollection; raw arrays don't map to Python
+%ignore DFLib::ReceiverIndex::build(int, const double *, const double *, const double *, const unsigned char *);
+
+%include "DF_Receiver_Index.hpp"
@@ -0,0 +1,8 @@
+%{
+#include "DF_Receiver_Placement.hpp"
+%}
+
+%thread DFLib::ReceiverPlacement::choose;
+%thread DFLib::ReceiverPlacement::computeScore;
+
+%include "DF_Receiver_Placement.hpp"
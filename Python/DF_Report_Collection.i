@@ -1,9 +1,45 @@
 %{
 #include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "DF_Exclusion_Search.hpp"
 %}
 
+// Fixes can take a long time, so let other Python threads run meanwhile.
+// After materialize() they make no up-calls into Python at all.
+%thread DFLib::ReportCollection::materialize;
+%thread DFLib::ReportCollection::computeFixCutAverage;
+%thread DFLib::ReportCollection::computeLeastSquaresFix;
+%thread DFLib::ReportCollection::computeAllFixes;
+%thread DFLib::ReportCollection::computeStansfieldFix;
+%thread DFLib::ReportCollection::computePseudoLinearFix;
+%thread DFLib::ReportCollection::computeMLFix;
+%thread DFLib::ReportCollection::aggressiveComputeMLFix;
+%thread DFLib::ReportCollection::globalComputeMLFix;
+%thread DFLib::ReportCollection::computeCramerRaoBounds;
+%thread DFLib::ReportCollection::computeConfidenceRegions;
+%thread DFLib::ReportCollection::computeBootstrap;
+%thread DFLib::ReportCollection::computeJackknife;
+%thread DFLib::ReportCollection::computeFixDiagnostics;
+%thread DFLib::ReportCollection::computeLeaveOneOutLeastSquares;
+%thread DFLib::ReportCollection::computeLeaveOneOutML;
+%thread DFLib::ReportCollection::searchExclusions;
+
+// The new collection belongs to Python; the reports in it do not.
+%newobject DFLib::ReportCollection::makeSubset;
+
+%include "stdint.i"
 %include "DFLib_port.h"
 %include "DF_Abstract_Report.hpp"
 %include "DF_Abstract_Point.hpp"
 %include "Util_Abstract_Group.hpp"
+
+// Only the result types are wanted from here; Python gets at
+// ArrayCollection through the array functions instead.
+%ignore DFLib::ArrayCollection;
+%include "DF_Array_Collection.hpp"
+namespace std {
+  %template(vectorvectord) vector<vector<double> >;
+  %template(vectorConfidenceRegion) vector<DFLib::ConfidenceRegion>;
+}
+
 %include "DF_Report_Collection.hpp"
@@ -0,0 +1,13 @@
+%{
+#include "DF_Windowed_Collection.hpp"
+%}
+
+// ArrayCollection is not wrapped; see DF_Report_Collection.i
+%ignore DFLib::WindowedCollection::getArrayCollection;
+%thread DFLib::WindowedCollection::computeMLFix;
+%thread DFLib::WindowedCollection::aggressiveComputeMLFix;
+%thread DFLib::WindowedCollection::globalComputeMLFix;
+%thread DFLib::WindowedCollection::computeStansfieldFix;
+%thread DFLib::WindowedCollection::computePseudoLinearFix;
+
+%include "DF_Windowed_Collection.hpp"
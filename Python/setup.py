@@ -3,7 +3,7 @@
 from setuptools import setup, Extension
 
 DFLib_module = Extension('_DFLib',
-                       sources=['DFLib.i', '../DF_Abstract_Report.cpp','../DF_Report_Collection.cpp', '../Util_Minimization_Methods.cpp'],
+                       sources=['DFLib.i', '../DF_Abstract_Report.cpp','../DF_Report_Collection.cpp', '../DF_Array_Collection.cpp', '../DF_EKF_Tracker.cpp', '../DF_Particle_Filter.cpp', '../DF_Windowed_Collection.cpp', '../DF_Receiver_Index.cpp', '../DF_Bearing_Association.cpp', '../DF_CRB_Map.cpp', '../DF_Receiver_Placement.cpp', '../DF_Exclusion_Search.cpp', '../gaussian_random.cpp', '../Util_Minimization_Methods.cpp', '../Util_Contour.cpp'],
                        swig_opts = ['-c++','-I..'],
                        include_dirs = ['..'],
                        )
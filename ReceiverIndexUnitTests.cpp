@@ -0,0 +1,198 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the receiver and bearing line grid index.
+//
+// Special Notes  : Queries over a large random network are checked
+//                  against a search through every report, and a fix from
+//                  the reports a corridor query picks out is checked
+//                  against the transmitter those reports point at.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Receiver_Index.hpp"
+#include "gaussian_random.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  // 5000 receivers scattered over a region about 1000 km across.  Each
+  // one hears whichever of two transmitters, 600 km apart, is closer,
+  // with 1 degree errors.  Every eleventh report is invalid.
+  const int n=5000;
+  const double maxRange=300000;
+  double txX[2]={-300000,300000};
+  double txY[2]={100000,-50000};
+  DFLib::Util::gaussian_random_generator scatter(0,300000,20091001,3);
+  DFLib::Util::gaussian_random_generator noise(0,M_PI/180,20091001,4);
+  std::vector<double> x(n),y(n),bearing(n),sigma(n,M_PI/180);
+  std::vector<unsigned char> valid(n);
+  std::vector<int> target(n);
+  for (int i=0; i<n; ++i)
+  {
+    x[i]=scatter.getRandom();
+    y[i]=scatter.getRandom();
+    double d0=hypot(txX[0]-x[i],txY[0]-y[i]);
+    double d1=hypot(txX[1]-x[i],txY[1]-y[i]);
+    target[i]=(d0<d1)?0:1;
+    bearing[i]=atan2(txX[target[i]]-x[i],txY[target[i]]-y[i])
+      +noise.getRandom();
+    if (bearing[i]<0)
+      bearing[i] += 2*M_PI;
+    valid[i]=(i%11==10)?0:1;
+  }
+
+  DFLib::ReceiverIndex index(20000,maxRange);
+  index.build(n,&x[0],&y[0],&bearing[0],&valid[0]);
+
+  // Compare queries with brute force, at random places and sizes
+  bool receiversMatch=true;
+  bool linesMatch=true;
+  int totalLines=0;
+  DFLib::Util::gaussian_random_generator where(0,400000,20091001,5);
+  for (int q=0; q<200; ++q)
+  {
+    double cx=where.getRandom();
+    double cy=where.getRandom();
+    double radius=(q<100)?5000+100*q:5000*q;
+    std::vector<int> expectedReceivers,expectedLines;
+    for (int i=0; i<n; ++i)
+    {
+      if (!valid[i])
+        continue;
+      double dx=cx-x[i];
+      double dy=cy-y[i];
+      if (dx*dx+dy*dy <= radius*radius)
+        expectedReceivers.push_back(i);
+      double along=dx*sin(bearing[i])+dy*cos(bearing[i]);
+      along=std::min(std::max(along,0.0),maxRange);
+      double ex=dx-along*sin(bearing[i]);
+      double ey=dy-along*cos(bearing[i]);
+      if (ex*ex+ey*ey <= radius*radius)
+        expectedLines.push_back(i);
+    }
+    std::vector<int> receivers,lines;
+    index.findReceiversNear(cx,cy,radius,receivers);
+    index.findBearingLinesNear(cx,cy,radius,lines);
+    if (receivers!=expectedReceivers)
+      receiversMatch=false;
+    if (lines!=expectedLines)
+      linesMatch=false;
+    totalLines += lines.size();
+  }
+
+  std::cout << " Receivers near 200 points match a full search";
+  if (receiversMatch)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Bearing lines near 200 points (" << totalLines
+            << " in all) match a full search";
+  if (linesMatch && totalLines>0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The same network as a report collection.  A corridor query around
+  // the first transmitter should pick out reports that point at it, and
+  // the fix from just those should land on it.
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection collection;
+  std::vector<double> location(2);
+  for (int i=0; i<n; ++i)
+  {
+    location[0]=x[i];
+    location[1]=y[i];
+    reports[i]=new DFLib::XY::Report(location,bearing[i]*180/M_PI,1,"rx");
+    if (!valid[i])
+      reports[i]->setInvalid();
+    collection.addReport(reports[i]);
+  }
+  DFLib::ReceiverIndex collectionIndex(20000,maxRange);
+  collectionIndex.build(collection);
+  std::vector<int> nearby;
+  collectionIndex.findBearingLinesNear(txX[0]+3000,txY[0]-2000,10000,nearby);
+
+  int numWrong=0;
+  for (int k=0; k<nearby.size(); ++k)
+    if (target[nearby[k]]!=0)
+      ++numWrong;
+  std::cout << " Corridor query picked " << nearby.size()
+            << " of " << n << " reports, " << numWrong
+            << " pointing elsewhere";
+  if (nearby.size()>10 && nearby.size()<n/2 && numWrong==0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  collection.materialize(nearby);
+  DFLib::XY::Point fix(location);
+  collection.computeLeastSquaresFix(fix);
+  collection.computeMLFix(fix);
+  std::vector<double> fixXY=fix.getXY();
+  double miss=hypot(fixXY[0]-txX[0],fixXY[1]-txY[0]);
+  std::cout << " Fix from the corridor is " << miss
+            << " m from the transmitter";
+  if (miss<1000)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+
+  return numFailed;
+}
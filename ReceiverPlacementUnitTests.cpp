@@ -0,0 +1,153 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of receiver site selection.
+//
+// Special Notes  : With few enough candidates every plan can be scored,
+//                  so the chosen plan can be checked against the best
+//                  there is.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_Receiver_Placement.hpp"
+#include "Util_Misc.hpp"
+
+/// best score of any plan of three sites, by brute force
+double bestOfAll(DFLib::ReceiverPlacement &placement,
+                 DFLib::ReceiverPlacement::Criterion criterion)
+{
+  int nc=placement.numCandidates();
+  double best=HUGE_VAL;
+  std::vector<int> sites(3);
+  for (sites[0]=0; sites[0]<nc; ++sites[0])
+    for (sites[1]=sites[0]+1; sites[1]<nc; ++sites[1])
+      for (sites[2]=sites[1]+1; sites[2]<nc; ++sites[2])
+        best=std::min(best,placement.computeScore(sites,criterion));
+  return best;
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::vector<double> gridX,gridY;
+  for (int i=0; i<21; ++i)
+  {
+    gridX.push_back(-20000+2000*i);
+    gridY.push_back(-20000+2000*i);
+  }
+
+  // Eight sites around the area, some better receivers than others,
+  // and four crowded into one corner
+  DFLib::ReceiverPlacement placement(gridX,gridY);
+  for (int i=0; i<8; ++i)
+  {
+    double a=i*M_PI/4+0.3;
+    placement.addCandidate(30000*sin(a),30000*cos(a),(1+0.25*(i%3))*M_PI/180);
+  }
+  for (int i=0; i<4; ++i)
+    placement.addCandidate(25000+1000*i,25000-1500*i,0.5*M_PI/180);
+
+  DFLib::ReceiverPlacement::Criterion criteria[2]=
+    {DFLib::ReceiverPlacement::MEAN_AREA,
+     DFLib::ReceiverPlacement::WORST_AREA};
+  const char *names[2]={"mean","worst"};
+  for (int t=0; t<2; ++t)
+  {
+    std::vector<int> greedy,chosen;
+    double greedyScore=placement.choose(3,greedy,criteria[t],0);
+    double score=placement.choose(3,chosen,criteria[t]);
+    int numInMap=placement.getMap().numReceivers();
+    double rescored=placement.computeScore(chosen,criteria[t]);
+    double best=bestOfAll(placement,criteria[t]);
+
+    std::cout << " Best " << names[t] << " area " << best
+              << ", greedy " << greedyScore << ", with swaps " << score;
+    if (score <= greedyScore && score < 1.02*best && numInMap==3
+        && fabs(rescored-score) < 1e-9*score)
+      std::cout << " PASSED " << std::endl;
+    else
+    {
+      std::cout << " FAILED " << std::endl;
+      ++numFailed;
+    }
+  }
+
+  // A receiver already in place is in every plan, and the plan works
+  // around it
+  DFLib::ReceiverPlacement extension(gridX,gridY);
+  for (int i=0; i<8; ++i)
+  {
+    double a=i*M_PI/4;
+    extension.addCandidate(30000*sin(a),30000*cos(a),M_PI/180);
+  }
+  extension.addFixedReceiver(0,-30000,M_PI/180);
+  std::vector<int> added;
+  extension.choose(2,added);
+  bool avoidsFixed=true;
+  for (int j=0; j<2; ++j)
+    avoidsFixed = avoidsFixed && added[j]!=4;
+  std::cout << " Extending a network";
+  if (extension.getMap().numReceivers()==3 && avoidsFixed)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  bool threw=false;
+  try
+  {
+    extension.choose(9,added);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    threw=true;
+  }
+  std::cout << " Asking for more sites than candidates";
+  if (threw)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
@@ -0,0 +1,251 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the compensated, deterministic sums of
+//                  Util_Reduction.hpp, and of the ReportCollection
+//                  methods built on them.
+//
+// Special Notes  : Sums must agree to the last bit whatever the number
+//                  of threads, and whether or not the collection is
+//                  materialized.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "Util_Reduction.hpp"
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "UnitTestScenes.hpp"
+
+/// \brief 0.1 for every item, and the item number for even items only
+class TenthTerms
+{
+public:
+  bool operator()(int i, double *t) const
+  {
+    t[0]=0.1;
+    t[1]=(i%2==0)?i:0.0;
+    return true;
+  };
+};
+
+/// \brief items that add nothing
+class NoTerms
+{
+public:
+  bool operator()(int i, double *t) const { return false; };
+};
+
+/// \brief everything the collection sums, at one point
+void collectionSums(DFLib::ReportCollection &rColl, std::vector<double> &point,
+                    std::vector<double> &results)
+{
+  double f;
+  std::vector<double> gradient;
+  std::vector<std::vector<double> > hessian;
+  results.clear();
+  results.push_back(rColl.computeCostFunction(point));
+  rColl.computeCostFunctionAndGradient(point,f,gradient);
+  results.push_back(f);
+  results.push_back(gradient[0]);
+  results.push_back(gradient[1]);
+  rColl.computeCostFunctionAndHessian(point,f,gradient,hessian);
+  results.push_back(hessian[0][0]);
+  results.push_back(hessian[0][1]);
+  results.push_back(hessian[1][1]);
+
+  DFLib::XY::Point fix(point);
+  rColl.computeLeastSquaresFix(fix);
+  results.push_back(fix.getXY()[0]);
+  results.push_back(fix.getXY()[1]);
+  double am2,bm2,phi;
+  rColl.computeCramerRaoBounds(fix,am2,bm2,phi);
+  results.push_back(am2);
+  results.push_back(bm2);
+  rColl.computeStansfieldFix(fix,am2,bm2,phi);
+  results.push_back(fix.getXY()[0]);
+  results.push_back(fix.getXY()[1]);
+  results.push_back(am2);
+}
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  std::cout << " Neumaier sum keeps what a plain sum loses";
+  DFLib::Util::NeumaierSum sum;
+  double plain=0;
+  double values[4]={1.0,1e100,1.0,-1e100};
+  for (int i=0; i<4; ++i)
+  {
+    sum.add(values[i]);
+    plain += values[i];
+  }
+  if (sum.value()==2.0 && plain!=2.0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // More than one block, and a partial block at the end
+  const int n=1000003;
+  double totals1[2],totals3[2];
+#ifdef _OPENMP
+  int oldThreads=omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  DFLib::Util::deterministicSum<2>(n,TenthTerms(),totals1);
+#ifdef _OPENMP
+  omp_set_num_threads(3);
+#endif
+  DFLib::Util::deterministicSum<2>(n,TenthTerms(),totals3);
+#ifdef _OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+  plain=0;
+  for (int i=0; i<n; ++i)
+    plain += 0.1;
+  // n*0.1 is the exact sum of n copies of 0.1, correctly rounded
+  double exact=n*0.1;
+  double evenSum=(double(n-1)/2)*(double(n-1)/2+1);
+  std::cout << " Sum of a million tenths " << totals1[0]
+            << " (plain sum off by " << plain-exact << ")";
+  if (fabs(totals1[0]-exact)<=2e-16*exact && totals1[1]==evenSum)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Same bits on one thread and three";
+  if (totals1[0]==totals3[0] && totals1[1]==totals3[1])
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Nothing to sum";
+  DFLib::Util::deterministicSum<2>(0,TenthTerms(),totals1);
+  DFLib::Util::deterministicSum<2>(5000,NoTerms(),totals3);
+  if (totals1[0]==0 && totals1[1]==0 && totals3[0]==0 && totals3[1]==0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // A collection of several blocks' worth of reports
+  const int numReports=5000;
+  std::vector<DFLib::XY::Report *> reports(numReports);
+  DFLib::ReportCollection rColl;
+  std::vector<double> loc(2);
+  std::vector<double> rx(numReports),ry(numReports);
+  spiralReceivers(numReports,20000,2,0,2*M_PI/numReports,&rx[0],&ry[0]);
+  for (int i=0; i<numReports; ++i)
+  {
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    double b=bearingTo(rx[i],ry[i],300,-700)*180/M_PI+((i%11)-5)*0.3;
+    reports[i]=new DFLib::XY::Report(loc,b,2,"r");
+    if (i%13==0)
+      reports[i]->setInvalid();
+    rColl.addReport(reports[i]);
+  }
+  std::vector<double> point(2);
+  point[0]=250;
+  point[1]=-650;
+
+  std::vector<double> results1,results3;
+#ifdef _OPENMP
+  omp_set_num_threads(1);
+#endif
+  collectionSums(rColl,point,results1);
+#ifdef _OPENMP
+  omp_set_num_threads(3);
+#endif
+  collectionSums(rColl,point,results3);
+#ifdef _OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+
+  std::cout << " Collection sums and fixes on one thread and three";
+  if (results1==results3)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The snapshot must sum the same terms in the same order
+  std::vector<double> resultsSnapshot;
+  rColl.materialize();
+  collectionSums(rColl,point,resultsSnapshot);
+  rColl.invalidateSnapshot();
+  std::cout << " Same bits from the reports and from a snapshot";
+  if (results1==resultsSnapshot)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Least squares fix near the transmitter at "
+            << results1[7] << "," << results1[8];
+  if (fabs(results1[7]-300)<50 && fabs(results1[8]+700)<50)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<numReports; ++i)
+    delete reports[i];
+  return numFailed;
+}
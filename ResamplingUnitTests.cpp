@@ -0,0 +1,200 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the bootstrap and jackknife spread of fixes.
+//
+// Special Notes  : Thirty receivers report a transmitter many times over
+//                  with fresh bearing errors.  The spread the bootstrap
+//                  and jackknife estimate from a single set of reports
+//                  must be about the spread of the fix over all the sets.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+#include "Util_Misc.hpp"
+#include "gaussian_random.hpp"
+#include "UnitTestScenes.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  const int n=30;
+  const int numTrials=200;
+  const double sigma=3*M_PI/180;
+  double rx[n],ry[n],bearing[n],sigmas[n];
+  spiralReceivers(n,15000,300,-2.2,0.15,rx,ry);
+  for (int i=0; i<n; ++i)
+    sigmas[i]=sigma;
+  double tx=1000;
+  double ty=-2000;
+  DFLib::Util::gaussian_random_generator noise(0,1,20091001,9);
+  DFLib::ArrayCollection collection(n,rx,ry,bearing,sigmas);
+
+  // Spread of the ML fix over many sets of reports, and the mean of the
+  // estimates of it made from each set alone
+  double sumX=0,sumY=0,sumX2=0,sumY2=0;
+  double sumBootTrace=0,sumJackTrace=0;
+  int numEstimates=0;
+  for (int t=0; t<numTrials; ++t)
+  {
+    noisyBearings(n,rx,ry,tx,ty,sigmas,noise,bearing);
+    collection.setArrays(n,rx,ry,bearing,sigmas);
+
+    std::vector<double> fix;
+    double am2,bm2,phi;
+    collection.computePseudoLinearFix(fix,am2,bm2,phi);
+    collection.computeMLFix(fix);
+    sumX += fix[0];
+    sumY += fix[1];
+    sumX2 += fix[0]*fix[0];
+    sumY2 += fix[1]*fix[1];
+
+    // Resampling on a few of the sets is plenty
+    if (t%10==0)
+    {
+      DFLib::ResamplingEstimate boot,jack;
+      collection.computeBootstrap(DFLib::ML_FIX,fix,200,boot,t+1);
+      collection.computeJackknife(DFLib::ML_FIX,fix,jack);
+      sumBootTrace += boot.covariance[0][0]+boot.covariance[1][1];
+      sumJackTrace += jack.covariance[0][0]+jack.covariance[1][1];
+      ++numEstimates;
+    }
+  }
+  double meanX=sumX/numTrials;
+  double meanY=sumY/numTrials;
+  double trueRMS=sqrt(sumX2/numTrials-meanX*meanX
+                      +sumY2/numTrials-meanY*meanY);
+  double bootRMS=sqrt(sumBootTrace/numEstimates);
+  double jackRMS=sqrt(sumJackTrace/numEstimates);
+
+  std::cout << " RMS spread of the ML fix " << trueRMS << " m, bootstrap "
+            << bootRMS << " m";
+  if (bootRMS > 0.7*trueRMS && bootRMS < 1.4*trueRMS)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+  std::cout << " RMS spread of the ML fix " << trueRMS << " m, jackknife "
+            << jackRMS << " m";
+  if (jackRMS > 0.7*trueRMS && jackRMS < 1.4*trueRMS)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The report collection gives the same answers as the arrays, and the
+  // replicates do not depend on the number of threads
+  std::vector<DFLib::XY::Report *> reports(n);
+  DFLib::ReportCollection rColl;
+  for (int i=0; i<n; ++i)
+  {
+    std::vector<double> loc(2);
+    loc[0]=rx[i];
+    loc[1]=ry[i];
+    reports[i]=new DFLib::XY::Report(loc,bearing[i]*180/M_PI,
+                                     sigma*180/M_PI,"r");
+    rColl.addReport(reports[i]);
+  }
+  std::vector<double> lsFix;
+  collection.computeLeastSquaresFix(lsFix);
+  DFLib::XY::Point lsPoint(lsFix);
+  DFLib::ResamplingEstimate fromArrays,fromReports;
+  collection.computeBootstrap(DFLib::LEAST_SQUARES_FIX,lsFix,100,
+                              fromArrays,7);
+#ifdef _OPENMP
+  int oldThreads=omp_get_max_threads();
+  omp_set_num_threads(3);
+#endif
+  rColl.computeBootstrap(DFLib::LEAST_SQUARES_FIX,lsPoint,100,fromReports,7);
+#ifdef _OPENMP
+  omp_set_num_threads(oldThreads);
+#endif
+  double worst=0;
+  for (int b=0; b<100; ++b)
+  {
+    worst=std::max(worst,fabs(fromArrays.replicateX[b]
+                              -fromReports.replicateX[b]));
+    worst=std::max(worst,fabs(fromArrays.replicateY[b]
+                              -fromReports.replicateY[b]));
+  }
+  std::cout << " Largest difference between collection and array replicates "
+            << worst << " m";
+  if (worst < 1e-6 && fromReports.numFailed==0 && !rColl.isMaterialized())
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Two reports are too few to leave one out
+  DFLib::ArrayCollection two(2,rx,ry,bearing,sigmas);
+  bool threw=false;
+  try
+  {
+    DFLib::ResamplingEstimate jack;
+    two.computeJackknife(DFLib::LEAST_SQUARES_FIX,lsFix,jack);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    threw=true;
+  }
+  std::cout << " Jackknife of two reports";
+  if (threw)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  for (int i=0; i<n; ++i)
+    delete reports[i];
+  return numFailed;
+}
@@ -0,0 +1,90 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : The receiver layout and bearings shared by the unit
+//                  tests.
+//
+// Special Notes  : Receivers sit on a spiral around the origin, so that
+//                  no two are at the same place and the bearings from
+//                  them cross at every angle.  Each test picks the
+//                  spiral's size and the transmitter location, and where
+//                  it wants noise, its own random stream.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UNIT_TEST_SCENES_HPP
+#define UNIT_TEST_SCENES_HPP
+
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include "gaussian_random.hpp"
+
+/// \brief n receivers on a spiral around the origin
+///
+/// Receiver i is radius+step*i from the origin, at angle0+i*dAngle
+/// radians clockwise from north.
+inline void spiralReceivers(int n, double radius, double step,
+                            double angle0, double dAngle,
+                            double *rx, double *ry)
+{
+  for (int i=0; i<n; ++i)
+  {
+    double a=angle0+i*dAngle;
+    rx[i]=(radius+step*i)*sin(a);
+    ry[i]=(radius+step*i)*cos(a);
+  }
+}
+
+/// \brief bearing in radians, in [0,2pi), from (rx,ry) to (tx,ty)
+inline double bearingTo(double rx, double ry, double tx, double ty)
+{
+  double bearing=atan2(tx-rx,ty-ry);
+  if (bearing<0)
+    bearing += 2*M_PI;
+  return bearing;
+}
+
+/// \brief bearings from n receivers to (tx,ty) with Gaussian errors
+///
+/// The error of bearing i is sigmas[i] times a deviate from noise, which
+/// should have mean 0 and standard deviation 1.  Bearings are not
+/// wrapped after the error is added.
+inline void noisyBearings(int n, const double *rx, const double *ry,
+                          double tx, double ty, const double *sigmas,
+                          DFLib::Util::gaussian_random_generator &noise,
+                          double *bearing)
+{
+  for (int i=0; i<n; ++i)
+    bearing[i]=bearingTo(rx[i],ry[i],tx,ty)+sigmas[i]*noise.getRandom();
+}
+#endif
@@ -0,0 +1,254 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Trace contour polygons of a function sampled on a
+//                  rectangular grid (marching squares).
+//
+// Special Notes  : Each grid cell contributes up to two line segments
+//                  whose ends lie on the cell's edges.  Every crossed
+//                  edge is shared by exactly two segments, so polygons
+//                  are built by walking from segment to segment through
+//                  shared edges.  The grid is padded by one cell of
+//                  "outside" on every side so that no walk can dead-end.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#include <map>
+#include "Util_Contour.hpp"
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief where the contour crosses one grid edge
+    struct ContourCrossing
+    {
+      double x;
+      double y;
+      int segment[2];
+      int numSegments;
+    };
+
+    /// \brief Helper holding the grid while contours are traced.
+    ///
+    /// Vertex (i,j) may be one outside the grid on any side.  Such
+    /// vertices are always outside the contour.
+    class ContourTracer
+    {
+    public:
+      ContourTracer(int nx, const double *gridX, int ny, const double *gridY,
+                    const double *values, double level)
+        : nx(nx), ny(ny), gridX(gridX), gridY(gridY), values(values),
+          level(level)
+      {};
+
+      void trace(std::vector<std::vector<double> > &polygons);
+
+    private:
+      int nx,ny;
+      const double *gridX;
+      const double *gridY;
+      const double *values;
+      double level;
+      std::map<long,ContourCrossing> crossings;
+      std::vector<long> segments;   // two edge ids per segment
+
+      inline bool inGrid(int i, int j) const
+      { return (i>=0 && i<nx && j>=0 && j<ny); };
+
+      inline bool inside(int i, int j) const
+      { return (inGrid(i,j) && values[j*nx+i]<=level); };
+
+      // Edge ids in the padded grid.  Horizontal edge (i,j)-(i+1,j) and
+      // vertical edge (i,j)-(i,j+1).
+      inline long hEdge(int i, int j) const
+      { return 2*(static_cast<long>(j+1)*(nx+2)+(i+1)); };
+      inline long vEdge(int i, int j) const
+      { return hEdge(i,j)+1; };
+
+      void addCrossing(long edge, int i0, int j0, int i1, int j1);
+      void addSegment(long edgeA, long edgeB);
+    };
+
+    /// \brief record where the contour crosses the edge (i0,j0)-(i1,j1)
+    void ContourTracer::addCrossing(long edge, int i0, int j0, int i1, int j1)
+    {
+      if (crossings.find(edge)!=crossings.end())
+        return;
+
+      ContourCrossing c;
+      c.numSegments=0;
+      if (inGrid(i0,j0) && inGrid(i1,j1))
+      {
+        double v0=values[j0*nx+i0];
+        double v1=values[j1*nx+i1];
+        double t=(level-v0)/(v1-v0);
+        c.x=gridX[i0]+t*(gridX[i1]-gridX[i0]);
+        c.y=gridY[j0]+t*(gridY[j1]-gridY[j0]);
+      }
+      else if (inGrid(i0,j0))
+      {
+        // Edge runs off the grid: put the crossing at the grid boundary
+        c.x=gridX[i0];
+        c.y=gridY[j0];
+      }
+      else
+      {
+        c.x=gridX[i1];
+        c.y=gridY[j1];
+      }
+      crossings[edge]=c;
+    }
+
+    void ContourTracer::addSegment(long edgeA, long edgeB)
+    {
+      int s=segments.size()/2;
+      segments.push_back(edgeA);
+      segments.push_back(edgeB);
+      ContourCrossing &a=crossings[edgeA];
+      a.segment[a.numSegments++]=s;
+      ContourCrossing &b=crossings[edgeB];
+      b.segment[b.numSegments++]=s;
+    }
+
+    void ContourTracer::trace(std::vector<std::vector<double> > &polygons)
+    {
+      polygons.clear();
+
+      // Segments, cell by cell, over the padded grid.  Corners are
+      // v0=(i,j), v1=(i+1,j), v2=(i+1,j+1), v3=(i,j+1); edges are
+      // e0=v0-v1, e1=v1-v2, e2=v3-v2, e3=v0-v3.
+      for (int j=-1; j<ny; ++j)
+      {
+        for (int i=-1; i<nx; ++i)
+        {
+          int caseIndex=(inside(i,j)?1:0) | (inside(i+1,j)?2:0)
+            | (inside(i+1,j+1)?4:0) | (inside(i,j+1)?8:0);
+          if (caseIndex==0 || caseIndex==15)
+            continue;
+
+          long e[4];
+          e[0]=hEdge(i,j);
+          e[1]=vEdge(i+1,j);
+          e[2]=hEdge(i,j+1);
+          e[3]=vEdge(i,j);
+          if ((caseIndex&1) != (caseIndex&2)>>1)
+            addCrossing(e[0],i,j,i+1,j);
+          if ((caseIndex&2)>>1 != (caseIndex&4)>>2)
+            addCrossing(e[1],i+1,j,i+1,j+1);
+          if ((caseIndex&8)>>3 != (caseIndex&4)>>2)
+            addCrossing(e[2],i,j+1,i+1,j+1);
+          if ((caseIndex&1) != (caseIndex&8)>>3)
+            addCrossing(e[3],i,j,i,j+1);
+
+          // Saddles only happen with all four corners on the grid.
+          // Resolve them by the value at the cell center.
+          bool centerInside=false;
+          if (caseIndex==5 || caseIndex==10)
+            centerInside=(0.25*(values[j*nx+i]+values[j*nx+i+1]
+                                +values[(j+1)*nx+i]+values[(j+1)*nx+i+1])
+                          <= level);
+
+          switch (caseIndex)
+          {
+          case 1:  case 14: addSegment(e[3],e[0]); break;
+          case 2:  case 13: addSegment(e[0],e[1]); break;
+          case 3:  case 12: addSegment(e[3],e[1]); break;
+          case 4:  case 11: addSegment(e[1],e[2]); break;
+          case 6:  case 9:  addSegment(e[0],e[2]); break;
+          case 7:  case 8:  addSegment(e[3],e[2]); break;
+          case 5:
+            if (centerInside)
+            {
+              addSegment(e[0],e[1]);
+              addSegment(e[2],e[3]);
+            }
+            else
+            {
+              addSegment(e[3],e[0]);
+              addSegment(e[1],e[2]);
+            }
+            break;
+          case 10:
+            if (centerInside)
+            {
+              addSegment(e[3],e[0]);
+              addSegment(e[1],e[2]);
+            }
+            else
+            {
+              addSegment(e[0],e[1]);
+              addSegment(e[2],e[3]);
+            }
+            break;
+          }
+        }
+      }
+
+      // Walk the segments into closed polygons.
+      int numSegments=segments.size()/2;
+      std::vector<bool> used(numSegments,false);
+      for (int start=0; start<numSegments; ++start)
+      {
+        if (used[start])
+          continue;
+
+        std::vector<double> polygon;
+        long firstEdge=segments[2*start];
+        long edge=segments[2*start+1];
+        int s=start;
+        used[s]=true;
+        polygon.push_back(crossings[firstEdge].x);
+        polygon.push_back(crossings[firstEdge].y);
+        while (edge != firstEdge)
+        {
+          const ContourCrossing &c=crossings[edge];
+          polygon.push_back(c.x);
+          polygon.push_back(c.y);
+          s=(c.segment[0]==s)?c.segment[1]:c.segment[0];
+          used[s]=true;
+          edge=(segments[2*s]==edge)?segments[2*s+1]:segments[2*s];
+        }
+        polygons.push_back(polygon);
+      }
+    }
+
+    void contourPolygons(int nx, const double *gridX,
+                         int ny, const double *gridY,
+                         const double *values, double level,
+                         std::vector<std::vector<double> > &polygons)
+    {
+      ContourTracer tracer(nx,gridX,ny,gridY,values,level);
+      tracer.trace(polygons);
+    }
+  }
+}
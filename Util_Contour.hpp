@@ -0,0 +1,70 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Trace contour polygons of a function sampled on a
+//                  rectangular grid (marching squares).
+//
+// Special Notes  : Points outside the grid are treated as outside the
+//                  contour, so every polygon returned is closed, even
+//                  where the region runs off the edge of the grid.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UTIL_CONTOUR_HPP
+#define UTIL_CONTOUR_HPP
+#include "DFLib_port.h"
+
+#include <vector>
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief Trace the boundaries of the region where values <= level
+    ///
+    /// \param nx number of grid x coordinates
+    /// \param gridX grid x coordinates, increasing
+    /// \param ny number of grid y coordinates
+    /// \param gridY grid y coordinates, increasing
+    /// \param values function values, row-major: values[j*nx+i] is the
+    ///        value at (gridX[i],gridY[j])
+    /// \param level contour level
+    /// \param polygons returned boundary polygons.  Each is a flat list
+    ///        x0,y0,x1,y1,... of vertices, with the last vertex
+    ///        implicitly joined back to the first.  Holes in the region
+    ///        come back as separate polygons.
+    CPL_DLL void contourPolygons(int nx, const double *gridX,
+                                 int ny, const double *gridY,
+                                 const double *values, double level,
+                                 std::vector<std::vector<double> > &polygons);
+  }
+}
+#endif // UTIL_CONTOUR_HPP
@@ -0,0 +1,128 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Angle arithmetic for bearing computations: atan2 and
+//                  wrapping of angles, with atan2 at a precision chosen
+//                  when DFLib is built.
+//
+// Special Notes  : By default angleAtan2 is just the libm atan2.
+//                  Building with DFLIB_FAST_ANGLES defined (the
+//                  DFLIB_FAST_ANGLES CMake option, or configure
+//                  --enable-fast-angles) switches it to the polynomial
+//                  approximation below, which is good to better than
+//                  1e-6 radians.  That is far below any real bearing
+//                  error, but fixes then differ from the default build in
+//                  the sixth or seventh digit.
+//
+//                  There is no sine or cosine here.  Those of the
+//                  reported bearings are computed once per report and
+//                  kept, and those of the bearing to a point come from
+//                  the displacement to it, without trig.
+//
+//                  Nothing here branches on its argument: the selections
+//                  are written so the compiler can use conditional moves,
+//                  which lets loops over reports vectorize.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UTIL_FAST_MATH_HPP
+#define UTIL_FAST_MATH_HPP
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include "DFLib_port.h"
+
+#include <cmath>
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief atan2(y,x) with error below 2.5e-7 radians
+    ///
+    /// The ratio of the smaller to the larger of |x| and |y| is in
+    /// [0,1], where a degree 13 odd polynomial fits atan to that error.
+    /// The octant is then restored.  atan2Bounded(0,0) is 0, as
+    /// atan2(0,0) is.
+    inline double atan2Bounded(double y, double x)
+    {
+      double ax=fabs(x);
+      double ay=fabs(y);
+      double larger=(ay>ax)?ay:ax;
+      double smaller=(ay>ax)?ax:ay;
+      double t=(larger>0)?smaller/larger:0.0;
+      double t2=t*t;
+      double a=t*(0.99999611154884294
+                  +t2*(-0.3331736803551823
+                  +t2*(0.19807815323230751
+                  +t2*(-0.13233341028712445
+                  +t2*(0.079623651144986832
+                  +t2*(-0.033604201083074443
+                  +t2*0.0068117865746754862))))));
+      a=(ay>ax)?M_PI/2-a:a;
+      a=(x<0)?M_PI-a:a;
+      return (y<0)?-a:a;
+    }
+
+    /// \brief atan2 at the precision DFLib was built with
+    inline double angleAtan2(double y, double x)
+    {
+#ifdef DFLIB_FAST_ANGLES
+      return atan2Bounded(y,x);
+#else
+      return atan2(y,x);
+#endif
+    }
+
+    /// \brief a moved into \f$-\pi<a\le\pi\f$
+    ///
+    /// For \f$|a|<3\pi\f$, which covers the difference of any two
+    /// bearings in \f$[0,2\pi]\f$.  The result is exactly what adding or
+    /// subtracting \f$2\pi\f$ in a loop would give.
+    inline double wrapAngle(double a)
+    {
+      a += (a<=-M_PI)?2*M_PI:0.0;
+      a -= (a>M_PI)?2*M_PI:0.0;
+      return a;
+    }
+
+    /// \brief a moved into \f$0\le a<2\pi\f$, for \f$-2\pi\le a<4\pi\f$
+    ///
+    /// Turns what atan2 returns into a bearing.
+    inline double wrapBearing(double a)
+    {
+      a += (a<0)?2*M_PI:0.0;
+      a -= (a>=2*M_PI)?2*M_PI:0.0;
+      return a;
+    }
+  }
+}
+#endif
@@ -0,0 +1,78 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Sanity test applied to computed fixes by the drivers.
+//
+// Special Notes  : testlsDF_mc and dfd both count a fix that is not
+//                  finite, or that lands absurdly far from the
+//                  receivers, as a failed fix.  testlsDF_proj makes the
+//                  same test inline when deciding whether to retry ML.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UTIL_FIX_CHECK_HPP
+#define UTIL_FIX_CHECK_HPP
+#include "DFLib_port.h"
+
+#include <cmath>
+#include <vector>
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief 100 miles in meters.  Fixes farther than this from a
+    /// receiver are not to be trusted.
+    const double ridiculousDistance=100*1609.344;
+
+    /// \brief true if fix is finite and not absurdly far from a receiver
+    ///
+    /// \param fix fix in mercator XY
+    /// \param receiver a receiver location in mercator XY
+    /// \param mercScale cosine of the latitude, to turn mercator meters
+    ///        into meters on the ground
+    ///
+    /// Does not use the transmitter location, so can be applied to real
+    /// data as well as simulations.
+    inline bool fixIsReasonable(const std::vector<double> &fix,
+                                const std::vector<double> &receiver,
+                                double mercScale)
+    {
+      // v-v is NaN unless v is finite
+      if (!(fix[0]-fix[0]==0 && fix[1]-fix[1]==0))
+        return false;
+      double dx=fix[0]-receiver[0];
+      double dy=fix[1]-receiver[1];
+      return (sqrt(dx*dx+dy*dy)*mercScale <= ridiculousDistance);
+    }
+  }
+}
+#endif
@@ -0,0 +1,148 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Sums over large collections that are accurate, and
+//                  that come out the same to the last bit however many
+//                  threads compute them.
+//
+// Special Notes  : Items are summed in blocks of a fixed size, each
+//                  block with Neumaier's compensated summation, and the
+//                  block totals are then added pairwise.  The blocks and
+//                  the order of every addition depend only on the number
+//                  of items, so with OpenMP the blocks may be shared out
+//                  among threads in any way without changing the result.
+//
+//                  Compiling with -ffast-math or similar lets the
+//                  compiler reassociate the compensated sums, which
+//                  undoes the compensation.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UTIL_REDUCTION_HPP
+#define UTIL_REDUCTION_HPP
+#include "DFLib_port.h"
+
+#include <cmath>
+#include <vector>
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief Neumaier's compensated sum
+    ///
+    /// Keeps the low order bits lost by each addition in a second sum,
+    /// so the error does not grow with the number of terms.
+    class NeumaierSum
+    {
+    private:
+      double sum;
+      double compensation;
+    public:
+      NeumaierSum() : sum(0), compensation(0) {};
+      inline void add(double x)
+      {
+        double t=sum+x;
+        if (fabs(sum)>=fabs(x))
+          compensation += (sum-t)+x;
+        else
+          compensation += (x-t)+sum;
+        sum=t;
+      };
+      inline double value() const { return sum+compensation; };
+    };
+
+    /// \brief number of items in each block of deterministicSum
+    const int reductionBlockSize=1024;
+
+    /// \brief sum of count values stride apart, by halves
+    inline double pairwiseSum(const double *values, int count, int stride)
+    {
+      if (count<=0)
+        return 0;
+      if (count==1)
+        return values[0];
+      int half=count/2;
+      return (pairwiseSum(values,half,stride)
+              +pairwiseSum(values+half*stride,count-half,stride));
+    }
+
+    /// \brief N sums over items 0 to n-1, the same for any thread count
+    ///
+    /// \param n number of items
+    /// \param terms function object, with a method
+    ///   <tt>bool operator()(int i, double *t) const</tt> that puts the N
+    ///   terms of item i in t and returns true, or returns false if item
+    ///   i adds nothing.  It is called from several threads at once, for
+    ///   different items.
+    /// \param totals on return, the N sums
+    template <int N, class Terms>
+    void deterministicSum(int n, const Terms &terms, double *totals)
+    {
+      int numBlocks=(n+reductionBlockSize-1)/reductionBlockSize;
+      // Most collections are one block, which needs no allocation
+      double oneBlock[N];
+      std::vector<double> manyBlocks;
+      double *blockTotals=oneBlock;
+      if (numBlocks>1)
+      {
+        manyBlocks.resize(N*numBlocks);
+        blockTotals=&manyBlocks[0];
+      }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static) if(numBlocks>1)
+#endif
+      for (int b=0; b<numBlocks; ++b)
+      {
+        NeumaierSum sums[N];
+        double t[N];
+        int end=(b+1)*reductionBlockSize;
+        if (end>n)
+          end=n;
+        for (int i=b*reductionBlockSize; i<end; ++i)
+        {
+          if (terms(i,t))
+          {
+            for (int k=0; k<N; ++k)
+              sums[k].add(t[k]);
+          }
+        }
+        for (int k=0; k<N; ++k)
+          blockTotals[b*N+k]=sums[k].value();
+      }
+
+      for (int k=0; k<N; ++k)
+        totals[k]=pairwiseSum(&blockTotals[k],numBlocks,N);
+    }
+  }
+}
+#endif
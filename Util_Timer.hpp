@@ -0,0 +1,87 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Portable wall clock and thread count queries for the
+//                  test harnesses and drivers.
+//
+// Special Notes  : When built with OpenMP we just use the OpenMP runtime's
+//                  clock, otherwise fall back to whatever the platform
+//                  has.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifndef UTIL_TIMER_HPP
+#define UTIL_TIMER_HPP
+#include "DFLib_port.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#elif defined(_MSC_VER)
+#include <windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+namespace DFLib
+{
+  namespace Util
+  {
+    /// \brief return wall clock time in seconds from some arbitrary origin
+    ///
+    /// Only differences between two calls are meaningful.
+    inline double wallClockSeconds()
+    {
+#ifdef _OPENMP
+      return omp_get_wtime();
+#elif defined(_MSC_VER)
+      LARGE_INTEGER count,freq;
+      QueryPerformanceCounter(&count);
+      QueryPerformanceFrequency(&freq);
+      return ((double)count.QuadPart/(double)freq.QuadPart);
+#else
+      struct timeval tv;
+      gettimeofday(&tv,0);
+      return (tv.tv_sec+1e-6*tv.tv_usec);
+#endif
+    }
+
+    /// \brief return the number of threads a parallel region will use
+    inline int maxThreads()
+    {
+#ifdef _OPENMP
+      return omp_get_max_threads();
+#else
+      return 1;
+#endif
+    }
+  }
+}
+#endif
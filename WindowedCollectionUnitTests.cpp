@@ -0,0 +1,189 @@
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Tests of the time-windowed report collection.
+//
+// Special Notes  : A stream of reports runs through a short window long
+//                  enough for the ring to grow, wrap and refresh its sums
+//                  many times.  Fixes of the window are checked against
+//                  an ArrayCollection built from scratch from the reports
+//                  that should be in it.
+//
+// Creator        : 
+//
+// Creation Date  : 
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Array_Collection.hpp"
+#include "DF_Windowed_Collection.hpp"
+#include "gaussian_random.hpp"
+
+int main(int argc, char **argv)
+{
+  int numFailed=0;
+
+  // Five receivers take turns reporting a transmitter at (1000,2000)
+  // every 3 seconds, with 2 degree errors.  Every seventh report is
+  // invalid.  The window is 60 seconds long.
+  double receiverX[5]={-4000,5000,3000,-2000,6000};
+  double receiverY[5]={-3000,-1000,7000,6000,4000};
+  DFLib::Util::gaussian_random_generator noise(0,2*M_PI/180,20091001,2);
+  std::vector<double> allX,allY,allBearing,allSigma,allTime;
+  std::vector<unsigned char> allValid;
+  const double windowLength=60;
+  DFLib::WindowedCollection windowed(windowLength,4);
+
+  double worstLS=0;
+  double worstML=0;
+  bool sizesRight=true;
+  for (int k=0; k<2000; ++k)
+  {
+    double t=3*k;
+    double x=receiverX[k%5];
+    double y=receiverY[k%5];
+    double b=atan2(1000-x,2000-y)+noise.getRandom();
+    if (b<0)
+      b += 2*M_PI;
+    allX.push_back(x);
+    allY.push_back(y);
+    allBearing.push_back(b);
+    allSigma.push_back(2*M_PI/180);
+    allTime.push_back(t);
+    allValid.push_back((k%7==6)?0:1);
+    windowed.addReport(t,x,y,b,2*M_PI/180,allValid.back()!=0);
+
+    if (k<10)
+      continue;
+
+    // What should be in the window right now
+    int first=0;
+    while (allTime[first] < t-windowLength)
+      ++first;
+    int n=k+1-first;
+    int numValid=0;
+    for (int i=first; i<=k; ++i)
+      numValid += allValid[i];
+    if (windowed.size()!=n || windowed.numValidReports()!=numValid)
+      sizesRight=false;
+
+    DFLib::ArrayCollection reference(n,&allX[first],&allY[first],
+                                     &allBearing[first],&allSigma[first],
+                                     &allValid[first]);
+    std::vector<double> refLS,LS;
+    reference.computeLeastSquaresFix(refLS);
+    windowed.computeLeastSquaresFix(LS);
+    worstLS=std::max(worstLS,sqrt((LS[0]-refLS[0])*(LS[0]-refLS[0])
+                                  +(LS[1]-refLS[1])*(LS[1]-refLS[1])));
+
+    std::vector<double> refML(refLS),ML(refLS);
+    reference.computeMLFix(refML);
+    windowed.computeMLFix(ML);
+    worstML=std::max(worstML,sqrt((ML[0]-refML[0])*(ML[0]-refML[0])
+                                  +(ML[1]-refML[1])*(ML[1]-refML[1])));
+  }
+
+  std::cout << " Window sizes match the reports within the window";
+  if (sizesRight)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Worst LS fix difference from rebuilt collection: "
+            << worstLS << " m";
+  if (worstLS < 1e-6)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // The ring sums the cost function in a different order, which is
+  // enough to move where conjugate gradients stops, but not by much.
+  std::cout << " Worst ML fix difference from rebuilt collection: "
+            << worstML << " m";
+  if (worstML < 1e-2)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  std::cout << " Oldest and newest times " << windowed.getOldestTime()
+            << " " << windowed.getNewestTime();
+  if (windowed.getNewestTime()==allTime.back()
+      && windowed.getOldestTime()==allTime.back()-windowLength)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  // Reports carry their own times
+  std::vector<double> location(2);
+  location[0]=receiverX[0];
+  location[1]=receiverY[0];
+  DFLib::XY::Report report(location,30,2,"late report");
+  report.setReportTime(allTime.back()+1000);
+  windowed.addReport(&report);
+  std::cout << " Report far in the future leaves " << windowed.size()
+            << " report in the window";
+  if (windowed.size()==1)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  int numExpired=windowed.expire(allTime.back()+2000);
+  std::cout << " Expiring everything dropped " << numExpired;
+  if (numExpired==1 && windowed.size()==0 && windowed.numValidReports()==0)
+    std::cout << " PASSED " << std::endl;
+  else
+  {
+    std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
+
+  return numFailed;
+}
@@ -36,13 +36,15 @@
 //
 // Current Owner  : $Author$
 //-------------------------------------------------------------------------
+#include <cmath>
 #include <iostream>
 #include <vector>
 
 #include "DF_XY_Point.hpp"
 
-main(int argc, char **argv)
+int main(int argc, char **argv)
 {
+  int numFailed=0;
 
   std::vector<double> xyVals(2);
   xyVals[0]=1;
@@ -60,7 +62,10 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
 
   std::cout << " Resetting XY in stored point to X=2,Y=2 " << std::endl;
   xyVals[0]=xyVals[1]=2;
@@ -73,7 +78,10 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
 
   std::cout << " Cloning point. " << std::endl;
   DFLib::XY::Point *mySecondPointPtr = myFirstPoint.Clone();
@@ -85,7 +93,10 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
   std::cout << " Resetting XY in cloned point to X=0,Y=1 " << std::endl;
   xyVals[0]=0;
   xyVals[1]=1;
@@ -98,6 +109,10 @@ main(int argc, char **argv)
   if (xyStored[0] == xyVals[0] && xyStored[1] == xyVals[1])
     std::cout << " PASSED " << std::endl;
   else
+  {
     std::cout << " FAILED " << std::endl;
+    ++numFailed;
+  }
 
+  return numFailed;
 }
@@ -0,0 +1,798 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Long-running DF fix daemon.  Reads a line protocol of
+//                  report add/update/invalidate/remove messages from stdin,
+//                  a file, or a Unix domain socket, keeps one live
+//                  ReportCollection per emitter, and emits LS, ML and
+//                  Stansfield fixes with error ellipses whenever an
+//                  emitter's reports change.
+//
+// Special Notes  : Only the emitter named in a message is recomputed.  All
+//                  other emitters keep their cached fixes.  The protocol
+//                  is described in the doxygen comment on main() below.
+//
+//                  Unix domain sockets are not available on Windows; there
+//                  the daemon only reads stdin or a file.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <proj_api.h>
+extern "C" {
+  double dmstor(const char *, char **);
+}
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <signal.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#endif
+
+#include "DF_Proj_Point.hpp"
+#include "DF_Proj_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "Util_Misc.hpp"
+#include "Util_Timer.hpp"
+#include "Util_Fix_Check.hpp"
+
+// Number of recent latency samples kept per command for the percentiles
+#define LATENCY_WINDOW 4096
+
+/// \brief Fixes most recently computed for one emitter.
+struct FixResult
+{
+  bool haveLS;
+  bool haveML;
+  bool haveStansfield;
+  std::vector<double> LS;
+  std::vector<double> ML;
+  std::vector<double> Stansfield;
+  double MLEllipse[3];          // a, b (meters), phi (degrees)
+  double StansfieldEllipse[3];
+  bool haveMLEllipse;
+  bool haveStansfieldEllipse;
+};
+
+/// \brief Live state for one emitter.
+///
+/// The collection does not own its reports, so we keep them by name here
+/// and delete them ourselves.
+struct EmitterState
+{
+  DFLib::ReportCollection collection;
+  std::map<std::string,DFLib::Proj::Report *> reports;
+  std::vector<double> lastLocation;   // lon/lat of most recent report
+  unsigned long sequence;             // bumped every time the fix changes
+  FixResult fix;
+
+  EmitterState() : sequence(0) {};
+  ~EmitterState()
+  {
+    collection.deleteReports();
+  };
+};
+
+/// \brief Latency samples for one command.
+struct LatencyStats
+{
+  unsigned long count;
+  double total;
+  double max;
+  std::vector<double> recent;
+  int next;
+
+  LatencyStats() : count(0), total(0), max(0), next(0) {};
+
+  void record(double seconds)
+  {
+    ++count;
+    total += seconds;
+    if (seconds > max)
+      max=seconds;
+    if (recent.size() < LATENCY_WINDOW)
+      recent.push_back(seconds);
+    else
+    {
+      recent[next]=seconds;
+      next = (next+1)%LATENCY_WINDOW;
+    }
+  };
+
+  /// \brief nearest-rank percentile, as testlsDF_mc reports its errors
+  ///
+  /// The smallest sample with at least a fraction p of the samples at
+  /// or below it, so the median of an even count is the lower middle.
+  double percentile(double p) const
+  {
+    if (recent.empty())
+      return 0;
+    std::vector<double> sorted(recent);
+    std::sort(sorted.begin(),sorted.end());
+    int i=static_cast<int>(ceil(p*sorted.size()))-1;
+    if (i<0)
+      i=0;
+    return sorted[i];
+  };
+};
+
+class FixDaemon
+{
+public:
+  FixDaemon(double declination);
+  ~FixDaemon();
+
+  /// \brief Handle one protocol line, appending any replies to out.
+  ///
+  /// \return false if the line asked to end the session.
+  bool processLine(const std::string &line, std::ostream &out);
+
+private:
+  typedef std::map<std::string,EmitterState *> EmitterMap;
+
+  EmitterMap emitters;
+  std::map<std::string,LatencyStats> latencies;
+  std::vector<std::string> WGS84_args;
+  double magDec;
+  double startTime;
+
+  bool handleCommand(const std::string &command, std::istringstream &args,
+                     std::ostream &out);
+  bool readReport(std::istringstream &args, std::vector<double> &lonlat,
+                  double &bearing, double &sd);
+  EmitterState *findEmitter(const std::string &id);
+  void recompute(EmitterState &emitter);
+  void printFix(const std::string &id, const EmitterState &emitter,
+                std::ostream &out) const;
+  void printStats(std::ostream &out) const;
+};
+
+FixDaemon::FixDaemon(double declination)
+  : magDec(declination)
+{
+  WGS84_args.push_back("proj=latlong");
+  WGS84_args.push_back("datum=WGS84");
+  startTime=DFLib::Util::wallClockSeconds();
+}
+
+FixDaemon::~FixDaemon()
+{
+  for (EmitterMap::iterator it=emitters.begin(); it!=emitters.end(); ++it)
+    delete it->second;
+}
+
+EmitterState *FixDaemon::findEmitter(const std::string &id)
+{
+  EmitterMap::iterator it=emitters.find(id);
+  if (it == emitters.end())
+    return 0;
+  return it->second;
+}
+
+bool FixDaemon::processLine(const std::string &line, std::ostream &out)
+{
+  std::istringstream args(line);
+  std::string command;
+
+  if (!(args >> command) || command[0] == '#')
+    return true;
+
+  double t0=DFLib::Util::wallClockSeconds();
+  bool keepGoing=handleCommand(command,args,out);
+  latencies[command].record(DFLib::Util::wallClockSeconds()-t0);
+  return keepGoing;
+}
+
+bool FixDaemon::readReport(std::istringstream &args,
+                           std::vector<double> &lonlat,
+                           double &bearing, double &sd)
+{
+  std::string lon,lat;
+  if (!(args >> lon >> lat >> bearing >> sd))
+    return false;
+  lonlat.resize(2);
+  lonlat[0]=dmstor(lon.c_str(),NULL)*RAD_TO_DEG;
+  lonlat[1]=dmstor(lat.c_str(),NULL)*RAD_TO_DEG;
+  bearing += magDec;
+  return (sd > 0);
+}
+
+bool FixDaemon::handleCommand(const std::string &command,
+                              std::istringstream &args,
+                              std::ostream &out)
+{
+  std::string id,name;
+
+  if (command == "quit")
+  {
+    out << "ok bye" << std::endl;
+    return false;
+  }
+  else if (command == "stats")
+  {
+    printStats(out);
+    return true;
+  }
+  else if (command == "fix")
+  {
+    if (args >> id)
+    {
+      EmitterState *emitter=findEmitter(id);
+      if (emitter)
+        printFix(id,*emitter,out);
+      else
+        out << "error unknown emitter " << id << std::endl;
+    }
+    else
+    {
+      for (EmitterMap::const_iterator it=emitters.begin();
+           it!=emitters.end(); ++it)
+        printFix(it->first,*(it->second),out);
+    }
+    return true;
+  }
+  else if (command == "drop")
+  {
+    if (!(args >> id))
+      out << "error usage: drop EMITTER" << std::endl;
+    else
+    {
+      EmitterMap::iterator it=emitters.find(id);
+      if (it == emitters.end())
+        out << "error unknown emitter " << id << std::endl;
+      else
+      {
+        delete it->second;
+        emitters.erase(it);
+        out << "ok dropped " << id << std::endl;
+      }
+    }
+    return true;
+  }
+
+  // Everything else is a report message: COMMAND EMITTER NAME ...
+  if (!(args >> id >> name))
+  {
+    out << "error usage: " << command << " EMITTER NAME ..." << std::endl;
+    return true;
+  }
+
+  EmitterState *emitter=findEmitter(id);
+  DFLib::Proj::Report *report=0;
+  if (emitter)
+  {
+    std::map<std::string,DFLib::Proj::Report *>::iterator rit;
+    rit=emitter->reports.find(name);
+    if (rit != emitter->reports.end())
+      report=rit->second;
+  }
+
+  bool changed=false;
+  if (command == "add" || command == "update")
+  {
+    std::vector<double> lonlat;
+    double bearing,sd;
+    if (!readReport(args,lonlat,bearing,sd))
+    {
+      out << "error usage: " << command
+          << " EMITTER NAME LON LAT BEARING STDDEV" << std::endl;
+      return true;
+    }
+    if (command == "add" && report)
+    {
+      out << "error report " << name << " already exists for emitter "
+          << id << std::endl;
+      return true;
+    }
+    if (command == "update" && !report)
+    {
+      out << "error unknown report " << name << " for emitter " << id
+          << std::endl;
+      return true;
+    }
+    if (!emitter)
+    {
+      emitter=new EmitterState;
+      emitters[id]=emitter;
+    }
+    if (report)
+    {
+      report->setReceiverLocationUser(lonlat);
+      report->setBearing(bearing);
+      report->setSigma(sd);
+    }
+    else
+    {
+      report=new DFLib::Proj::Report(lonlat,bearing,sd,name,WGS84_args);
+      emitter->reports[name]=report;
+      emitter->collection.addReport(report);
+    }
+    emitter->lastLocation=lonlat;
+    changed=true;
+  }
+  else if (command == "invalidate" || command == "validate"
+           || command == "remove")
+  {
+    if (!report)
+    {
+      out << "error unknown report " << name << " for emitter " << id
+          << std::endl;
+      return true;
+    }
+    if (command == "remove")
+    {
+      int i=emitter->collection.getReportIndex(report);
+      emitter->collection.removeReport(i);
+      emitter->reports.erase(name);
+      delete report;
+      changed=true;
+    }
+    else
+    {
+      // Only a real change of state costs a recompute
+      changed = (report->isValid() != (command == "validate"));
+      if (changed)
+        report->toggleValidity();
+    }
+  }
+  else
+  {
+    out << "error unknown command " << command << std::endl;
+    return true;
+  }
+
+  if (changed)
+  {
+    recompute(*emitter);
+    ++(emitter->sequence);
+  }
+  printFix(id,*emitter,out);
+  return true;
+}
+
+/// \brief convert library ellipse parameters to meters on the ground
+///
+/// am2 and bm2 are inverse squared semi-axes in mercator meters.  Mercator
+/// stretches distances by 1/cos(latitude), so multiply back by the cosine.
+bool ellipseToMeters(double am2, double bm2, double phi, double mercScale,
+                     double ellipse[3])
+{
+  if (!(am2 > 0 && bm2 > 0))
+    return false;
+  ellipse[0]=sqrt(1/am2)*mercScale;
+  ellipse[1]=sqrt(1/bm2)*mercScale;
+  ellipse[2]=phi*RAD_TO_DEG;
+  return true;
+}
+
+void FixDaemon::recompute(EmitterState &emitter)
+{
+  DFLib::ReportCollection &rColl=emitter.collection;
+  FixResult &fix=emitter.fix;
+
+  fix.haveLS=fix.haveML=fix.haveStansfield=false;
+  fix.haveMLEllipse=fix.haveStansfieldEllipse=false;
+
+  if (rColl.numValidReports() < 2)
+    return;
+
+  // As in SimpleDF, the LS fix only needs a properly initialized point to
+  // put its answer in.
+  DFLib::Proj::Point LSFix(emitter.lastLocation,WGS84_args);
+  try
+  {
+    rColl.computeLeastSquaresFix(LSFix);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    return;
+  }
+  fix.LS=LSFix.getUserCoords();
+  double mercScale=cos(fix.LS[1]*DEG_TO_RAD);
+  const std::vector<double> &receiver0=rColl.getReceiverLocationXY(0);
+  fix.haveLS=DFLib::Util::fixIsReasonable(LSFix.getXY(),receiver0,mercScale);
+  if (!fix.haveLS)
+    return;
+
+  // ML starts from the LS fix, and tries harder if conjugate gradients
+  // wanders off.
+  DFLib::Proj::Point MLFix(LSFix);
+  try
+  {
+    rColl.computeMLFix(MLFix);
+    if (!DFLib::Util::fixIsReasonable(MLFix.getXY(),receiver0,mercScale))
+    {
+      MLFix.setXY(LSFix.getXY());
+      rColl.aggressiveComputeMLFix(MLFix);
+    }
+    fix.haveML=DFLib::Util::fixIsReasonable(MLFix.getXY(),receiver0,mercScale);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    fix.haveML=false;
+  }
+  if (fix.haveML)
+  {
+    double am2,bm2,phi;
+    fix.ML=MLFix.getUserCoords();
+    rColl.computeCramerRaoBounds(MLFix,am2,bm2,phi);
+    fix.haveMLEllipse=ellipseToMeters(am2,bm2,phi,mercScale,fix.MLEllipse);
+  }
+
+  DFLib::Proj::Point StansfieldFix(LSFix);
+  try
+  {
+    double am2,bm2,phi;
+    rColl.computeStansfieldFix(StansfieldFix,am2,bm2,phi);
+    fix.haveStansfield=DFLib::Util::fixIsReasonable(StansfieldFix.getXY(),
+                                                    receiver0,mercScale);
+    if (fix.haveStansfield)
+    {
+      fix.Stansfield=StansfieldFix.getUserCoords();
+      fix.haveStansfieldEllipse=ellipseToMeters(am2,bm2,phi,mercScale,
+                                                fix.StansfieldEllipse);
+    }
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    fix.haveStansfield=false;
+  }
+}
+
+void printPoint(const char *label, bool have, const std::vector<double> &p,
+                std::ostream &out)
+{
+  out << " " << label << "=";
+  if (have)
+    out << p[0] << "," << p[1];
+  else
+    out << "none";
+}
+
+void printEllipse(const char *label, bool have, const double ellipse[3],
+                  std::ostream &out)
+{
+  out << " " << label << "=";
+  if (have)
+    out << ellipse[0] << "," << ellipse[1] << "," << ellipse[2];
+  else
+    out << "none";
+}
+
+void FixDaemon::printFix(const std::string &id, const EmitterState &emitter,
+                         std::ostream &out) const
+{
+  const FixResult &fix=emitter.fix;
+  std::ios_base::fmtflags oldFlags=out.flags();
+  std::streamsize oldPrecision=out.precision(8);
+
+  out << "fix " << id << " seq=" << emitter.sequence
+      << " reports=" << emitter.collection.numValidReports() << "/"
+      << emitter.collection.size();
+  printPoint("ls",fix.haveLS,fix.LS,out);
+  printPoint("ml",fix.haveML,fix.ML,out);
+  printEllipse("ml_ellipse",fix.haveMLEllipse,fix.MLEllipse,out);
+  printPoint("stansfield",fix.haveStansfield,fix.Stansfield,out);
+  printEllipse("stansfield_ellipse",fix.haveStansfieldEllipse,
+               fix.StansfieldEllipse,out);
+  out << std::endl;
+
+  out.flags(oldFlags);
+  out.precision(oldPrecision);
+}
+
+void FixDaemon::printStats(std::ostream &out) const
+{
+  int numReports=0;
+  for (EmitterMap::const_iterator it=emitters.begin(); it!=emitters.end();
+       ++it)
+    numReports += it->second->collection.size();
+
+  out << "stats uptime_s=" << DFLib::Util::wallClockSeconds()-startTime
+      << " emitters=" << emitters.size()
+      << " reports=" << numReports << std::endl;
+
+  std::map<std::string,LatencyStats>::const_iterator it;
+  for (it=latencies.begin(); it!=latencies.end(); ++it)
+  {
+    const LatencyStats &l=it->second;
+    out << "latency " << it->first
+        << " count=" << l.count
+        << " mean_us=" << 1e6*l.total/l.count
+        << " p50_us=" << 1e6*l.percentile(0.5)
+        << " p99_us=" << 1e6*l.percentile(0.99)
+        << " max_us=" << 1e6*l.max << std::endl;
+  }
+}
+
+/// \brief Run the daemon on a stream until EOF or "quit".
+void serveStream(FixDaemon &daemon, std::istream &in)
+{
+  std::string line;
+  while (std::getline(in,line))
+  {
+    if (!daemon.processLine(line,std::cout))
+      break;
+    std::cout.flush();
+  }
+}
+
+#ifndef _WIN32
+/// \brief write all of a buffer to a socket
+bool writeAll(int fd, const std::string &data)
+{
+  size_t done=0;
+  while (done < data.size())
+  {
+    ssize_t n=write(fd,data.data()+done,data.size()-done);
+    if (n <= 0)
+      return false;
+    done += n;
+  }
+  return true;
+}
+
+bool fillSocketAddress(const std::string &path, struct sockaddr_un &addr)
+{
+  if (path.size() >= sizeof(addr.sun_path))
+  {
+    std::cerr << "Socket path too long: " << path << std::endl;
+    return false;
+  }
+  memset(&addr,0,sizeof(addr));
+  addr.sun_family=AF_UNIX;
+  strcpy(addr.sun_path,path.c_str());
+  return true;
+}
+
+/// \brief Serve one client at a time on a Unix domain socket, forever.
+///
+/// Each client sees the same emitter state.  A client's "quit" only
+/// closes that client's connection.
+int serveSocket(FixDaemon &daemon, const std::string &path)
+{
+  struct sockaddr_un addr;
+  if (!fillSocketAddress(path,addr))
+    return 1;
+
+  int listenFd=socket(AF_UNIX,SOCK_STREAM,0);
+  if (listenFd < 0)
+  {
+    perror("socket");
+    return 1;
+  }
+  unlink(path.c_str());
+  if (bind(listenFd,(struct sockaddr *)&addr,sizeof(addr)) < 0
+      || listen(listenFd,4) < 0)
+  {
+    perror(path.c_str());
+    close(listenFd);
+    return 1;
+  }
+  // A client that goes away mid-reply must not kill the daemon
+  signal(SIGPIPE,SIG_IGN);
+  std::cerr << "dfd listening on " << path << std::endl;
+
+  while (true)
+  {
+    int fd=accept(listenFd,NULL,NULL);
+    if (fd < 0)
+      continue;
+
+    std::string pending;
+    char buffer[4096];
+    bool open=true;
+    ssize_t n;
+    while (open && (n=read(fd,buffer,sizeof(buffer))) > 0)
+    {
+      pending.append(buffer,n);
+      std::string::size_type eol;
+      while (open && (eol=pending.find('\n')) != std::string::npos)
+      {
+        std::ostringstream reply;
+        open=daemon.processLine(pending.substr(0,eol),reply);
+        pending.erase(0,eol+1);
+        if (!writeAll(fd,reply.str()))
+          open=false;
+      }
+    }
+    close(fd);
+  }
+  return 0;
+}
+
+/// \brief Minimal client: send stdin to a running daemon, print replies.
+int runClient(const std::string &path)
+{
+  struct sockaddr_un addr;
+  if (!fillSocketAddress(path,addr))
+    return 1;
+
+  int fd=socket(AF_UNIX,SOCK_STREAM,0);
+  if (fd < 0 || connect(fd,(struct sockaddr *)&addr,sizeof(addr)) < 0)
+  {
+    perror(path.c_str());
+    return 1;
+  }
+
+  std::string line;
+  while (std::getline(std::cin,line))
+  {
+    if (!writeAll(fd,line+"\n"))
+      break;
+  }
+  shutdown(fd,SHUT_WR);
+
+  char buffer[4096];
+  ssize_t n;
+  while ((n=read(fd,buffer,sizeof(buffer))) > 0)
+    std::cout.write(buffer,n);
+  close(fd);
+  return 0;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+  /*!
+    \brief Long-running DF fix daemon.
+
+    Usage:
+
+        dfd [--declination D] [INPUTFILE]
+        dfd [--declination D] --socket PATH
+        dfd --client PATH
+
+    With no file or socket, messages are read from standard input and
+    replies written to standard output, one line per message.  With
+    --socket the daemon listens on a Unix domain socket and serves
+    clients one after another, keeping its state between them.  --client
+    is a small stand-in client that sends its standard input to a running
+    daemon and prints the replies.
+
+    Messages are lines of whitespace-separated words.  Blank lines and
+    lines starting with # are ignored.
+
+        add EMITTER NAME LON LAT BEARING STDDEV
+        update EMITTER NAME LON LAT BEARING STDDEV
+        invalidate EMITTER NAME
+        validate EMITTER NAME
+        remove EMITTER NAME
+        drop EMITTER
+        fix [EMITTER]
+        stats
+        quit
+
+    LON and LAT are WGS84 in PROJ.4 format (decimal degrees or
+    106d33.634'W style), BEARING is in degrees clockwise from true north
+    after adding the --declination value (east positive, default 0), and
+    STDDEV is the bearing standard deviation in degrees.
+
+    Each report message is answered by one line with the fixes for that
+    emitter:
+
+        fix EMITTER seq=N reports=VALID/TOTAL ls=LON,LAT ml=LON,LAT
+            ml_ellipse=A,B,PHI stansfield=LON,LAT stansfield_ellipse=A,B,PHI
+
+    (all on one line).  A and B are the ellipse semi-axes in meters and
+    PHI the rotation of the A axis counterclockwise from east in degrees.
+    The ML ellipse is the Cramer-Rao bound at the ML fix.  Any fix that
+    could not be computed is printed as "none".  seq counts the changes
+    to the emitter.  Errors are answered with a line starting "error".
+
+    Only the emitter named in a message is recomputed, and a message
+    that does not change anything (e.g. invalidating an invalid report)
+    returns the cached fix.  "fix" reprints cached fixes without
+    recomputing.
+
+    "stats" prints uptime and the number of emitters and reports, then
+    one "latency" line per command with count, mean, 50th and 99th
+    percentile (nearest rank, over the last 4096 messages of that kind)
+    and maximum processing time in microseconds.
+  */
+
+  double declination=0;
+  std::string socketPath;
+  std::string clientPath;
+  std::string inputFile;
+
+  for (int i=1; i<argc; i++)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--declination" && i+1 < argc)
+      declination=atof(argv[++i]);
+    else if (arg == "--socket" && i+1 < argc)
+      socketPath=argv[++i];
+    else if (arg == "--client" && i+1 < argc)
+      clientPath=argv[++i];
+    else if (arg[0] != '-' && inputFile.empty())
+      inputFile=arg;
+    else
+    {
+      std::cerr << "Usage: " << argv[0]
+                << " [--declination D] [--socket PATH | INPUTFILE]"
+                << std::endl
+                << "       " << argv[0] << " --client PATH" << std::endl;
+      exit(1);
+    }
+  }
+
+#ifdef _WIN32
+  if (!socketPath.empty() || !clientPath.empty())
+  {
+    std::cerr << "Unix domain sockets are not supported on this platform"
+              << std::endl;
+    exit(1);
+  }
+#else
+  if (!clientPath.empty())
+    return runClient(clientPath);
+#endif
+
+  FixDaemon daemon(declination);
+
+#ifndef _WIN32
+  if (!socketPath.empty())
+    return serveSocket(daemon,socketPath);
+#endif
+
+  if (!inputFile.empty())
+  {
+    std::ifstream infile(inputFile.c_str(),std::ifstream::in);
+    if (!infile.good())
+    {
+      std::cerr << "Failed to open file " << inputFile << std::endl;
+      exit(1);
+    }
+    serveStream(daemon,infile);
+  }
+  else
+  {
+    serveStream(daemon,std::cin);
+  }
+  return 0;
+}
@@ -0,0 +1,50 @@
+# Runs dfd on dfd_session, as the dfd_session test, and checks what it
+# prints.
+#
+# Called as
+#   cmake -DDFD=<dfd executable> -DSOURCE_DIR=<DFLib source directory>
+#         [-DFAST_ANGLES=ON] -P dfd_session.cmake
+#
+# Fixes must match dfd_session.expected, with the times that change
+# from run to run left out.  A DFLIB_FAST_ANGLES build can differ in
+# the last digits printed, so only the caching checks are made there.
+
+execute_process(COMMAND ${DFD} --declination 9.8 ${SOURCE_DIR}/dfd_session
+                OUTPUT_VARIABLE output
+                RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+  message(FATAL_ERROR "dfd exited with status ${result}:\n${output}")
+endif (NOT result EQUAL 0)
+
+string(REGEX REPLACE "uptime_s=[^ ]* " "" fixes "${output}")
+string(REGEX REPLACE "(latency [a-z]+ count=[0-9]+)[^\n]*" "\\1"
+       fixes "${fixes}")
+
+if (NOT FAST_ANGLES)
+  file(READ ${SOURCE_DIR}/dfd_session.expected expected)
+  if (NOT fixes STREQUAL expected)
+    message(FATAL_ERROR "dfd output differs from dfd_session.expected:\n"
+            "${fixes}")
+  endif (NOT fixes STREQUAL expected)
+endif (NOT FAST_ANGLES)
+
+# TX2 is never touched after its second report, so every later line for
+# it must be the cached fix, sequence number and all, however often ELT
+# is recomputed in between.
+string(REGEX MATCHALL "fix TX2 [^\n]*" tx2Lines "${output}")
+list(LENGTH tx2Lines numTx2Lines)
+if (NOT numTx2Lines EQUAL 3)
+  message(FATAL_ERROR "expected 3 fix lines for TX2, got ${numTx2Lines}")
+endif (NOT numTx2Lines EQUAL 3)
+list(GET tx2Lines 1 tx2Added)
+list(GET tx2Lines 2 tx2Final)
+if (NOT tx2Added STREQUAL tx2Final OR NOT tx2Final MATCHES " seq=2 ")
+  message(FATAL_ERROR "TX2 was recomputed:\n${tx2Added}\n${tx2Final}")
+endif (NOT tx2Added STREQUAL tx2Final OR NOT tx2Final MATCHES " seq=2 ")
+
+# Changing ELT's reports must have moved its fix on each time
+string(REGEX MATCHALL "fix ELT seq=[0-9]+" eltSeqs "${output}")
+list(GET eltSeqs -1 eltFinal)
+if (NOT eltFinal STREQUAL "fix ELT seq=11")
+  message(FATAL_ERROR "ELT ended at \"${eltFinal}\", not seq=11")
+endif (NOT eltFinal STREQUAL "fix ELT seq=11")
@@ -0,0 +1,563 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Microbenchmarks of every fix method and minimizer entry
+//                  point, writing machine-readable JSON so that timings
+//                  can be compared between releases.
+//
+// Special Notes  : Problems are the receivers files named on the command
+//                  line plus synthetic networks of increasing size.  All
+//                  bearing noise comes from fixed random streams, so every
+//                  run times exactly the same problems.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#endif
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <proj_api.h>
+extern "C" {
+  double dmstor(const char *, char **);
+}
+
+#include "Util_Misc.hpp"
+#include "Util_Timer.hpp"
+#include "gaussian_random.hpp"
+#include "DF_Proj_Point.hpp"
+#include "DF_Proj_Report.hpp"
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
+
+enum BenchMethod {COST_FUNCTION, COST_AND_GRADIENT, COST_AND_HESSIAN,
+                  LEAST_SQUARES, FIX_CUT_AVERAGE, STANSFIELD, PSEUDO_LINEAR,
+                  ML, AGGRESSIVE_ML, FIX_CUT, ALL_FIXES, NUM_BENCH_METHODS};
+
+const char *benchMethodNames[NUM_BENCH_METHODS]=
+  {"computeCostFunction","computeCostFunctionAndGradient",
+   "computeCostFunctionAndHessian","computeLeastSquaresFix",
+   "computeFixCutAverage","computeStansfieldFix","computePseudoLinearFix",
+   "computeMLFix","aggressiveComputeMLFix","computeFixCut",
+   "computeAllFixes"};
+
+// Results go here so the optimizer can't throw away the work.
+double benchSink=0;
+
+/// \brief One benchmark problem: a populated collection and a start point
+struct BenchProblem
+{
+  std::string name;
+  DFLib::ReportCollection rColl;
+  DFLib::Abstract::Point *LS_fix;
+  std::vector<double> evaluationPoint;
+};
+
+/// \brief Read a receivers file (lon lat sigma, dms format) as
+/// testlsDF_proj does.
+void readReceivers(std::istream &in, std::vector<std::vector<double> > &lonlats,
+                   std::vector<double> &sigmas)
+{
+  char dms_string[128];
+  while (!in.eof())
+  {
+    double temp_sigma;
+    char junk_space;
+    std::vector<double> tempVector(2);
+
+    in.get(dms_string,sizeof(dms_string),' ');
+    if (in.eof())
+      break;
+    tempVector[0]=dmstor(dms_string,NULL)*RAD_TO_DEG;
+    in.get(junk_space);
+    in.get(dms_string,sizeof(dms_string),' ');
+    if (in.eof())
+      break;
+    tempVector[1]=dmstor(dms_string,NULL)*RAD_TO_DEG;
+    in.get(junk_space);
+    in >> temp_sigma;
+    if (in.fail())
+      break;
+    // eat the newline so the next get() starts on the longitude
+    in.get(junk_space);
+    lonlats.push_back(tempVector);
+    sigmas.push_back(temp_sigma);
+  }
+}
+
+/// \brief finish setting up a problem once its reports are in
+void prepareProblem(BenchProblem &prob)
+{
+  prob.rColl.computeLeastSquaresFix(*(prob.LS_fix));
+  prob.evaluationPoint=prob.LS_fix->getXY();
+  // evaluate cost functions a little way off the minimum so the gradient
+  // terms are not all trivially small
+  prob.evaluationPoint[0] += 100;
+  prob.evaluationPoint[1] += 100;
+}
+
+/// \brief Problem built from a receivers file using DFLib::Proj::Report
+void makeFileProblem(BenchProblem &prob, const std::string &fileName,
+                     std::vector<double> &transLonLat, int stream)
+{
+  std::vector<std::string> projArgs;
+  projArgs.push_back("proj=latlong");
+  projArgs.push_back("datum=WGS84");
+  std::vector<std::vector<double> > lonlats;
+  std::vector<double> sigmas;
+
+  std::ifstream in(fileName.c_str());
+  if (!in)
+    throw(DFLib::Util::Exception("Cannot open receivers file "+fileName));
+  readReceivers(in,lonlats,sigmas);
+  if (lonlats.size() < 2)
+    throw(DFLib::Util::Exception("Too few receivers in "+fileName));
+
+  DFLib::Proj::Point transPoint(transLonLat,projArgs);
+  std::vector<double> transPos=transPoint.getXY();
+  DFLib::Util::gaussian_random_generator rand_gen(0,1,1,stream);
+
+  prob.name=fileName;
+  for (int i=0; i<lonlats.size(); ++i)
+  {
+    std::ostringstream ost;
+    ost << "report " << i;
+    DFLib::Proj::Report *reportPtr
+      = new DFLib::Proj::Report(lonlats[i],0.0,sigmas[i],ost.str(),projArgs);
+    double bearing=reportPtr->computeBearingToPoint(transPos)*RAD_TO_DEG;
+    reportPtr->setBearing(bearing+sigmas[i]*rand_gen.getRandom());
+    prob.rColl.addReport(reportPtr);
+  }
+  prob.LS_fix = new DFLib::Proj::Point(transPoint);
+  prepareProblem(prob);
+}
+
+/// \brief Synthetic network of N receivers scattered 5 to 50 km from a
+/// transmitter at the origin, with 2 degree bearing errors.
+void makeSyntheticProblem(BenchProblem &prob, int N, int stream)
+{
+  std::vector<double> origin(2,0.0);
+  std::vector<double> location(2);
+  std::vector<double> noise(3*N);
+  DFLib::Util::gaussian_random_generator rand_gen(0,1,2,stream);
+  rand_gen.fill(&noise[0],noise.size());
+
+  std::ostringstream nameStream;
+  nameStream << "synthetic_" << N;
+  prob.name=nameStream.str();
+  for (int i=0; i<N; ++i)
+  {
+    // azimuth and range derived from the noise stream so that the
+    // geometry is fixed for a given N.
+    double azimuth=atan2(noise[3*i],noise[3*i+1]);
+    double range=5000+45000*fabs(noise[3*i]*noise[3*i+1])/(1+fabs(noise[3*i]*noise[3*i+1]));
+    location[0]=range*sin(azimuth);
+    location[1]=range*cos(azimuth);
+    std::ostringstream ost;
+    ost << "report " << i;
+    DFLib::XY::Report *reportPtr
+      = new DFLib::XY::Report(location,0.0,2.0,ost.str());
+    double bearing=reportPtr->computeBearingToPoint(origin)*RAD_TO_DEG;
+    reportPtr->setBearing(bearing+2.0*noise[3*i+2]);
+    prob.rColl.addReport(reportPtr);
+  }
+  prob.LS_fix = new DFLib::XY::Point(origin);
+  prepareProblem(prob);
+}
+
+/// \brief run one method once on a problem
+void runMethod(int method, BenchProblem &prob)
+{
+  double f;
+  std::vector<double> gradf;
+  std::vector<std::vector<double> > hessian;
+  std::vector<double> FCA_stddev;
+  double am2,bm2,phi;
+  DFLib::Abstract::Point *fix;
+
+  switch (method)
+  {
+  case COST_FUNCTION:
+    benchSink += prob.rColl.computeCostFunction(prob.evaluationPoint);
+    break;
+  case COST_AND_GRADIENT:
+    prob.rColl.computeCostFunctionAndGradient(prob.evaluationPoint,f,gradf);
+    benchSink += f+gradf[0];
+    break;
+  case COST_AND_HESSIAN:
+    prob.rColl.computeCostFunctionAndHessian(prob.evaluationPoint,f,gradf,
+                                             hessian);
+    benchSink += f+hessian[0][0];
+    break;
+  case LEAST_SQUARES:
+    fix=prob.LS_fix->Clone();
+    prob.rColl.computeLeastSquaresFix(*fix);
+    benchSink += fix->getXY()[0];
+    delete fix;
+    break;
+  case FIX_CUT_AVERAGE:
+    {
+      // A fresh collection every time, so that every cut is computed
+      // rather than found in the table of the last run
+      std::vector<int> all(prob.rColl.size());
+      for (int i=0; i<all.size(); ++i)
+        all[i]=i;
+      DFLib::ReportCollection *fresh=prob.rColl.makeSubset(all);
+      fix=prob.LS_fix->Clone();
+      fresh->computeFixCutAverage(*fix,FCA_stddev);
+      benchSink += fix->getXY()[0];
+      delete fix;
+      delete fresh;
+    }
+    break;
+  case STANSFIELD:
+    fix=prob.LS_fix->Clone();
+    try
+    {
+      prob.rColl.computeStansfieldFix(*fix,am2,bm2,phi);
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      delete fix;
+      throw;
+    }
+    benchSink += fix->getXY()[0];
+    delete fix;
+    break;
+  case PSEUDO_LINEAR:
+    fix=prob.LS_fix->Clone();
+    try
+    {
+      prob.rColl.computePseudoLinearFix(*fix,am2,bm2,phi);
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      delete fix;
+      throw;
+    }
+    benchSink += fix->getXY()[0];
+    delete fix;
+    break;
+  case ML:
+    fix=prob.LS_fix->Clone();
+    prob.rColl.computeMLFix(*fix);
+    benchSink += fix->getXY()[0];
+    delete fix;
+    break;
+  case AGGRESSIVE_ML:
+    fix=prob.LS_fix->Clone();
+    prob.rColl.aggressiveComputeMLFix(*fix);
+    benchSink += fix->getXY()[0];
+    delete fix;
+    break;
+  case FIX_CUT:
+    {
+      // every adjacent pair, so one "call" here is N-1 fix cuts
+      DFLib::FixStatus fs;
+      double cutAngle;
+      fix=prob.LS_fix->Clone();
+      for (int i=0; i+1<prob.rColl.size(); ++i)
+      {
+        const_cast<DFLib::Abstract::Report *>(prob.rColl.getReport(i))
+          ->computeFixCut(const_cast<DFLib::Abstract::Report *>(prob.rColl.getReport(i+1)),
+                          *fix,cutAngle,fs);
+        benchSink += cutAngle;
+      }
+      delete fix;
+    }
+    break;
+  case ALL_FIXES:
+    {
+      DFLib::AllFixes all;
+      fix=prob.LS_fix->Clone();
+      prob.rColl.computeAllFixes(*fix,all);
+      benchSink += all.mlFix[0]+all.stansfieldFix[0];
+      delete fix;
+    }
+    break;
+  }
+}
+
+/// \brief s as a quoted JSON string
+///
+/// Geometry names come from file names, which may hold quotes,
+/// backslashes or anything else.
+std::string jsonString(const std::string &s)
+{
+  std::ostringstream quoted;
+  quoted << "\"";
+  for (int i=0; i<s.size(); ++i)
+  {
+    unsigned char c=s[i];
+    if (c=='"' || c=='\\')
+      quoted << '\\' << c;
+    else if (c=='\n')
+      quoted << "\\n";
+    else if (c=='\t')
+      quoted << "\\t";
+    else if (c<0x20)
+    {
+      char escaped[8];
+      sprintf(escaped,"\\u%04x",c);
+      quoted << escaped;
+    }
+    else
+      quoted << c;
+  }
+  quoted << "\"";
+  return quoted.str();
+}
+
+/// \brief write x as a JSON number, or null if it is not finite
+///
+/// JSON has no spelling for inf or nan, and a fix that blows up in one
+/// method would otherwise make the whole output unparseable.
+void writeJsonNumber(std::ostream &out, double x)
+{
+  // x-x is NaN unless x is finite
+  if (x-x==0)
+    out << x;
+  else
+    out << "null";
+}
+
+/// \brief write one JSON record
+void writeRecord(std::ostream &out, bool &first, const std::string &geometry,
+                 int n, const std::string &method, const std::string &status,
+                 int reps, double seconds, int itemsPerCall)
+{
+  if (!first)
+    out << "," << std::endl;
+  first=false;
+  out << "    {\"geometry\": " << jsonString(geometry) << ", \"n\": " << n
+      << ", \"method\": " << jsonString(method)
+      << ", \"status\": " << jsonString(status)
+      << ", \"reps\": " << reps << ", \"seconds\": " << seconds;
+  if (reps > 0)
+  {
+    out << ", \"seconds_per_call\": " << seconds/reps;
+    if (itemsPerCall > 1)
+      out << ", \"seconds_per_item\": " << seconds/reps/itemsPerCall;
+  }
+  out << "}";
+}
+
+/// \brief time every method on a problem, repeating each until minTime
+void benchProblem(std::ostream &out, bool &first, BenchProblem &prob,
+                  double minTime, int maxPairwiseN, int maxAggressiveN)
+{
+  int N=prob.rColl.size();
+  for (int method=0; method<NUM_BENCH_METHODS; ++method)
+  {
+    int reps=0;
+    double elapsed=0;
+    std::string status="ok";
+
+    if (((method == FIX_CUT_AVERAGE || method == ALL_FIXES)
+         && N > maxPairwiseN)
+        || (method == AGGRESSIVE_ML && N > maxAggressiveN))
+    {
+      status="skipped";
+    }
+    else
+    {
+      double start=DFLib::Util::wallClockSeconds();
+      try
+      {
+        do
+        {
+          runMethod(method,prob);
+          ++reps;
+          elapsed=DFLib::Util::wallClockSeconds()-start;
+        } while (elapsed < minTime);
+      }
+      catch (DFLib::Util::Exception x)
+      {
+        status="exception";
+        elapsed=DFLib::Util::wallClockSeconds()-start;
+      }
+    }
+    writeRecord(out,first,prob.name,N,benchMethodNames[method],status,reps,
+                elapsed,(method==FIX_CUT)?N-1:1);
+    std::cerr << " " << prob.name << " " << benchMethodNames[method] << " "
+              << status << std::endl;
+  }
+}
+
+/// \brief time user->mercator->user round trips of a DFLib::Proj::Point
+void benchProjection(std::ostream &out, bool &first,
+                     std::vector<double> &lonlat, double minTime)
+{
+  std::vector<std::string> projArgs;
+  projArgs.push_back("proj=latlong");
+  projArgs.push_back("datum=WGS84");
+  DFLib::Proj::Point thePoint(lonlat,projArgs);
+  int reps=0;
+  double elapsed;
+  double start=DFLib::Util::wallClockSeconds();
+  do
+  {
+    std::vector<double> xy;
+    thePoint.setUserCoords(lonlat);
+    xy=thePoint.getXY();
+    thePoint.setXY(xy);
+    benchSink += thePoint.getUserCoords()[0];
+    ++reps;
+    elapsed=DFLib::Util::wallClockSeconds()-start;
+  } while (elapsed < minTime);
+  writeRecord(out,first,"projection",1,"projectionRoundTrip","ok",reps,
+              elapsed,1);
+}
+
+int main(int argc, char **argv)
+{
+  /*!
+    \brief Benchmark all DFLib fix methods and write timings as JSON
+
+    Usage: dflib_bench [--mintime <seconds>] [--maxN <N>]
+                       [--maxPairwiseN <N>] [--maxAggressiveN <N>]
+                       [--transmitter <lon> <lat>] [receivers files...]
+
+    Each receivers file named on the command line (e.g. the bundled
+    receivers, receivers3 ... receivers6_sloppy) is set up as in
+    testlsDF_proj, with the transmitter at the given location (default
+    106d35'W 34d55'N).  After those, synthetic networks of 3, 10, 30,
+    ... up to maxN (default 1000000) receivers are benchmarked.
+
+    Every method is run repeatedly until at least mintime seconds
+    (default 0.1) have elapsed.  computeFixCutAverage is timed from
+    scratch, which is O(N^2) in time and memory, and is skipped above
+    maxPairwiseN reports (default 2000), and so is computeAllFixes, whose
+    first call builds the fix cut table; later calls find it already
+    built, as a program calling it repeatedly would.
+    aggressiveComputeMLFix may need thousands of function evaluations
+    and is skipped above maxAggressiveN (default 100000).  Skipped
+    entries still appear in the output with status "skipped".
+
+    The computeFixCut entry times the fix cuts of all N-1 adjacent pairs
+    of reports as one call, and also reports the time per cut.
+
+    Progress goes to stderr; stdout gets only the JSON document.
+  */
+  double minTime=0.1;
+  int maxN=1000000;
+  int maxPairwiseN=2000;
+  int maxAggressiveN=100000;
+  std::vector<double> transLonLat(2);
+  std::vector<std::string> receiverFiles;
+
+  transLonLat[0]=dmstor("106d35'W",NULL)*RAD_TO_DEG;
+  transLonLat[1]=dmstor("34d55'N",NULL)*RAD_TO_DEG;
+
+  for (int i=1; i<argc; ++i)
+  {
+    std::string arg(argv[i]);
+    if (arg == "--mintime" && i+1<argc)
+      minTime=atof(argv[++i]);
+    else if (arg == "--maxN" && i+1<argc)
+      maxN=atoi(argv[++i]);
+    else if (arg == "--maxPairwiseN" && i+1<argc)
+      maxPairwiseN=atoi(argv[++i]);
+    else if (arg == "--maxAggressiveN" && i+1<argc)
+      maxAggressiveN=atoi(argv[++i]);
+    else if (arg == "--transmitter" && i+2<argc)
+    {
+      transLonLat[0]=dmstor(argv[++i],NULL)*RAD_TO_DEG;
+      transLonLat[1]=dmstor(argv[++i],NULL)*RAD_TO_DEG;
+    }
+    else if (arg.size() > 2 && arg.substr(0,2) == "--")
+    {
+      std::cerr << "Usage: " << argv[0] << " [--mintime <seconds>] [--maxN <N>]"
+                << " [--maxPairwiseN <N>] [--maxAggressiveN <N>]"
+                << " [--transmitter <lon> <lat>] [receivers files...]"
+                << std::endl;
+      exit(1);
+    }
+    else
+      receiverFiles.push_back(arg);
+  }
+
+  std::cout.precision(10);
+  std::cout << "{" << std::endl;
+  std::cout << "  \"benchmark\": \"dflib_bench\"," << std::endl;
+  std::cout << "  \"threads\": " << DFLib::Util::maxThreads() << ","
+            << std::endl;
+  std::cout << "  \"min_time\": " << minTime << "," << std::endl;
+  std::cout << "  \"results\": [" << std::endl;
+  bool first=true;
+
+  benchProjection(std::cout,first,transLonLat,minTime);
+
+  int stream=0;
+  for (int i=0; i<receiverFiles.size(); ++i)
+  {
+    BenchProblem prob;
+    try
+    {
+      makeFileProblem(prob,receiverFiles[i],transLonLat,stream++);
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      std::cerr << x.getEmsg() << std::endl;
+      prob.rColl.deleteReports();
+      continue;
+    }
+    benchProblem(std::cout,first,prob,minTime,maxPairwiseN,maxAggressiveN);
+    prob.rColl.deleteReports();
+    delete prob.LS_fix;
+  }
+
+  // 3, 10, 30, 100, ... up to maxN
+  for (int N=3; N<=maxN; N=(N%3==0)?(10*N)/3:3*N)
+  {
+    BenchProblem prob;
+    makeSyntheticProblem(prob,N,stream++);
+    benchProblem(std::cout,first,prob,minTime,maxPairwiseN,maxAggressiveN);
+    prob.rColl.deleteReports();
+    delete prob.LS_fix;
+  }
+
+  std::cout << std::endl << "  ]," << std::endl;
+  std::cout << "  \"checksum\": ";
+  writeJsonNumber(std::cout,benchSink);
+  std::cout << std::endl;
+  std::cout << "}" << std::endl;
+  return 0;
+}
@@ -23,7 +23,8 @@
 //                  returns a random number from a gaussian distribution
 //                  with specified mean and standard deviation
 //
-// Special Notes  : 
+// Special Notes  : See gaussian_random.hpp for a description of the
+//                  Philox4x32-10 generator used here.
 //
 // Creator        : 
 //
@@ -39,31 +40,134 @@
 // Current Owner  : $Author$
 //-------------------------------------------------------------------------
 #ifdef _MSC_VER
-#define _CRT_RAND_S
-#include <ctime>
+#define _USE_MATH_DEFINES
 #endif
 #include <cmath>
 #include <cstdlib>
-#include "Util_Misc.hpp"
 #include "gaussian_random.hpp"
 
 namespace DFLib
 {
   namespace Util
   {
-    gaussian_random_generator::gaussian_random_generator(double m, double s)
-      :mean(m),
-       std_dev(s),
+    // Philox4x32 multipliers and Weyl sequence constants
+    static const uint32_t PHILOX_M0=0xD2511F53U;
+    static const uint32_t PHILOX_M1=0xCD9E8D57U;
+    static const uint32_t PHILOX_W0=0x9E3779B9U;
+    static const uint32_t PHILOX_W1=0xBB67AE85U;
+
+    /// SplitMix64 finalizer, used to spread a user's seed over the key.
+    static uint64_t mixSeed(uint64_t z)
+    {
+      z += 0x9E3779B97F4A7C15ULL;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    }
+
+    /// Map 64 random bits onto a double strictly inside (0,1), so that the
+    /// log in the Box-Muller transform never sees zero.
+    static inline double toOpenUniform(uint32_t hi, uint32_t lo)
+    {
+      return ((hi>>5)*67108864.0+(lo>>6)+0.5)*(1.0/9007199254740992.0);
+    }
+
+    /// Seed from the global C generator, for old-style callers
+    static uint64_t globalSeed()
+    {
 #ifdef _MSC_VER
-       iff(0),
+      return ((((uint64_t)rand())<<45) ^ (((uint64_t)rand())<<30)
+              ^ (((uint64_t)rand())<<15) ^ ((uint64_t)rand()));
+#else
+      return ((((uint64_t)lrand48())<<31) ^ ((uint64_t)lrand48()));
 #endif
-       use_last(false)
+    }
+
+    gaussian_random_generator::gaussian_random_generator()
+      :use_last(false),
+       mean(0),
+       std_dev(1)
+    {
+      initialize(globalSeed(),0);
+    }
+
+    gaussian_random_generator::gaussian_random_generator(double m, double s)
+      :use_last(false),
+       mean(m),
+       std_dev(s)
+    {
+      initialize(globalSeed(),0);
+    }
+
+    gaussian_random_generator::gaussian_random_generator(double m, double s,
+                                                         uint64_t seed,
+                                                         uint64_t strm)
+      :use_last(false),
+       mean(m),
+       std_dev(s)
+    {
+      initialize(seed,strm);
+    }
+
+    void gaussian_random_generator::initialize(uint64_t seed, uint64_t strm)
+    {
+      uint64_t k=mixSeed(seed);
+      key[0]=(uint32_t)k;
+      key[1]=(uint32_t)(k>>32);
+      stream=strm;
+      counter=0;
+      ysave=0;
+      use_last=false;
+    }
+
+    /// Philox4x32-10.  The 128 bit counter is (block, stream).
+    void gaussian_random_generator::philoxBlock(uint64_t block,
+                                                uint32_t out[4]) const
     {
+      uint32_t c0=(uint32_t)block;
+      uint32_t c1=(uint32_t)(block>>32);
+      uint32_t c2=(uint32_t)stream;
+      uint32_t c3=(uint32_t)(stream>>32);
+      uint32_t k0=key[0];
+      uint32_t k1=key[1];
+
+      for (int round=0; round<10; ++round)
+      {
+        uint64_t p0=(uint64_t)PHILOX_M0*c0;
+        uint64_t p1=(uint64_t)PHILOX_M1*c2;
+        uint32_t hi0=(uint32_t)(p0>>32);
+        uint32_t lo0=(uint32_t)p0;
+        uint32_t hi1=(uint32_t)(p1>>32);
+        uint32_t lo1=(uint32_t)p1;
+        c0=hi1^c1^k0;
+        c1=lo1;
+        c2=hi0^c3^k1;
+        c3=lo0;
+        k0+=PHILOX_W0;
+        k1+=PHILOX_W1;
+      }
+      out[0]=c0;
+      out[1]=c1;
+      out[2]=c2;
+      out[3]=c3;
+    }
+
+    /// Basic (not polar) Box-Muller, so there is no rejection loop and
+    /// each block gives exactly one pair.
+    void gaussian_random_generator::gaussianPair(uint64_t block,
+                                                 double &y1, double &y2) const
+    {
+      uint32_t r[4];
+      philoxBlock(block,r);
+      double radius=sqrt(-2.0*log(toOpenUniform(r[0],r[1])));
+      double theta=2*M_PI*toOpenUniform(r[2],r[3]);
+      y1=radius*cos(theta);
+      y2=radius*sin(theta);
     }
 
     double gaussian_random_generator::getRandom()
     {
-      double x1, x2, w, y1;
+      double y1;
 
       if (use_last)      /* use value from previous call */
       {
@@ -72,46 +176,89 @@ namespace DFLib
       }
       else
       {
-        do 
-        {
-          x1 = 2.0 * uniformRandom() - 1.0;
-          x2 = 2.0 * uniformRandom() - 1.0;
-          w = x1 * x1 + x2 * x2;
-        } while ( w >= 1.0 );
-        
-        w = sqrt( (-2.0 * log( w ) ) / w );
-        y1 = x1 * w;
-        ysave = x2 * w;
+        gaussianPair(counter++,y1,ysave);
         use_last = true;
       }
     
       return( mean + y1 * std_dev );
     }
-    /// Returns a random double from a uniform distribution
-    double gaussian_random_generator::uniformRandom()
+
+    void gaussian_random_generator::fill(double *out, int n)
     {
-#ifndef _MSC_VER
-      return drand48();
-#else
-      double dum;
-      int j;
+      int i=0;
+      if (n<=0)
+        return;
+
+      // finish off any pair left over from getRandom
+      if (use_last)
+        out[i++]=getRandom();
+
+      int numPairs=(n-i)/2;
+      double *pairs=out+i;
 
-      if (iff == 0)
+      // Pass 1: uniform deviates, straight from the counter
+      for (int k=0; k<numPairs; ++k)
       {
-        iff=1;
-        maxran=RAND_MAX+1.0;
-        srand(time(NULL));
-        for (j=0;j<98;++j) dum=rand();
-        for (j=0;j<98;++j) v[j]=rand();
-        y=rand();
+        uint32_t r[4];
+        philoxBlock(counter+k,r);
+        pairs[2*k]=toOpenUniform(r[0],r[1]);
+        pairs[2*k+1]=toOpenUniform(r[2],r[3]);
+      }
+
+      // Pass 2: Box-Muller in place.  Same arithmetic, in the same order,
+      // as gaussianPair and getRandom, so results are identical.
+      for (int k=0; k<numPairs; ++k)
+      {
+        double radius=sqrt(-2.0*log(pairs[2*k]));
+        double theta=2*M_PI*pairs[2*k+1];
+        double y1=radius*cos(theta);
+        double y2=radius*sin(theta);
+        pairs[2*k]=mean+y1*std_dev;
+        pairs[2*k+1]=mean+y2*std_dev;
+      }
+      counter += numPairs;
+      i += 2*numPairs;
+
+      // odd one out
+      if (i<n)
+        out[i]=getRandom();
+    }
+
+    double gaussian_random_generator::getUniform()
+    {
+      uint32_t r[4];
+      philoxBlock(counter++,r);
+      return toOpenUniform(r[0],r[1]);
+    }
+
+    void gaussian_random_generator::fillUniform(double *out, int n)
+    {
+      for (int i=0; i<n; i+=2)
+      {
+        uint32_t r[4];
+        philoxBlock(counter++,r);
+        out[i]=toOpenUniform(r[0],r[1]);
+        if (i+1<n)
+          out[i+1]=toOpenUniform(r[2],r[3]);
+      }
+    }
+
+    void gaussian_random_generator::jumpAhead(uint64_t n)
+    {
+      if (n==0)
+        return;
+      if (use_last)
+      {
+        use_last=false;
+        --n;
+      }
+      counter += n/2;
+      if (n%2)
+      {
+        double y1;
+        gaussianPair(counter++,y1,ysave);
+        use_last=true;
       }
-      j=98.0*y/maxran;
-      if (j>97||j<0)
-        throw(Exception("uniformRandom: This cannot happen."));
-      y=v[j];
-      v[j]=rand();
-      return y/maxran;
-#endif
     }
   }
 }
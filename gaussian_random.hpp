@@ -22,7 +22,11 @@
 //                  returns a random number from a gaussian distribution
 //                  with specified mean and standard deviation
 //
-// Special Notes  : 
+// Special Notes  : The underlying uniform generator is the counter-based
+//                  Philox4x32-10 generator of Salmon et al., "Parallel
+//                  Random Numbers: As Easy as 1, 2, 3" (SC11).  Each
+//                  generator object is an independent stream, so there
+//                  is no shared state and no locking between threads.
 //
 // Creator        : 
 //
@@ -42,35 +46,93 @@
 #include "DFLib_port.h"
 #include <cmath>
 #include <cstdlib>
+#include <stdint.h>
 
 namespace DFLib
 {
   namespace Util
   {
-    /// Provide a random number generator returning values from a 
+    /// \brief Provide a random number generator returning values from a 
     /// normal distribution of specified mean and standard deviation.
+    ///
+    /// Deviates are generated in pairs by the Box-Muller transform of two
+    /// uniform deviates.  The uniform deviates come from Philox4x32-10,
+    /// a counter-based generator: block \f$k\f$ of stream \f$s\f$ with
+    /// seed \f$S\f$ is a pure function of \f$(S,s,k)\f$.  One Philox
+    /// block yields exactly one pair of normal deviates, so skipping ahead
+    /// in a stream costs nothing, and the n-th deviate of a stream is the
+    /// same whether it was obtained from getRandom() or fill().
+    ///
+    /// For parallel work, give every thread (or better, every independent
+    /// unit of work such as a Monte Carlo trial) its own generator object
+    /// constructed with a common seed and a distinct stream number.  The
+    /// objects share no state.
     class CPL_DLL gaussian_random_generator
     {
     private:
       double ysave;
       bool use_last;
-      bool seeded;
       double mean;
       double std_dev;
-      /// return double precision uniform deviates.
-      double uniformRandom();
-#ifdef _MSC_VER
-      double y,maxran,v[98];
-      int iff;
-#endif
+      uint32_t key[2];
+      uint64_t stream;
+      /// index of the next Philox block to be used
+      uint64_t counter;
+
+      void initialize(uint64_t seed, uint64_t stream);
+      /// \brief generate the four 32-bit words of a Philox block
+      void philoxBlock(uint64_t block, uint32_t out[4]) const;
+      /// \brief zero-mean, unit variance pair from given block
+      void gaussianPair(uint64_t block, double &y1, double &y2) const;
     public:
-      /// Constructor with specified mean and standard deviation
+      /// \brief Constructor with specified mean and standard deviation
+      ///
+      /// For compatibility with older code, generators made this way are
+      /// seeded from the global C library generator (drand48, or rand on
+      /// Windows), so a program that calls srand48 once and then creates
+      /// generators as needed gets a reproducible sequence.  The global
+      /// generator is only touched here, never when drawing deviates.
        gaussian_random_generator(double mean, double std_dev);
-      /// Default constructor, mean 0 and standard deviation 1
-       gaussian_random_generator():mean(0),std_dev(1),use_last(false) {};
+      /// Default constructor, mean 0 and standard deviation 1, seeded as
+      /// above.
+       gaussian_random_generator();
+      /// \brief Constructor for an independent, reproducible stream
+      ///
+      /// Generators made with this constructor never touch global state,
+      /// so any number of them may be used from different threads at
+      /// once.  The sequence depends only on the (seed, stream) pair.
+      /// Monte Carlo codes should use the trial number as the stream so
+      /// results do not depend on how trials are scheduled onto threads.
+      gaussian_random_generator(double mean, double std_dev,
+                                uint64_t seed, uint64_t stream);
       /// Get normally distributed random deviate.
       /// \return random value from distribution
        double getRandom();
+      /// \brief Fill an array with normally distributed random deviates
+      ///
+      /// Equivalent to n calls to getRandom(), but done in two tight,
+      /// branch-free passes over the array (integer Philox rounds, then
+      /// the Box-Muller transform) that the compiler can vectorize.
+      /// \param out array to fill
+      /// \param n number of deviates to generate
+      void fill(double *out, int n);
+      /// \brief Get a uniform deviate on the open interval (0,1)
+      ///
+      /// Uses a fresh Philox block, the same one a pair of normal
+      /// deviates would have come from, and leaves any normal deviate
+      /// saved by getRandom() for the next call to getRandom().  The mean
+      /// and standard deviation do not apply.
+      double getUniform();
+      /// \brief Fill an array with uniform deviates on (0,1)
+      ///
+      /// Each Philox block gives two uniform deviates, so this uses
+      /// only (n+1)/2 blocks of the stream.  Like getUniform(), it leaves
+      /// any saved normal deviate alone.
+      /// \param out array to fill
+      /// \param n number of deviates to generate
+      void fillUniform(double *out, int n);
+      /// \brief Skip the next n deviates of this stream in O(1) time
+      void jumpAhead(uint64_t n);
     };
   }
 }
@@ -0,0 +1,356 @@
+//-*- mode:C++ ; c-basic-offset: 2 -*-
+//    DFLib: A library of Bearings Only Target Localization algorithms
+//    Copyright (C) 2009-2015  Thomas V. Russo
+//
+//    This program is free software: you can redistribute it and/or modify
+//    it under the terms of the GNU General Public License as published by
+//    the Free Software Foundation, either version 3 of the License, or
+//    (at your option) any later version.
+//
+//    This program is distributed in the hope that it will be useful,
+//    but WITHOUT ANY WARRANTY; without even the implied warranty of
+//    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//    GNU General Public License for more details.
+//
+//    You should have received a copy of the GNU General Public License
+//    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+//-------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+// Filename       : $RCSfile$
+//
+// Purpose        : Monte Carlo accuracy harness.  Runs many randomized
+//                  trials of the testlsDF_proj problem in one process and
+//                  reports aggregate error statistics for each fix method.
+//
+// Special Notes  : Every trial gets its own random number stream keyed on
+//                  (seed, trial number), and results are aggregated in
+//                  trial order after all trials are done, so the output
+//                  on stdout is bitwise identical no matter how many
+//                  threads are used.  Timing goes to stderr for that reason.
+//
+// Creator        :
+//
+// Creation Date  :
+//
+// Revision Information:
+// ---------------------
+//
+// Revision Number: $Revision$
+//
+// Revision Date  : $Date$
+//
+// Current Owner  : $Author$
+//-------------------------------------------------------------------------
+#ifdef _MSC_VER
+#define _USE_MATH_DEFINES
+#include <ctime>
+#endif
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <proj_api.h>
+extern "C" {
+  double dmstor(const char *, char **);
+}
+
+#include "Util_Misc.hpp"
+#include "Util_Timer.hpp"
+#include "Util_Fix_Check.hpp"
+#include "gaussian_random.hpp"
+#include "DF_Proj_Point.hpp"
+#include "DF_XY_Point.hpp"
+#include "DF_XY_Report.hpp"
+#include "DF_Report_Collection.hpp"
+
+enum {LS_METHOD,FCA_METHOD,ML_METHOD,ML_GLOBAL_METHOD,STANSFIELD_METHOD,
+      NUM_METHODS};
+const char *methodNames[NUM_METHODS]={"LS","FCA","ML","ML global",
+                                   "Stansfield"};
+
+struct TrialResult
+{
+  bool ok[NUM_METHODS];
+  double error[NUM_METHODS];
+};
+
+void recordFix(int method, const std::vector<double> &fix,
+               const std::vector<double> &transPos,
+               const std::vector<double> &receiver0, double mercScale,
+               TrialResult &result)
+{
+  result.ok[method]=DFLib::Util::fixIsReasonable(fix,receiver0,mercScale);
+  if (result.ok[method])
+  {
+    double dx=fix[0]-transPos[0];
+    double dy=fix[1]-transPos[1];
+    result.error[method]=sqrt(dx*dx+dy*dy)*mercScale;
+  }
+}
+
+/// \brief Run one randomized trial and compute every fix.
+///
+/// Everything here is local to the trial, so trials may run concurrently.
+void runTrial(int trial, uint64_t seed,
+              const std::vector<std::vector<double> > &receiverLocs,
+              const std::vector<double> &sigmas,
+              const std::vector<double> &trueBearings,
+              const std::vector<double> &transPos,
+              double mercScale,
+              TrialResult &result)
+{
+  DFLib::Util::gaussian_random_generator rand_gen(0,1,seed,trial);
+  DFLib::ReportCollection rColl;
+  std::vector<double> origin(2,0.0);
+  std::vector<double> FCA_stddev;
+  int i;
+
+  for (i=0;i<NUM_METHODS;++i)
+  {
+    result.ok[i]=false;
+    result.error[i]=0;
+  }
+
+  std::vector<double> noise(receiverLocs.size());
+  rand_gen.fill(&noise[0],noise.size());
+
+  for (i=0;i<receiverLocs.size();++i)
+  {
+    std::ostringstream ost;
+    ost << "report " << i;
+    double bearing=trueBearings[i]+sigmas[i]*noise[i];
+    rColl.addReport(new DFLib::XY::Report(receiverLocs[i],bearing,sigmas[i],
+                                          ost.str()));
+  }
+
+  DFLib::XY::Point LS_fix(origin);
+  rColl.computeLeastSquaresFix(LS_fix);
+  recordFix(LS_METHOD,LS_fix.getXY(),transPos,receiverLocs[0],mercScale,
+            result);
+
+  DFLib::XY::Point FixCutAverage(origin);
+  if (rColl.computeFixCutAverage(FixCutAverage,FCA_stddev))
+    recordFix(FCA_METHOD,FixCutAverage.getXY(),transPos,receiverLocs[0],
+              mercScale,result);
+
+  // ML fix with the same retry strategy as testlsDF_proj
+  DFLib::XY::Point MLPoint(LS_fix);
+  rColl.computeMLFix(MLPoint);
+  if (!DFLib::Util::fixIsReasonable(MLPoint.getXY(),receiverLocs[0],mercScale))
+  {
+    MLPoint.setXY(LS_fix.getXY());
+    rColl.aggressiveComputeMLFix(MLPoint);
+  }
+  recordFix(ML_METHOD,MLPoint.getXY(),transPos,receiverLocs[0],mercScale,
+            result);
+
+  DFLib::XY::Point MLGlobalPoint(LS_fix);
+  rColl.globalComputeMLFix(MLGlobalPoint);
+  recordFix(ML_GLOBAL_METHOD,MLGlobalPoint.getXY(),transPos,receiverLocs[0],
+            mercScale,result);
+
+  DFLib::XY::Point StansfieldPoint(LS_fix);
+  try
+  {
+    double am2,bm2,phi;
+    rColl.computeStansfieldFix(StansfieldPoint,am2,bm2,phi);
+    recordFix(STANSFIELD_METHOD,StansfieldPoint.getXY(),transPos,
+              receiverLocs[0],mercScale,result);
+  }
+  catch (DFLib::Util::Exception x)
+  {
+    // counts as a failure
+  }
+
+  rColl.deleteReports();
+}
+
+int main(int argc,char **argv)
+{
+  /*!
+    \brief Monte Carlo driver for studying accuracy of DFLib fix methods
+
+    testlsDF_mc takes the same input as testlsDF_proj: a transmitter
+    longitude/latitude pair in PROJ.4 format on the command line and a
+    receivers file on standard input.  Instead of running a single
+    randomized problem, it runs the requested number of trials, each
+    with independently randomized bearings, and computes the Least
+    Squares, Fix Cut Average, Maximum Likelihood (by conjugate gradients
+    with the testlsDF_proj retry, and by the global grid search) and
+    Stansfield fixes for each.  Trials are spread across all available
+    threads if DFLib was built with OpenMP.
+
+    For each method it prints the number and fraction of failed fixes
+    (non-finite or more than 100 miles from a receiver, the same test
+    testlsDF_proj applies) and the mean, RMS, median, 95th percentile
+    and maximum distance in meters between the fix and the true
+    transmitter location over the remaining trials.
+
+    Trial i always uses random stream i of the master seed, so a given
+    seed reproduces the same output on stdout regardless of the number
+    of threads.  Run time and trials per second are written to stderr.
+
+    Usage: testlsDF_mc [--seed <seed>] [--trials <M>] <trans lon> <trans lat> < receivers
+  */
+  double lon,lat;
+  std::vector<double> transPos(2,0.0);
+  char dms_string[128];
+  int numTrials=1000;
+  uint64_t seed=time(NULL);
+  bool seedGiven=false;
+
+  std::vector<std::string> projArgs;
+  projArgs.push_back("proj=latlong");
+  projArgs.push_back("datum=WGS84");
+
+  std::string progName(argv[0]);
+  argv++;
+  argc--;
+
+  while (argc > 0)
+  {
+    std::string testArg(argv[0]);
+    if (testArg == "--seed" && argc > 1)
+    {
+      seed=strtoul(argv[1],NULL,10);
+      seedGiven=true;
+    }
+    else if (testArg == "--trials" && argc > 1)
+    {
+      numTrials=atoi(argv[1]);
+    }
+    else
+      break;
+    argv += 2;
+    argc -= 2;
+  }
+
+  if (argc < 2 || numTrials < 1)
+  {
+    std::cerr << "Usage: " << progName
+              << " [--seed <seed>] [--trials <M>] <trans lon> <trans lat> "
+              << std::endl;
+    std::cerr << " Remember to pipe list of receiver lon/lats into stdin!" << std::endl;
+    exit(1);
+  }
+  if (!seedGiven)
+    std::cerr << " using time " << seed << " as random number seed." << std::endl;
+
+  lon=dmstor(argv[0],NULL);
+  lat=dmstor(argv[1],NULL);
+  transPos[0]=lon*RAD_TO_DEG;
+  transPos[1]=lat*RAD_TO_DEG;
+  DFLib::Proj::Point transPoint(transPos,projArgs);
+  transPos=transPoint.getXY();
+
+  // Mercator distances are stretched by 1/cos(latitude); scale them
+  // back to meters on the ground near the transmitter.
+  double mercScale=cos(lat);
+
+  // Read receivers exactly as testlsDF_proj does, but keep only their
+  // mercator coordinates.  All the projection work happens here, once.
+  std::vector<std::vector<double> > receiverLocs;
+  std::vector<double> sigmas;
+  std::vector<double> trueBearings;
+  while (!std::cin.eof())
+  {
+    double temp_sigma;
+    char junk_space;
+    std::vector<double> tempVector(2);
+
+    std::cin.get(dms_string,sizeof(dms_string),' ');
+    if (std::cin.eof())
+      break;
+    lon=dmstor(dms_string,NULL);
+    std::cin.get(junk_space);
+    std::cin.get(dms_string,sizeof(dms_string),' ');
+    if (std::cin.eof())
+      break;
+    lat=dmstor(dms_string,NULL);
+    std::cin.get(junk_space);
+
+    std::cin >>  temp_sigma;
+
+    if (std::cin.eof())
+      break;
+
+    tempVector[0]=lon*RAD_TO_DEG;
+    tempVector[1]=lat*RAD_TO_DEG;
+    DFLib::Proj::Point receiverPoint(tempVector,projArgs);
+    receiverLocs.push_back(receiverPoint.getXY());
+    sigmas.push_back(temp_sigma);
+
+    DFLib::XY::Report trueReport(receiverLocs.back(),0.0,temp_sigma,"true");
+    trueBearings.push_back(trueReport.computeBearingToPoint(transPos)*RAD_TO_DEG);
+  }
+
+  if (receiverLocs.size() < 2)
+  {
+    std::cerr << " Need at least two receivers to compute a fix." << std::endl;
+    exit(1);
+  }
+
+  std::vector<TrialResult> results(numTrials);
+
+  double startTime=DFLib::Util::wallClockSeconds();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+  for (int trial=0; trial<numTrials; ++trial)
+  {
+    runTrial(trial,seed,receiverLocs,sigmas,trueBearings,transPos,mercScale,
+             results[trial]);
+  }
+  double elapsed=DFLib::Util::wallClockSeconds()-startTime;
+
+  std::cout << " Monte Carlo results for " << numTrials << " trials, "
+            << receiverLocs.size() << " receivers, seed " << seed
+            << std::endl;
+  std::cout << " Errors are distances in meters from the true transmitter location"
+            << std::endl;
+  std::cout.precision(8);
+
+  // Aggregate serially and in trial order so that sums are reproducible
+  for (int method=0; method<NUM_METHODS; ++method)
+  {
+    std::vector<double> errors;
+    double sum=0;
+    double sumsq=0;
+    errors.reserve(numTrials);
+    for (int trial=0; trial<numTrials; ++trial)
+    {
+      if (results[trial].ok[method])
+      {
+        double e=results[trial].error[method];
+        errors.push_back(e);
+        sum += e;
+        sumsq += e*e;
+      }
+    }
+    int numFailed=numTrials-errors.size();
+    std::cout << " " << methodNames[method] << ":" << std::endl;
+    std::cout << "   failures: " << numFailed << " ("
+              << (100.0*numFailed)/numTrials << "%)" << std::endl;
+    if (!errors.empty())
+    {
+      std::sort(errors.begin(),errors.end());
+      int n=errors.size();
+      std::cout << "   mean error: " << sum/n << std::endl;
+      std::cout << "   RMS error: " << sqrt(sumsq/n) << std::endl;
+      std::cout << "   median error: " << errors[(n-1)/2] << std::endl;
+      std::cout << "   95th percentile error: "
+                << errors[(int)ceil(0.95*n)-1] << std::endl;
+      std::cout << "   maximum error: " << errors[n-1] << std::endl;
+    }
+  }
+
+  std::cerr << " " << numTrials << " trials on "
+            << DFLib::Util::maxThreads() << " threads in " << elapsed
+            << " seconds (" << numTrials/elapsed << " trials per second)"
+            << std::endl;
+  return 0;
+}
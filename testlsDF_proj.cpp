@@ -70,6 +70,7 @@ using std::isinf;
 #include "gaussian_random.hpp"
 #include "DF_Proj_Point.hpp"
 #include "DF_Report_Collection.hpp"
+#include "DF_Array_Collection.hpp"
 #include "DF_Proj_Report.hpp"
 
 #if 0
@@ -100,8 +101,10 @@ int main(int argc,char **argv)
     the methods available in DFLib: the Fix Cut Average, Least Squares
     (orthogonal vectors), Maximum Likelihood and Stansfield fixes.  It 
     outputs a file "testlsDFfix.gnuplot" of Gnuplot commands to plot the
-    DF problem and the various fixes.  Error ellipses for the Stansfield
-    solution are also plotted.
+    DF problem and the various fixes.  Error ellipses for the ML and
+    Stansfield solutions are also plotted, along with the 50%, 75% and
+    95% highest posterior density regions of the ML fix, which are
+    written to "hpd_regions.dat".
 
     The program also outputs a file "testlsDFfix.grasspoints" with the
     station locations and fix locations in a format that can be read by
@@ -574,6 +577,30 @@ int main(int argc,char **argv)
     {
       std::cout << " more aggressive attempt still failed to get a reasonable fix."
            << std::endl;
+
+      // Last resort: a grid search that doesn't depend on a starting
+      // guess at all.
+      int numEvals=rColl.globalComputeMLFix(NRPoint);
+      std::cout << " global search used " << numEvals
+                << " cost function evaluations." << std::endl;
+
+      NR_fix = NRPoint.getXY();
+      latlon=NRPoint.getUserCoords();
+      if (!(isinf(latlon[0]) || isinf(latlon[1]) || isnan(latlon[0]) || isnan(latlon[1])
+            ||isinf(NR_fix[0]) || isinf(NR_fix[1]) || isnan(NR_fix[0]) || isnan(NR_fix[1])))
+      {
+        double dlon=(latlon[0]-r0_coords[0])/RAD_TO_DEG;
+        double dlat=(latlon[1]-r0_coords[1])/RAD_TO_DEG;
+        double haversin_a=sin(dlat/2.0)*sin(dlat/2.0)+cos(latlon[1]/RAD_TO_DEG)*cos(r0_coords[1]/RAD_TO_DEG)*sin(dlon/2)*sin(dlon/2);
+        double haversin_c=2*atan2(sqrt(haversin_a),sqrt(1-haversin_a));
+        haversin_d=3596*haversin_c;   // miles, give or take
+        fixFailed=(haversin_d>100);
+      }
+      if (fixFailed)
+      {
+        std::cout << " global search failed to get a reasonable fix, too."
+                  << std::endl;
+      }
     }
   }
   if (!fixFailed)
@@ -615,6 +642,46 @@ int main(int argc,char **argv)
                   <<"*cos(360.0/40000.0*t)+"<<b<<"*"<<rho<<"*"<<cosphi
                   <<"*sin(360.0/40000.0*t) w l title \"95% ML confidence\"" << std::endl;
 
+    // The same probabilities, from the real posterior instead of its
+    // Gaussian approximation.
+    std::vector<double> probabilities;
+    probabilities.push_back(.5);
+    probabilities.push_back(.75);
+    probabilities.push_back(.95);
+    std::vector<DFLib::ConfidenceRegion> regions;
+    try
+    {
+      rColl.computeConfidenceRegions(NRPoint,probabilities,regions);
+      std::ofstream regionsFile("hpd_regions.dat");
+      regionsFile.precision(16);
+      for (int r=0; r<regions.size(); ++r)
+      {
+        std::cout << " " << regions[r].probability*100
+                  << "% HPD region area=" << regions[r].area
+                  << " (ellipse area="
+                  << -2*log(1-regions[r].probability)*M_PI*a*b << ")"
+                  << std::endl;
+        for (int p=0; p<regions[r].polygons.size(); ++p)
+        {
+          const std::vector<double> &polygon=regions[r].polygons[p];
+          for (int v=0; v<polygon.size(); v+=2)
+            regionsFile << polygon[v] << " " << polygon[v+1] << std::endl;
+          regionsFile << polygon[0] << " " << polygon[1] << std::endl;
+          regionsFile << std::endl;
+        }
+        regionsFile << std::endl;
+        gnuplotFile << "replot \"hpd_regions.dat\" index " << r
+                    << " w l title \"" << regions[r].probability*100
+                    << "% ML HPD region\"" << std::endl;
+      }
+      regionsFile.close();
+    }
+    catch (DFLib::Util::Exception x)
+    {
+      std::cerr << "Could not compute HPD regions: " << x.getEmsg()
+                << std::endl;
+    }
+
     pointsFile << 102 << "|"<<NR_fix[0]<<"|"<<NR_fix[1]<<"|ML" <<std::endl;
     
     std::cout << " getting user coordinates " << std::endl;